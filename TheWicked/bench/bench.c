@@ -0,0 +1,535 @@
+// ---------------------------------------------------------
+// THE WICKED GOOD - BENCHMARK HARNESS ("make bench")
+// ---------------------------------------------------------
+// Times the booking engine directly (no screens) and prints the results
+// as JSON, so two builds can be compared run against run.
+//
+//   Micro:  checkAvailability, reserveSeats, markSeatsSold, countSoldSeats,
+//           planGroupSeating (block bookings), saveTransaction (durable
+//           append), scanSalesLog (cashout scan), issueTicketId and
+//           validateTicket (ticket ids)
+//   Macro:  end-to-end headless bookings (same path as "--script")
+//
+// Usage: WickedBench [--halls 4x6,12x24,26x64] [--logs 1000,100000]
+//                    [--samples N] [--bookings N] [--dir bench_tmp] [--out file.json]
+//
+// Everything runs inside the scratch directory (--dir), so the real
+// sales log, snapshot and hall layout are never touched.
+
+// Request POSIX declarations (clock_gettime, chdir) in strict C99 mode.
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tickets.h"
+#include "hall.h"
+#include "inventory.h"
+#include "wal.h"
+#include "salesrec.h"
+#include "archive.h"
+#include "headless.h"
+#include "groups.h"
+#include "ticketid.h"
+#include "utilities.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <direct.h>
+    #define makeDirectory(path) _mkdir(path)
+    #define changeDirectory(path) _chdir(path)
+#else
+    #include <unistd.h>
+    #include <sys/stat.h>
+    #define makeDirectory(path) mkdir(path, 0755)
+    #define changeDirectory(path) chdir(path)
+#endif
+
+#define MAX_CONFIGS 16
+#define BATCH_FAST 100    // Calls per sample for operations that take nanoseconds
+#define BATCH_SCAN 10     // Calls per sample for whole-hall walks
+
+// ---------------------------------------------------------
+// SETTINGS
+// ---------------------------------------------------------
+typedef struct {
+    int hallRows[MAX_CONFIGS];
+    int hallCols[MAX_CONFIGS];
+    int hallCount;
+    long long logSizes[MAX_CONFIGS];
+    int logCount;
+    int samples;          // Samples per micro-benchmark
+    int bookings;         // Durable operations (saveTransaction, end-to-end bookings)
+    const char* dir;
+    const char* outPath;
+} BenchConfig;
+
+static FILE* out;
+static int resultCount = 0;
+
+// ---------------------------------------------------------
+// TIMING AND STATISTICS
+// ---------------------------------------------------------
+
+// Function: nowNs
+// Purpose: Monotonic clock in nanoseconds.
+static long long nowNs() {
+    #ifdef _WIN32
+        LARGE_INTEGER freq, now;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&now);
+        return (long long)(now.QuadPart / freq.QuadPart) * 1000000000LL
+             + (long long)(now.QuadPart % freq.QuadPart) * 1000000000LL / freq.QuadPart;
+    #else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    #endif
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Function: percentile
+// Purpose: Nearest-rank percentile of a sorted array.
+static double percentile(const double* sorted, int count, double p) {
+    int rank = (int)(p / 100.0 * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+// Function: reportResult
+// Purpose: Sorts the samples (ns per operation) and writes one JSON result.
+// 'hall' / 'logRecords' describe the configuration (NULL / -1 = not relevant).
+static void reportResult(const char* name, const char* hall, long long logRecords,
+                         double* samples, int count, int batch, double throughput) {
+    int i;
+    double sum = 0;
+    if (count == 0) return;
+    qsort(samples, (size_t)count, sizeof(double), compareDoubles);
+    for(i = 0; i < count; i++) sum += samples[i];
+
+    fprintf(out, "%s\n    {\"name\": \"%s\", ", (resultCount++ == 0) ? "" : ",", name);
+    if (hall != NULL) fprintf(out, "\"hall\": \"%s\", ", hall);
+    else fprintf(out, "\"hall\": null, ");
+    if (logRecords >= 0) fprintf(out, "\"log_records\": %lld, ", logRecords);
+    else fprintf(out, "\"log_records\": null, ");
+    fprintf(out, "\"unit\": \"ns\", \"samples\": %d, \"batch\": %d, "
+                 "\"mean\": %.1f, \"min\": %.1f, \"p50\": %.1f, \"p90\": %.1f, "
+                 "\"p99\": %.1f, \"p999\": %.1f, \"max\": %.1f",
+            count, batch, sum / count, samples[0],
+            percentile(samples, count, 50), percentile(samples, count, 90),
+            percentile(samples, count, 99), percentile(samples, count, 99.9),
+            samples[count - 1]);
+    if (throughput > 0) fprintf(out, ", \"throughput_per_s\": %.1f", throughput);
+    fprintf(out, "}");
+    fprintf(stderr, "  %-18s %-8s p50 %12.1f ns   p99 %12.1f ns\n", name, hall ? hall : "-",
+            percentile(samples, count, 50), percentile(samples, count, 99));
+}
+
+// ---------------------------------------------------------
+// SETUP HELPERS
+// ---------------------------------------------------------
+
+// Function: installHall
+// Purpose: Writes a rows x cols layout (front fifth VIP, 4 showtimes)
+// into the scratch directory and builds a fresh inventory for it.
+static int installHall(int rows, int cols) {
+    FILE* f = fopen(HALL_LAYOUT_FILE, "w");
+    int r, c;
+    if (f == NULL) return 0;
+    fprintf(f, "show 10:30 AM | Matinee\nshow 01:15 PM | Afternoon\n"
+               "show 04:45 PM | Prime\nshow 08:00 PM | Evening\n");
+    int vipRows = (rows >= 5) ? rows / 5 : 1;
+    for(r = 0; r < rows; r++) {
+        fprintf(f, "row %s ", (r < vipRows && rows > 1) ? "VIP" : "REG");
+        for(c = 0; c < cols; c++) fputc('#', f);
+        fputc('\n', f);
+    }
+    fclose(f);
+    if (!loadHallLayout(HALL_LAYOUT_FILE)) return 0;
+    return buildInventory();
+}
+
+// Function: randomClass
+// Purpose: Mostly Regular tickets, like the real kiosk.
+static int randomClass() {
+    return (rand() % 4 == 0) ? TYPE_VIP : TYPE_REG;
+}
+
+// Function: fillHalfway
+// Purpose: Sells parties of 1-4 until about half of every showtime is
+// taken, so lookups run against a realistic, fragmented hall.
+static void fillHalfway(SeatSelection* seats) {
+    int t;
+    for(t = 0; t < getNumShowtimes(); t++) {
+        int target = getHall(t)->capacity / 2;
+        int misses = 0;
+        while (countSoldInShowtime(t) < target && misses < 100) {
+            int type = randomClass();
+            int qty = 1 + rand() % 4;
+            if (!checkAvailability(qty, type, t)) { misses++; continue; }
+            reserveSeats(qty, type, t, seats);
+            markSeatsSold(qty, seats, t);
+        }
+    }
+}
+
+// Function: writeSyntheticLog
+// Purpose: Creates a sales log of 'records' sale records for the scan benchmark.
+static int writeSyntheticLog(const char* path, long long records) {
+    remove(path);
+    if (!prepareSalesFile(path)) return 0;
+    FILE* f = fopen(path, "ab");
+    if (f == NULL) return 0;
+
+    SalesRecord rec;
+    PackedSeat seats[4];
+    long long i, timeUs = getEpochMicros();
+    for(i = 0; i < records; i++) {
+        int qty = 1 + (int)(i % 4), k;
+        for(k = 0; k < qty; k++) { seats[k].row = (uint8_t)(i % 4); seats[k].col = (uint8_t)k; }
+        encodeSale(&rec, (int)(i % 4), qty, seats, 0, NULL, timeUs + i * 1000, qty * 45000LL, 15000);
+        if (fwrite(&rec, sizeof(rec), 1, f) != 1) { fclose(f); return 0; }
+    }
+    fclose(f);
+    return 1;
+}
+
+// ---------------------------------------------------------
+// BENCHMARKS
+// ---------------------------------------------------------
+
+// Function: benchLookups
+// Purpose: checkAvailability / reserveSeats / countSoldSeats on a half-full hall.
+static void benchLookups(const BenchConfig* cfg, const char* hall, double* samples, SeatSelection* seats) {
+    int s, i;
+    int qty[BATCH_FAST], type[BATCH_FAST], show[BATCH_FAST];
+    volatile int sink = 0;
+
+    for(s = 0; s < cfg->samples; s++) {
+        for(i = 0; i < BATCH_FAST; i++) {
+            qty[i] = 1 + rand() % 4; type[i] = randomClass(); show[i] = rand() % getNumShowtimes();
+        }
+        long long start = nowNs();
+        for(i = 0; i < BATCH_FAST; i++) sink += checkAvailability(qty[i], type[i], show[i]);
+        samples[s] = (double)(nowNs() - start) / BATCH_FAST;
+    }
+    reportResult("checkAvailability", hall, -1, samples, cfg->samples, BATCH_FAST, 0);
+
+    for(s = 0; s < cfg->samples; s++) {
+        for(i = 0; i < BATCH_SCAN; i++) {
+            qty[i] = 1 + rand() % 4; type[i] = randomClass(); show[i] = rand() % getNumShowtimes();
+            if (countFreeInClass(show[i], type[i]) < qty[i]) qty[i] = 1;
+        }
+        long long start = nowNs();
+        for(i = 0; i < BATCH_SCAN; i++) reserveSeats(qty[i], type[i], show[i], seats);
+        samples[s] = (double)(nowNs() - start) / BATCH_SCAN;
+    }
+    reportResult("reserveSeats", hall, -1, samples, cfg->samples, BATCH_SCAN, 0);
+
+    for(s = 0; s < cfg->samples; s++) {
+        long long start = nowNs();
+        for(i = 0; i < BATCH_SCAN; i++) sink += countSoldSeats();
+        samples[s] = (double)(nowNs() - start) / BATCH_SCAN;
+    }
+    reportResult("countSoldSeats", hall, -1, samples, cfg->samples, BATCH_SCAN, 0);
+    (void)sink;
+}
+
+// Function: benchGroupPlan
+// Purpose: Plans (without selling) blocks of 2-16 parties of 2-12 seats on
+// the half-full hall, capped to what the class still has free.
+static void benchGroupPlan(const BenchConfig* cfg, const char* hall, double* samples, SeatSelection* seats) {
+    int s, i;
+    int sizes[MAX_GROUP_PARTIES];
+    GroupPlan plan;
+    long long nodes = 0;
+    int complete = 0;
+
+    for(s = 0; s < cfg->samples; s++) {
+        int t = rand() % getNumShowtimes();
+        int freeSeats = countFreeInClass(t, TYPE_REG);
+        int parties = 2 + rand() % 15, total = 0;
+        for(i = 0; i < parties; i++) {
+            sizes[i] = 2 + rand() % 11;
+            if (total + sizes[i] > freeSeats) break;
+            total += sizes[i];
+        }
+        if (i == 0) { sizes[0] = 1; i = 1; } // Nearly full hall: a single seat
+
+        long long start = nowNs();
+        planGroupSeating(t, TYPE_REG, sizes, i, GROUP_SEARCH_BUDGET_US, seats, &plan);
+        samples[s] = (double)(nowNs() - start);
+        nodes += plan.nodes;
+        complete += plan.complete;
+    }
+    reportResult("planGroupSeating", hall, -1, samples, cfg->samples, 1, 0);
+    fprintf(stderr, "  group plans: %lld nodes/plan, %d of %d searches complete\n",
+            nodes / cfg->samples, complete, cfg->samples);
+}
+
+// Function: benchMarkSold
+// Purpose: One timed markSeatsSold() per sample; the hall is rebuilt
+// (untimed) whenever it fills up.
+static void benchMarkSold(const BenchConfig* cfg, const char* hall, double* samples, SeatSelection* seats) {
+    int s = 0;
+    while (s < cfg->samples) {
+        int type = randomClass(), qty = 1 + rand() % 4, t = rand() % getNumShowtimes();
+        if (!checkAvailability(qty, type, t)) { buildInventory(); continue; }
+        reserveSeats(qty, type, t, seats);
+        long long start = nowNs();
+        markSeatsSold(qty, seats, t);
+        samples[s++] = (double)(nowNs() - start);
+    }
+    reportResult("markSeatsSold", hall, -1, samples, cfg->samples, 1, 0);
+}
+
+// Function: benchSaveTransaction
+// Purpose: Durable appends through the write-ahead log (includes the fsync wait).
+static void benchSaveTransaction(const BenchConfig* cfg, double* samples, SeatSelection* seats) {
+    int s;
+    reserveSeats(2, TYPE_REG, 0, seats);
+    ConcessionOrder extras;
+    startOrder(&extras);
+    addToOrder(&extras, 0, 1); // One popcorn: a SALE record + one ITEMS record
+    long long runStart = nowNs();
+    for(s = 0; s < cfg->bookings; s++) {
+        long long start = nowNs();
+        saveTransaction(0, 2, seats, PESOS(900), &extras);
+        samples[s] = (double)(nowNs() - start);
+    }
+    double seconds = (nowNs() - runStart) / 1e9;
+    reportResult("saveTransaction", NULL, -1, samples, cfg->bookings, 1, cfg->bookings / seconds);
+}
+
+// Function: benchCashoutScan
+// Purpose: The cashout pass over the log (scanSalesLog), per log size.
+static void benchCashoutScan(const BenchConfig* cfg, double* samples) {
+    int l, s;
+    int scans = (cfg->samples < 50) ? cfg->samples : 50;
+    for(l = 0; l < cfg->logCount; l++) {
+        char path[64];
+        snprintf(path, sizeof(path), "bench_log_%lld.bin", cfg->logSizes[l]);
+        if (!writeSyntheticLog(path, cfg->logSizes[l])) {
+            fprintf(stderr, "Cannot write %s\n", path);
+            continue;
+        }
+        SalesTotals totals;
+        for(s = 0; s < scans; s++) {
+            long long start = nowNs();
+            scanSalesLog(path, &totals);
+            samples[s] = (double)(nowNs() - start);
+        }
+        reportResult("cashoutScan", NULL, cfg->logSizes[l], samples, scans, 1, 0);
+        remove(path);
+    }
+}
+
+// Function: benchTicketIds
+// Purpose: Issuing ids (TICKET_ID_BATCH per sample; they all stay in the
+// index, so the samples are capped to fill it at most halfway), then one
+// usher check per sample of a random issued id (index lookup plus the
+// read of what other kiosks appended).
+#define TICKET_ID_BATCH 64
+static void benchTicketIds(const BenchConfig* cfg, double* samples, SeatSelection* seats) {
+    int s, i;
+    int batches = cfg->samples;
+    if (batches * TICKET_ID_BATCH > TICKET_INDEX_SLOTS / 2) batches = TICKET_INDEX_SLOTS / 2 / TICKET_ID_BATCH;
+    TicketId* ids = malloc(sizeof(TicketId) * (size_t)batches * TICKET_ID_BATCH);
+    if (ids == NULL) return;
+
+    remove(TICKET_ID_FILE);
+    openTicketIds(TICKET_ID_FILE, 1);
+    reserveSeats(1, TYPE_REG, 0, seats);
+    for(s = 0; s < batches; s++) {
+        long long start = nowNs();
+        for(i = 0; i < TICKET_ID_BATCH; i++) ids[s * TICKET_ID_BATCH + i] = issueTicketId(0, seats);
+        samples[s] = (double)(nowNs() - start) / TICKET_ID_BATCH;
+    }
+    reportResult("issueTicketId", NULL, -1, samples, batches, TICKET_ID_BATCH, 0);
+
+    for(s = 0; s < cfg->samples; s++) {
+        TicketId id = ids[rand() % (batches * TICKET_ID_BATCH)];
+        TicketRecord ticket;
+        long long start = nowNs();
+        validateTicket(id, 0, &ticket);
+        samples[s] = (double)(nowNs() - start);
+    }
+    reportResult("validateTicket", NULL, -1, samples, cfg->samples, 1, 0);
+
+    closeTicketIds();
+    remove(TICKET_ID_FILE);
+    free(ids);
+}
+
+// Function: benchBookings
+// Purpose: End-to-end bookings through runHeadlessBooking(): availability,
+// auto seats, hold, payment check, commit and durable log write.
+static void benchBookings(const BenchConfig* cfg, const char* hall, double* samples) {
+    HeadlessStats stats;
+    char line[96];
+    int s = 0, session = 0;
+    memset(&stats, 0, sizeof(stats));
+
+    buildInventory();
+    long long runStart = nowNs();
+    while (s < cfg->bookings) {
+        int t = rand() % getNumShowtimes(), qty = 1 + rand() % 4;
+        snprintf(line, sizeof(line), "%d %s %d auto 1,2 100000", t,
+                 (randomClass() == TYPE_VIP) ? "VIP" : "REG", qty);
+        long long start = nowNs();
+        const char* problem = runHeadlessBooking(line, ++session, &stats);
+        long long elapsed = nowNs() - start;
+        if (problem != NULL) {
+            // Sold out: start a new day (untimed) and try again
+            runStart += elapsed;
+            long long pause = nowNs();
+            buildInventory();
+            runStart += nowNs() - pause;
+            continue;
+        }
+        samples[s++] = (double)elapsed;
+    }
+    double seconds = (nowNs() - runStart) / 1e9;
+    reportResult("booking", hall, -1, samples, cfg->bookings, 1, cfg->bookings / seconds);
+}
+
+// ---------------------------------------------------------
+// COMMAND LINE
+// ---------------------------------------------------------
+
+// Function: parseHalls
+// Purpose: "4x6,12x24" -> rows x seats per hall configuration.
+static int parseHalls(const char* text, BenchConfig* cfg) {
+    cfg->hallCount = 0;
+    while (*text != '\0' && cfg->hallCount < MAX_CONFIGS) {
+        int rows, cols;
+        if (sscanf(text, "%dx%d", &rows, &cols) != 2 || rows < 1 || rows > MAX_ROWS || cols < 1 || cols > MAX_COLS) return 0;
+        cfg->hallRows[cfg->hallCount] = rows;
+        cfg->hallCols[cfg->hallCount] = cols;
+        cfg->hallCount++;
+        const char* comma = strchr(text, ',');
+        if (comma == NULL) break;
+        text = comma + 1;
+    }
+    return cfg->hallCount > 0;
+}
+
+// Function: parseLogs
+// Purpose: "1000,100000" -> sales log sizes (records) for the cashout scan.
+static int parseLogs(const char* text, BenchConfig* cfg) {
+    cfg->logCount = 0;
+    while (*text != '\0' && cfg->logCount < MAX_CONFIGS) {
+        long long records = atoll(text);
+        if (records < 1) return 0;
+        cfg->logSizes[cfg->logCount++] = records;
+        const char* comma = strchr(text, ',');
+        if (comma == NULL) break;
+        text = comma + 1;
+    }
+    return cfg->logCount > 0;
+}
+
+// Function: parseArguments
+// Purpose: Defaults first, then the command line overrides.
+static int parseArguments(int argc, char** argv, BenchConfig* cfg) {
+    int i;
+    parseHalls("4x6,12x24,26x64", cfg);
+    parseLogs("1000,100000", cfg);
+    cfg->samples = 2000;
+    cfg->bookings = 500;
+    cfg->dir = "bench_tmp";
+    cfg->outPath = NULL;
+
+    for(i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (value == NULL) return 0;
+        if (strcmp(argv[i], "--halls") == 0) { if (!parseHalls(value, cfg)) return 0; }
+        else if (strcmp(argv[i], "--logs") == 0) { if (!parseLogs(value, cfg)) return 0; }
+        else if (strcmp(argv[i], "--samples") == 0) { cfg->samples = atoi(value); if (cfg->samples < 1) return 0; }
+        else if (strcmp(argv[i], "--bookings") == 0) { cfg->bookings = atoi(value); if (cfg->bookings < 1) return 0; }
+        else if (strcmp(argv[i], "--dir") == 0) cfg->dir = value;
+        else if (strcmp(argv[i], "--out") == 0) cfg->outPath = value;
+        else return 0;
+        i++;
+    }
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    int h;
+
+    if (!parseArguments(argc, argv, &cfg)) {
+        fprintf(stderr, "Usage: %s [--halls RxC,...] [--logs N,...] [--samples N] [--bookings N]"
+                        " [--dir path] [--out file.json]\n", argv[0]);
+        return 2;
+    }
+
+    // Results file first (relative to where we were started), then the scratch dir
+    out = stdout;
+    if (cfg.outPath != NULL && (out = fopen(cfg.outPath, "w")) == NULL) {
+        fprintf(stderr, "Cannot open %s\n", cfg.outPath);
+        return 1;
+    }
+    makeDirectory(cfg.dir);
+    if (changeDirectory(cfg.dir) != 0) {
+        fprintf(stderr, "Cannot use scratch directory %s\n", cfg.dir);
+        return 1;
+    }
+    srand(12345); // Same workload on every run
+    loadConcessions(CONCESSIONS_FILE); // Scratch dir: the default stand, stock not counted
+
+    int maxSamples = (cfg.samples > cfg.bookings) ? cfg.samples : cfg.bookings;
+    double* samples = malloc(sizeof(double) * (size_t)maxSamples);
+    SeatSelection* seats = malloc(sizeof(SeatSelection) * MAX_ROWS * MAX_COLS);
+    if (samples == NULL || seats == NULL) return 1;
+
+    remove(SALES_LOG_FILE);
+    if (!prepareSalesFile(SALES_LOG_FILE) || !openSalesLog(SALES_LOG_FILE, GROUP_COMMIT_MS)) {
+        fprintf(stderr, "Cannot open the sales log in %s\n", cfg.dir);
+        return 1;
+    }
+
+    fprintf(out, "{\n  \"benchmark\": \"TheWicked\",\n  \"format\": 1,\n");
+    fprintf(out, "  \"timestamp_us\": %lld,\n", getEpochMicros());
+    fprintf(out, "  \"config\": {\"samples\": %d, \"bookings\": %d, \"group_commit_ms\": %d},\n",
+            cfg.samples, cfg.bookings, GROUP_COMMIT_MS);
+    fprintf(out, "  \"results\": [");
+
+    for(h = 0; h < cfg.hallCount; h++) {
+        char hall[16];
+        snprintf(hall, sizeof(hall), "%dx%d", cfg.hallRows[h], cfg.hallCols[h]);
+        if (!installHall(cfg.hallRows[h], cfg.hallCols[h])) {
+            fprintf(stderr, "Cannot install hall %s\n", hall);
+            continue;
+        }
+        fprintf(stderr, "Hall %s (%d seats x %d showtimes)\n", hall, getHall(0)->capacity, getNumShowtimes());
+        fillHalfway(seats);
+        benchLookups(&cfg, hall, samples, seats);
+        benchGroupPlan(&cfg, hall, samples, seats);
+        benchMarkSold(&cfg, hall, samples, seats);
+        benchBookings(&cfg, hall, samples);
+    }
+
+    fprintf(stderr, "Sales log\n");
+    benchSaveTransaction(&cfg, samples, seats);
+    benchCashoutScan(&cfg, samples);
+
+    fprintf(stderr, "Ticket ids\n");
+    benchTicketIds(&cfg, samples, seats);
+
+    fprintf(out, "\n  ]\n}\n");
+    closeSalesLog();
+    remove(SALES_LOG_FILE);
+    remove(HALL_LAYOUT_FILE);
+    if (out != stdout) fclose(out);
+    free(samples);
+    free(seats);
+    return 0;
+}
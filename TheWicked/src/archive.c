@@ -0,0 +1,359 @@
+// Request copy_file_range/sendfile (GNU/Linux) plus the POSIX file API.
+// Must come before the first system header.
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include "archive.h"
+#include "salesrec.h"
+#include "utilities.h"
+
+// ---------------------------------------------------------
+// OS-SPECIFIC FILE I/O
+// ---------------------------------------------------------
+// Linux can move bytes between two files inside the kernel. Everywhere
+// else (and on filesystems that refuse it) we fall back to read/write.
+#ifdef _WIN32
+    #include <io.h>
+    #define open _open
+    #define read _read
+    #define write _write
+    #define close _close
+    #define fileno _fileno
+    #define lseek _lseeki64
+    #define ftruncate(fd, size) _chsize_s(fd, size)
+    #define fsync(fd) _commit(fd)
+    #define ARCHIVE_OPEN_FLAGS (O_WRONLY | O_CREAT | O_BINARY)
+    #define LOG_READ_FLAGS (O_RDONLY | O_BINARY)
+#else
+    #include <unistd.h>
+    // Note: no O_APPEND, copy_file_range() rejects append-only targets.
+    #define ARCHIVE_OPEN_FLAGS (O_WRONLY | O_CREAT)
+    #define LOG_READ_FLAGS O_RDONLY
+#endif
+
+#if defined(__linux__)
+    #include <sys/sendfile.h>
+    #define HAVE_SENDFILE 1
+    #if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+        #define HAVE_COPY_FILE_RANGE 1
+    #endif
+#endif
+
+#define COPY_CHUNK (64 * 1024)  // Bounce buffer for the read/write fallback
+
+// ---------------------------------------------------------
+// HELPERS
+// ---------------------------------------------------------
+
+// Function: writeAll
+// Purpose: write() may write less than asked; loop until everything is out.
+static int writeAll(int fd, const void* data, size_t length) {
+    const char* p = data;
+    while (length > 0) {
+        long n = (long)write(fd, p, (unsigned)length);
+        if (n <= 0) return 0;
+        p += n;
+        length -= (size_t)n;
+    }
+    return 1;
+}
+
+// Function: copyBytes
+// Purpose: Copies 'length' bytes from the current position of 'inFd' to the
+// current position of 'outFd'. Tries the zero-copy calls first and drops
+// to the next method if the kernel or filesystem does not support one.
+static int copyBytes(int inFd, int outFd, long long length) {
+    #ifdef HAVE_COPY_FILE_RANGE
+        while (length > 0) {
+            ssize_t n = copy_file_range(inFd, NULL, outFd, NULL, (size_t)length, 0);
+            if (n <= 0) break; // ENOSYS / EXDEV / EINVAL...: try the next method
+            length -= n;
+        }
+    #endif
+    #ifdef HAVE_SENDFILE
+        while (length > 0) {
+            ssize_t n = sendfile(outFd, inFd, NULL, (size_t)length);
+            if (n <= 0) break;
+            length -= n;
+        }
+    #endif
+
+    // Portable fallback: fixed-size bounce buffer
+    if (length > 0) {
+        char* buffer = malloc(COPY_CHUNK);
+        if (buffer == NULL) return 0;
+        while (length > 0) {
+            unsigned want = (length < COPY_CHUNK) ? (unsigned)length : COPY_CHUNK;
+            long n = (long)read(inFd, buffer, want);
+            if (n <= 0 || !writeAll(outFd, buffer, (size_t)n)) break;
+            length -= n;
+        }
+        free(buffer);
+    }
+    return length == 0;
+}
+
+// ---------------------------------------------------------
+// INDEX FILE
+// ---------------------------------------------------------
+// [IndexHeader][ArchiveIndexEntry]...  (64 bytes each)
+#define INDEX_MAGIC "WKARCIDX"
+#define INDEX_VERSION 1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    int64_t archiveBytes;    // Archive size this index describes
+    uint8_t reserved[40];
+} IndexHeader;
+
+typedef char IndexEntrySizeCheck[(sizeof(ArchiveIndexEntry) == 64) ? 1 : -1];
+typedef char IndexHeaderSizeCheck[(sizeof(IndexHeader) == 64) ? 1 : -1];
+
+// Function: fileSize
+// Purpose: Size of a file in bytes, or -1 if it does not exist.
+static long long fileSize(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) return -1;
+    fseek(f, 0, SEEK_END);
+    long long size = (long long)ftell(f);
+    fclose(f);
+    return size;
+}
+
+// Function: readIndexHeader
+// Returns: 1 if the index exists and has our header.
+static int readIndexHeader(const char* indexPath, IndexHeader* header) {
+    FILE* f = fopen(indexPath, "rb");
+    if (f == NULL) return 0;
+    int ok = fread(header, sizeof(*header), 1, f) == 1
+          && memcmp(header->magic, INDEX_MAGIC, 8) == 0
+          && header->version == INDEX_VERSION
+          && header->entrySize == sizeof(ArchiveIndexEntry);
+    fclose(f);
+    return ok;
+}
+
+// Function: isIndexCurrent
+// Purpose: The index is usable if it covers exactly the bytes in the archive.
+static int isIndexCurrent(const char* archivePath, const char* indexPath) {
+    IndexHeader header;
+    long long archiveBytes = fileSize(archivePath);
+    if (archiveBytes < 0) archiveBytes = 0;
+    return readIndexHeader(indexPath, &header) && header.archiveBytes == archiveBytes;
+}
+
+// Function: initIndexHeader
+static void initIndexHeader(IndexHeader* header, long long archiveBytes) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, INDEX_MAGIC, 8);
+    header->version = INDEX_VERSION;
+    header->entrySize = sizeof(ArchiveIndexEntry);
+    header->archiveBytes = archiveBytes;
+}
+
+// Function: appendIndexEntry
+// Purpose: Adds one shift and moves the header's archive size forward.
+// Only allowed if the index was current before this shift was archived.
+static int appendIndexEntry(const char* indexPath, const ArchiveIndexEntry* entry,
+                            long long archiveBefore, long long archiveAfter) {
+    IndexHeader header;
+    if (!readIndexHeader(indexPath, &header) || header.archiveBytes != archiveBefore) return 0;
+
+    FILE* f = fopen(indexPath, "r+b");
+    if (f == NULL) return 0;
+    header.archiveBytes = archiveAfter;
+    // Entry first, header last: a crash in between leaves a stale header,
+    // which simply triggers a rebuild
+    int ok = fseek(f, 0, SEEK_END) == 0
+          && fwrite(entry, sizeof(*entry), 1, f) == 1
+          && fflush(f) == 0
+          && fseek(f, 0, SEEK_SET) == 0
+          && fwrite(&header, sizeof(header), 1, f) == 1
+          && fflush(f) == 0
+          && fsync(fileno(f)) == 0;
+    fclose(f);
+    return ok;
+}
+
+// Function: rebuildArchiveIndex
+// Purpose: One linear pass over the archive: one entry per SHIFT record.
+// Written to a temporary file and renamed, so readers never see half an index.
+static int rebuildArchiveIndex(const char* archivePath, const char* indexPath) {
+    SalesView view;
+    if (!mapSalesFile(archivePath, &view)) return 0;
+
+    char tmpPath[300];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", indexPath);
+    FILE* f = fopen(tmpPath, "wb");
+    if (f == NULL) { unmapSalesFile(&view); return 0; }
+
+    IndexHeader header;
+    initIndexHeader(&header, (long long)view.size);
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1;
+
+    long long i = 0;
+    while (ok && i < view.count) {
+        const SalesRecord* rec = &view.records[i];
+        if (rec->kind != REC_SHIFT) { i++; continue; }
+
+        ArchiveIndexEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.closedUs = rec->body.shift.timeUs;
+        entry.offset = salesRecordOffset(i);
+        entry.records = rec->body.shift.records;
+        entry.totalCentavos = rec->body.shift.totalCentavos;
+        entry.sales = rec->body.shift.sales;
+
+        // Sale time range of the shift
+        long long end = i + 1 + entry.records, j;
+        if (end > view.count) end = view.count;
+        for(j = i + 1; j < end; j = nextSalesRecord(&view, j)) {
+            if (view.records[j].kind != REC_SALE) continue;
+            if (entry.firstSaleUs == 0) entry.firstSaleUs = view.records[j].body.sale.timeUs;
+            entry.lastSaleUs = view.records[j].body.sale.timeUs;
+        }
+        ok = fwrite(&entry, sizeof(entry), 1, f) == 1;
+        i = end;
+    }
+    ok = ok && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    fclose(f);
+    unmapSalesFile(&view);
+
+    ok = ok && replaceFileAtomically(tmpPath, indexPath);
+    if (!ok) remove(tmpPath);
+    return ok;
+}
+
+// ---------------------------------------------------------
+// PUBLIC API
+// ---------------------------------------------------------
+
+// Function: scanSalesLog
+// Purpose: Sums the mapped records in one branch-free pass. Only SALE
+// records carry money; their SEATS followers add zero. A sale missing
+// some followers is still being written and is left for the next shift.
+int scanSalesLog(const char* logPath, SalesTotals* totals) {
+    memset(totals, 0, sizeof(*totals));
+    totals->startOffset = salesRecordOffset(0);
+    totals->endOffset = totals->startOffset;
+
+    SalesView view;
+    if (!mapSalesFile(logPath, &view)) return 0;
+
+    long long end = countCompleteRecords(&view), sales, i;
+    totals->totalCentavos = sumSaleRecords(view.records, end, &sales);
+    totals->sales = (int)sales;
+
+    // Times of the first and last sale: a few records from each end
+    for(i = 0; i < end; i++) {
+        if (view.records[i].kind == REC_SALE) { totals->firstSaleUs = view.records[i].body.sale.timeUs; break; }
+    }
+    for(i = end - 1; i >= 0; i--) {
+        if (view.records[i].kind == REC_SALE) { totals->lastSaleUs = view.records[i].body.sale.timeUs; break; }
+    }
+    totals->records = (int)end;
+    totals->endOffset = salesRecordOffset(end);
+    unmapSalesFile(&view);
+    return 1;
+}
+
+// Function: archiveSalesLog
+// Purpose: SHIFT record -> zero-copy body -> fsync -> index entry.
+long long archiveSalesLog(const char* logPath, const char* archivePath, const char* indexPath,
+                          const SalesTotals* totals) {
+    if (!prepareSalesFile(archivePath)) return -1;
+
+    int logFd = open(logPath, LOG_READ_FLAGS);
+    if (logFd < 0) return -1;
+    int archiveFd = open(archivePath, ARCHIVE_OPEN_FLAGS, 0644);
+    if (archiveFd < 0) { close(logFd); return -1; }
+
+    SalesRecord shift;
+    memset(&shift, 0, sizeof(shift));
+    shift.kind = REC_SHIFT;
+    shift.body.shift.timeUs = getEpochMicros();
+    shift.body.shift.totalCentavos = totals->totalCentavos;
+    shift.body.shift.sales = totals->sales;
+    shift.body.shift.records = totals->records;
+
+    long long archiveEnd = (long long)lseek(archiveFd, 0, SEEK_END);
+    int ok = archiveEnd >= 0
+          && lseek(logFd, totals->startOffset, SEEK_SET) >= 0
+          && writeAll(archiveFd, &shift, sizeof(shift))
+          && copyBytes(logFd, archiveFd, totals->endOffset - totals->startOffset)
+          && fsync(archiveFd) == 0;
+
+    // A SHIFT record without all of its sales would break the archive: undo it
+    if (!ok && archiveEnd >= 0) ftruncate(archiveFd, archiveEnd);
+
+    close(archiveFd);
+    close(logFd);
+    if (!ok) return -1;
+
+    ArchiveIndexEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.closedUs = shift.body.shift.timeUs;
+    entry.firstSaleUs = totals->firstSaleUs;
+    entry.lastSaleUs = totals->lastSaleUs;
+    entry.offset = archiveEnd;
+    entry.records = totals->records;
+    entry.totalCentavos = totals->totalCentavos;
+    entry.sales = totals->sales;
+    long long newEnd = archiveEnd + (long long)sizeof(shift) + (totals->endOffset - totals->startOffset);
+
+    // The archive is already safe; a failed index update only means a rebuild later
+    if (!appendIndexEntry(indexPath, &entry, archiveEnd, newEnd)) rebuildArchiveIndex(archivePath, indexPath);
+    return archiveEnd;
+}
+
+// Function: undoArchiveShift
+// Purpose: Cuts the archive back to 'shiftOffset', then rebuilds the index.
+// Should the rebuild fail, the index no longer matches the archive size and
+// is rebuilt on its next use.
+int undoArchiveShift(const char* archivePath, const char* indexPath, long long shiftOffset) {
+    int archiveFd = open(archivePath, ARCHIVE_OPEN_FLAGS, 0644);
+    if (archiveFd < 0) return 0;
+    int ok = ftruncate(archiveFd, shiftOffset) == 0 && fsync(archiveFd) == 0;
+    close(archiveFd);
+    if (ok) rebuildArchiveIndex(archivePath, indexPath);
+    return ok;
+}
+
+// Function: openArchiveIndex
+// Purpose: Maps the index after making sure it describes the whole archive.
+int openArchiveIndex(const char* archivePath, const char* indexPath, ArchiveIndex* index) {
+    memset(index, 0, sizeof(*index));
+    if (!isIndexCurrent(archivePath, indexPath) && !rebuildArchiveIndex(archivePath, indexPath)) return 0;
+
+    index->base = mapFileReadOnly(indexPath, &index->size);
+    if (index->base == NULL || index->size < sizeof(IndexHeader)) {
+        closeArchiveIndex(index);
+        return 0;
+    }
+    index->entries = (const ArchiveIndexEntry*)((const char*)index->base + sizeof(IndexHeader));
+    index->count = (long long)((index->size - sizeof(IndexHeader)) / sizeof(ArchiveIndexEntry));
+    return 1;
+}
+
+// Function: closeArchiveIndex
+void closeArchiveIndex(ArchiveIndex* index) {
+    unmapFile(index->base, index->size);
+    memset(index, 0, sizeof(*index));
+}
+
+// Function: findShiftClosedAfter
+// Purpose: Lower-bound binary search on the close time (O(log n) probes).
+long long findShiftClosedAfter(const ArchiveIndex* index, long long timeUs) {
+    long long low = 0, high = index->count;
+    while (low < high) {
+        long long mid = low + (high - low) / 2;
+        if (index->entries[mid].closedUs < timeUs) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
@@ -0,0 +1,91 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ---------------------------------------------------------
+// SHIFT ARCHIVE
+// ---------------------------------------------------------
+// At cashout the active sales log is appended to the history archive
+// and then removed from the log. Both files use the binary record format
+// of salesrec.h, and neither step holds more than a fixed buffer:
+//   1. scanSalesLog() maps the log and adds up the centavo totals of the
+//      complete sales (no text parsing).
+//   2. archiveSalesLog() writes a SHIFT record, then hands exactly the
+//      scanned bytes to the kernel (copy_file_range / sendfile) so they
+//      go file-to-file without passing through our process.
+#define ARCHIVE_FILE "history_archive.bin"
+#define LEGACY_ARCHIVE_FILE "history_archive.txt"   // Imported once at startup
+#define ARCHIVE_INDEX_FILE "history_archive.idx"
+
+// Result of one scan over the sales log.
+typedef struct {
+    long long totalCentavos;   // Sum of the sale totals
+    long long startOffset;     // First byte of the first record (just past the header)
+    long long endOffset;       // End of the last complete sale
+    int sales;                 // Number of sales counted
+    int records;               // Number of records (sales + seat followers)
+    long long firstSaleUs;     // Time of the earliest / latest sale (0 if none)
+    long long lastSaleUs;
+} SalesTotals;
+
+// ---------------------------------------------------------
+// ARCHIVE INDEX
+// ---------------------------------------------------------
+// 'history_archive.idx' is a side file with one fixed-size entry per
+// closed shift, in the order the shifts were closed. Looking up a night
+// is a binary search over 'closedUs' followed by one seek into the
+// archive, no matter how many years of shifts the archive holds.
+// The index header remembers how many archive bytes it describes; if
+// that does not match the archive (crash between the two writes, old
+// archive imported) the index is rebuilt from the archive in one pass.
+typedef struct {
+    int64_t closedUs;        // When the shift was closed (SHIFT record time)
+    int64_t firstSaleUs;     // Earliest / latest sale in the shift (0 if unknown)
+    int64_t lastSaleUs;
+    int64_t offset;          // Byte offset of the SHIFT record in the archive
+    int64_t records;         // Records that follow the SHIFT record
+    int64_t totalCentavos;   // Cash handed over
+    int64_t sales;           // Number of sales
+    int64_t reserved;
+} ArchiveIndexEntry;
+
+// A mapped index. 'entries' is sorted by closedUs.
+typedef struct {
+    void* base;
+    size_t size;
+    const ArchiveIndexEntry* entries;
+    long long count;
+} ArchiveIndex;
+
+// Maps the log and adds up every complete sale.
+// Returns: 1 on success, 0 if the log is not a valid sales file.
+int scanSalesLog(const char* logPath, SalesTotals* totals);
+
+// Appends a SHIFT record plus the scanned records to the archive, syncs
+// it (the archive is created with a header on first use), then adds the
+// shift to the index.
+// Returns: Byte offset of the new SHIFT record in the archive, or -1 on
+// I/O error (the archive is left as it was).
+long long archiveSalesLog(const char* logPath, const char* archivePath, const char* indexPath,
+                          const SalesTotals* totals);
+
+// Takes the shift archived at 'shiftOffset' (the last one) back out of the
+// archive and the index, for a cashout whose sales could not be removed
+// from the log: otherwise the next cashout would archive them again.
+// Returns: 1 if the archive is as it was before the shift, 0 on I/O error.
+int undoArchiveShift(const char* archivePath, const char* indexPath, long long shiftOffset);
+
+// Maps the index, rebuilding it first if it is missing or out of date.
+// Returns: 1 on success (possibly with 0 entries), 0 on error.
+int openArchiveIndex(const char* archivePath, const char* indexPath, ArchiveIndex* index);
+
+// Releases an index from openArchiveIndex().
+void closeArchiveIndex(ArchiveIndex* index);
+
+// Binary search: first shift closed at or after 'timeUs'.
+// Returns: Its entry number, or index->count if every shift closed earlier.
+long long findShiftClosedAfter(const ArchiveIndex* index, long long timeUs);
+
+#endif
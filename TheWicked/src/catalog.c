@@ -0,0 +1,401 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "catalog.h"
+#include "hall.h"
+
+// ---------------------------------------------------------
+// DATA STRUCTURE: The String Pool
+// ---------------------------------------------------------
+// Titles, genres, ids and labels are copied once into large pool blocks
+// and found again through an open-addressing hash set, so a film id used
+// by a hundred "show" lines is stored once and compared by pointer.
+// The pool lives for the whole run (the catalog is read at startup).
+#define INTERN_SLOTS 2048        // Power of two; kept at most half full
+#define INTERN_BLOCK 16384       // Bytes per pool block
+
+static const char* internSlots[INTERN_SLOTS];
+static int internCount = 0;
+static char* poolBlock = NULL;
+static size_t poolUsed = INTERN_BLOCK; // "Full" until the first block exists
+
+// ---------------------------------------------------------
+// DATA STRUCTURE: The Catalog
+// ---------------------------------------------------------
+// 'showings' is indexed like the showtimes of the inventory. The showing
+// hash maps an id to that index (slot value = index + 1, 0 = empty), and
+// 'showingsByFilm' holds every film's showtime indexes sorted by start.
+#define SHOWING_SLOTS 512        // Power of two, at least 2 x MAX_SHOWTIMES
+
+static FilmInfo films[MAX_FILMS];
+static int numFilms = 0;
+static const char* screenNames[MAX_SCREENS];
+static ShowingInfo showings[MAX_SHOWTIMES];
+static int numShowings = 0;
+static short showingSlots[SHOWING_SLOTS];
+static int showingsByFilm[MAX_SHOWTIMES];
+static int scheduleDate = 0;         // YYYYMMDD of the screenings loaded
+
+// Scratch space for loadCatalog (too big for the stack, used once)
+static HallLayout loadHalls[MAX_SCREENS];
+static ShowtimeInfo loadShows[MAX_SHOWTIMES];
+static short loadSlots[SHOWING_SLOTS];
+
+// ---------------------------------------------------------
+// HELPERS
+// ---------------------------------------------------------
+
+// Function: hashText
+// Purpose: 32-bit FNV-1a of a string.
+static unsigned int hashText(const char* text) {
+    unsigned int hash = 2166136261u;
+    while (*text) {
+        hash ^= (unsigned char)*text++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Function: intern
+// Purpose: Returns the pooled copy of 'text', adding it the first time.
+// Returns: NULL if the pool is full.
+static const char* intern(const char* text) {
+    unsigned int slot = hashText(text) & (INTERN_SLOTS - 1);
+    while (internSlots[slot] != NULL) {
+        if (strcmp(internSlots[slot], text) == 0) return internSlots[slot];
+        slot = (slot + 1) & (INTERN_SLOTS - 1);
+    }
+
+    size_t length = strlen(text) + 1;
+    if (internCount >= INTERN_SLOTS / 2 || length > INTERN_BLOCK) return NULL;
+    if (poolUsed + length > INTERN_BLOCK) {
+        // The old block stays allocated: its strings are still in use
+        poolBlock = malloc(INTERN_BLOCK);
+        if (poolBlock == NULL) return NULL;
+        poolUsed = 0;
+    }
+    char* copy = poolBlock + poolUsed;
+    memcpy(copy, text, length);
+    poolUsed += length;
+    internSlots[slot] = copy;
+    internCount++;
+    return copy;
+}
+
+// Function: nextField
+// Purpose: Cuts the next '|'-separated field out of a line and trims it.
+// Returns: The field ("" when missing).
+static char* nextField(char** cursor) {
+    char* field = *cursor;
+    char* bar = strchr(field, '|');
+    if (bar != NULL) { *bar = '\0'; *cursor = bar + 1; }
+    else *cursor = field + strlen(field);
+
+    while (isspace((unsigned char)*field)) field++;
+    size_t length = strlen(field);
+    while (length > 0 && isspace((unsigned char)field[length - 1])) field[--length] = '\0';
+    return field;
+}
+
+// Function: indexOfId
+// Purpose: Position of an interned id in a list of interned ids, or -1.
+// Interned strings are equal only if they are the same pointer.
+static int indexOfId(const char* id, const char* const* ids, int count) {
+    int i;
+    for(i = 0; i < count; i++) {
+        if (ids[i] == id) return i;
+    }
+    return -1;
+}
+
+// Function: todayText
+// Purpose: Today's local date as "YYYY-MM-DD" (the catalog's date format).
+static void todayText(char* buffer, int size) {
+    time_t now = time(NULL);
+    strftime(buffer, size, "%Y-%m-%d", localtime(&now));
+}
+
+// Function: dateNumber
+// Purpose: "2025-03-14" -> 20250314 (0 if the text is not a date).
+static int dateNumber(const char* text) {
+    int year, month, day;
+    if (sscanf(text, "%4d-%2d-%2d", &year, &month, &day) != 3) return 0;
+    return year * 10000 + month * 100 + day;
+}
+
+// Function: formatShowTime
+// Purpose: 13:05 -> "01:05 PM" (the ticket and menu format).
+static void formatShowTime(int minute, char* buffer, int size) {
+    int hour = minute / 60;
+    int hour12 = (hour % 12 == 0) ? 12 : hour % 12;
+    snprintf(buffer, size, "%02d:%02d %s", hour12, minute % 60, (hour < 12) ? "AM" : "PM");
+}
+
+// Function: addShowingId
+// Purpose: Inserts showing 'index' of 'list' into the hash 'slots'
+// (SHOWING_SLOTS entries, 0 = empty).
+// Returns: 0 if the id is already used.
+static int addShowingId(short* slots, const ShowingInfo* list, int index) {
+    unsigned int slot = hashText(list[index].id) & (SHOWING_SLOTS - 1);
+    while (slots[slot] != 0) {
+        if (list[slots[slot] - 1].id == list[index].id) return 0;
+        slot = (slot + 1) & (SHOWING_SLOTS - 1);
+    }
+    slots[slot] = (short)(index + 1);
+    return 1;
+}
+
+// Function: indexShowings
+// Purpose: Rebuilds the showing hash and the per-film lists from 'showings'
+// (whose ids are unique: loadCatalog rejects a file that repeats one).
+// Each film gets a slice of 'showingsByFilm' (counting sort by film), and
+// the slice is insertion-sorted by start (catalogs list shows mostly in order).
+static void indexShowings() {
+    int f, i;
+    memset(showingSlots, 0, sizeof(showingSlots));
+    for(f = 0; f < numFilms; f++) films[f].showingCount = 0;
+
+    for(i = 0; i < numShowings; i++) {
+        addShowingId(showingSlots, showings, i);
+        films[showings[i].film].showingCount++;
+    }
+
+    int next = 0;
+    for(f = 0; f < numFilms; f++) {
+        films[f].firstShowing = next;
+        next += films[f].showingCount;
+        films[f].showingCount = 0;
+    }
+    for(i = 0; i < numShowings; i++) {
+        FilmInfo* film = &films[showings[i].film];
+        int* slice = &showingsByFilm[film->firstShowing];
+        int k = film->showingCount++;
+        while (k > 0 && showings[slice[k - 1]].startMinute > showings[i].startMinute) {
+            slice[k] = slice[k - 1];
+            k--;
+        }
+        slice[k] = i;
+    }
+}
+
+// ---------------------------------------------------------
+// LOADING
+// ---------------------------------------------------------
+
+// Function: loadCatalog
+// Purpose: Parses the catalog into scratch tables; the screens and
+// screenings replace the current schedule only if the whole file is valid.
+int loadCatalog(const char* path, const char* date) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) return 0;
+
+    char today[16];
+    if (date == NULL) {
+        todayText(today, sizeof(today));
+        date = today;
+    }
+
+    // The previous catalog stays usable until the new one is complete
+    FilmInfo newFilms[MAX_FILMS];
+    const char* filmIds[MAX_FILMS];
+    const char* screenIds[MAX_SCREENS];
+    const char* newNames[MAX_SCREENS];
+    ShowingInfo newShowings[MAX_SHOWTIMES];
+    int filmCount = 0, screenCount = 0, showCount = 0;
+    int valid = 1;
+    char line[1024];
+    memset(loadSlots, 0, sizeof(loadSlots)); // Ids of today's shows in the file
+
+    while (valid && fgets(line, sizeof(line), f)) {
+        // Strip the newline (and the '\r' of Windows-edited files)
+        line[strcspn(line, "\r\n")] = '\0';
+
+        char* p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0' || *p == '#') continue;
+
+        if (strncmp(p, "film ", 5) == 0) {
+            char* cursor = p + 5;
+            if (filmCount >= MAX_FILMS) { valid = 0; break; }
+            FilmInfo* film = &newFilms[filmCount];
+            memset(film, 0, sizeof(*film));
+            film->id = intern(nextField(&cursor));
+            film->title = intern(nextField(&cursor));
+            film->genre = intern(nextField(&cursor));
+            film->rating = intern(nextField(&cursor));
+            film->minutes = atoi(nextField(&cursor));
+            film->synopsis = intern(nextField(&cursor));
+            if (!film->id || !film->title || !film->genre || !film->rating || !film->synopsis ||
+                film->id[0] == '\0' || strlen(film->id) >= CATALOG_ID_MAX ||
+                indexOfId(film->id, filmIds, filmCount) >= 0) { valid = 0; break; }
+            filmIds[filmCount++] = film->id;
+        }
+        else if (strncmp(p, "screen ", 7) == 0) {
+            char* cursor = p + 7;
+            if (screenCount >= MAX_SCREENS) { valid = 0; break; }
+            const char* id = intern(nextField(&cursor));
+            const char* name = intern(nextField(&cursor));
+            char* layoutFile = nextField(&cursor);
+            if (!id || !name || id[0] == '\0' || strlen(id) >= CATALOG_ID_MAX ||
+                indexOfId(id, screenIds, screenCount) >= 0 ||
+                readHallLayout(layoutFile, &loadHalls[screenCount], NULL, 0) < 0) { valid = 0; break; }
+            // Screens are found by id while loading, then shown by name
+            screenIds[screenCount] = id;
+            newNames[screenCount] = (name[0] != '\0') ? name : id;
+            screenCount++;
+        }
+        else if (strncmp(p, "show ", 5) == 0) {
+            char* cursor = p + 5;
+            char* spec = nextField(&cursor);
+            char* label = nextField(&cursor);
+            char id[CATALOG_ID_MAX], filmId[CATALOG_ID_MAX], screenId[CATALOG_ID_MAX], day[16];
+            int hour, minute;
+            if (sscanf(spec, "%15s %15s %15s %15s %d:%d", id, filmId, screenId, day, &hour, &minute) != 6 ||
+                hour < 0 || hour > 23 || minute < 0 || minute > 59) { valid = 0; break; }
+            if (strcmp(day, "daily") != 0 && strcmp(day, date) != 0) continue; // Another day
+
+            if (showCount >= MAX_SHOWTIMES) { valid = 0; break; }
+            ShowingInfo* show = &newShowings[showCount];
+            show->id = intern(id);
+            show->film = indexOfId(intern(filmId), filmIds, filmCount);
+            show->screen = indexOfId(intern(screenId), screenIds, screenCount);
+            show->startMinute = hour * 60 + minute;
+            // Films and screens must be declared before the shows that use them
+            if (show->id == NULL || show->film < 0 || show->screen < 0 ||
+                !addShowingId(loadSlots, newShowings, showCount)) { valid = 0; break; }
+
+            ShowtimeInfo* info = &loadShows[showCount];
+            memset(info, 0, sizeof(*info));
+            formatShowTime(show->startMinute, info->time, sizeof(info->time));
+            snprintf(info->label, sizeof(info->label), "%s", label);
+            info->screen = show->screen;
+            showCount++;
+        }
+        else {
+            valid = 0; // Unknown directive
+        }
+    }
+    fclose(f);
+
+    if (!valid || showCount == 0) return 0;
+
+    memcpy(films, newFilms, sizeof(FilmInfo) * filmCount);
+    numFilms = filmCount;
+    memcpy(screenNames, newNames, sizeof(const char*) * screenCount);
+    memcpy(showings, newShowings, sizeof(ShowingInfo) * showCount);
+    numShowings = showCount;
+    indexShowings();
+    scheduleDate = dateNumber(date);
+
+    installSchedule(loadHalls, screenCount, loadShows, showCount);
+    return 1;
+}
+
+// Function: useDefaultCatalog
+// Purpose: The single-film cinema this kiosk started as. Showing ids are
+// "S1", "S2", ... and start times are read back from the menu times.
+void useDefaultCatalog() {
+    static const char* synopsis =
+        "Wicked tells the untold story of Elphaba, a misunderstood green-skinned girl "
+        "who forms an unlikely friendship with the popular Glinda. As Elphaba uncovers "
+        "corruption in Oz and stands up for justice, she becomes labeled the Wicked Witch, "
+        "revealing that heroes and villains aren't always what they seem.";
+    int i;
+
+    memset(films, 0, sizeof(FilmInfo));
+    films[0].id = intern("WICKED");
+    films[0].title = intern("THE WICKED GOOD");
+    films[0].genre = intern("Fantasy / Musical");
+    films[0].rating = intern("R-16");
+    films[0].synopsis = intern(synopsis);
+    films[0].minutes = 135;
+    numFilms = 1;
+    screenNames[0] = intern("Cinema 1");
+
+    numShowings = getNumShowtimes();
+    for(i = 0; i < numShowings; i++) {
+        char id[CATALOG_ID_MAX], half[4] = "";
+        int hour = 0, minute = 0;
+        snprintf(id, sizeof(id), "S%d", i + 1);
+        sscanf(getShowtimeInfo(i)->time, "%d:%d %3s", &hour, &minute, half);
+        if (hour == 12) hour = 0;
+        if (toupper((unsigned char)half[0]) == 'P') hour += 12;
+
+        showings[i].id = intern(id);
+        showings[i].film = 0;
+        showings[i].screen = getShowtimeInfo(i)->screen;
+        showings[i].startMinute = hour * 60 + minute;
+    }
+    indexShowings();
+
+    // The same shows play every day; today's are the ones loaded
+    char today[16];
+    todayText(today, sizeof(today));
+    scheduleDate = dateNumber(today);
+}
+
+// ---------------------------------------------------------
+// LOOKUPS
+// ---------------------------------------------------------
+
+int getNumFilms() {
+    return numFilms;
+}
+
+const FilmInfo* getFilmInfo(int film) {
+    return &films[film];
+}
+
+const char* getScreenName(int screen) {
+    return (screen >= 0 && screen < getNumScreens() && screenNames[screen] != NULL) ? screenNames[screen] : "";
+}
+
+int getScheduleDate() {
+    return scheduleDate;
+}
+
+const ShowingInfo* getShowingInfo(int showtimeIndex) {
+    if (showtimeIndex < 0 || showtimeIndex >= numShowings) return NULL;
+    return &showings[showtimeIndex];
+}
+
+// Function: findFilm
+// Purpose: A catalog has a few dozen films: a straight scan is enough.
+int findFilm(const char* id) {
+    int f;
+    for(f = 0; f < numFilms; f++) {
+        if (strcmp(films[f].id, id) == 0) return f;
+    }
+    return -1;
+}
+
+// Function: findShowing
+// Purpose: One hash, then a short probe (the table is at most half full).
+int findShowing(const char* id) {
+    unsigned int slot = hashText(id) & (SHOWING_SLOTS - 1);
+    while (showingSlots[slot] != 0) {
+        int index = showingSlots[slot] - 1;
+        if (strcmp(showings[index].id, id) == 0) return index;
+        slot = (slot + 1) & (SHOWING_SLOTS - 1);
+    }
+    return -1;
+}
+
+// Function: findNextShowings
+// Purpose: Binary search for the first screening at or after 'fromMinute'
+// in the film's sorted slice, then copies from there.
+int findNextShowings(int film, int fromMinute, int* out, int max) {
+    if (film < 0 || film >= numFilms) return 0;
+    const int* slice = &showingsByFilm[films[film].firstShowing];
+    int low = 0, high = films[film].showingCount;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (showings[slice[mid]].startMinute < fromMinute) low = mid + 1;
+        else high = mid;
+    }
+    int count = 0;
+    while (low < films[film].showingCount && count < max) out[count++] = slice[low++];
+    return count;
+}
@@ -0,0 +1,87 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include "hall.h"
+
+// ---------------------------------------------------------
+// MOVIE & SHOWTIME CATALOG
+// ---------------------------------------------------------
+// Films, screens and the screenings of the day are read once at startup
+// from a text file (see catalog.txt) instead of being hard-coded:
+//
+//   film   <id> | <title> | <genre> | <rating> | <minutes> | <synopsis>
+//   screen <id> | <name> | <layout file>
+//   show   <id> <film id> <screen id> <YYYY-MM-DD | daily> <HH:MM> | <label>
+//
+// Every screen uses the "row" lines of its own layout file (the format of
+// hall_layout.txt; its "show" lines are ignored). Only the screenings of
+// the day being loaded are kept, and they become the showtimes of the
+// inventory in file order: showtime index N is the Nth screening kept.
+//
+// Lookups never walk the whole catalog:
+//   - strings are interned, so ids compare by pointer after one hash probe
+//   - showing ids go into an open-addressing hash table (findShowing)
+//   - each film keeps its screenings sorted by start time, so "next shows
+//     of film X" is a binary search (findNextShowings)
+//   - a showing IS a showtime index, so showing -> seats is an array offset
+#define CATALOG_FILE "catalog.txt"
+
+#define MAX_FILMS 64
+#define CATALOG_ID_MAX 16     // Longest film / screen / showing id (with the '\0')
+
+// One film of the catalog. The strings are interned (never freed).
+typedef struct {
+    const char* id;
+    const char* title;
+    const char* genre;
+    const char* rating;
+    const char* synopsis;
+    int minutes;             // Runtime
+    int firstShowing;        // Its screenings, by start time (see findNextShowings)
+    int showingCount;
+} FilmInfo;
+
+// One screening of the loaded day (same index as the showtime).
+typedef struct {
+    const char* id;
+    int film;                // Index of the film
+    int screen;              // Index of the screen (= ShowtimeInfo.screen)
+    int startMinute;         // Minutes after midnight
+} ShowingInfo;
+
+// ---------------------------------------------------------
+// FUNCTION PROTOTYPES
+// ---------------------------------------------------------
+
+// Reads the catalog and installs its screens and the screenings of 'date'
+// ("YYYY-MM-DD", NULL = today) as the schedule (see installSchedule).
+// Returns: 1 on success, 0 if the file is missing, invalid, or has no
+// screening that day (nothing is changed in that case).
+int loadCatalog(const char* path, const char* date);
+
+// Describes whatever schedule hall.c has now (hall_layout.txt or the
+// built-in hall) as one film playing every showtime on one screen.
+void useDefaultCatalog();
+
+// Films, screens and showings of the loaded catalog.
+int getNumFilms();
+const FilmInfo* getFilmInfo(int film);
+const char* getScreenName(int screen);
+const ShowingInfo* getShowingInfo(int showtimeIndex);
+
+// The day whose screenings are loaded, as YYYYMMDD (e.g. 20250314).
+// Seats sold for another day's schedule must not be restored into this one.
+int getScheduleDate();
+
+// Returns: The index of the film with this id, or -1.
+int findFilm(const char* id);
+
+// Returns: The showtime index of the showing with this id, or -1.
+int findShowing(const char* id);
+
+// Copies the showtime indexes of up to 'max' screenings of a film that
+// start at or after 'fromMinute' (minutes after midnight), earliest first.
+// Returns: How many were copied.
+int findNextShowings(int film, int fromMinute, int* out, int max);
+
+#endif
@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "concessions.h"
+#include "remote.h"
+
+// ---------------------------------------------------------
+// DATA STRUCTURE: The Stand
+// ---------------------------------------------------------
+// 'items' only changes while loading; 'stockLeft' is the live part and is
+// only touched with atomic operations (one counter per SKU, so kiosks
+// selling different items never touch the same word).
+static ConcessionItem items[MAX_CONCESSIONS];
+static int stockLeft[MAX_CONCESSIONS];
+static int numItems = 0;
+
+// The stand before there was a concessions file: SKUs 1-4, stock not counted
+static const ConcessionItem defaultItems[] = {
+    { 1, "Salted Popcorn", PESOS(150) },
+    { 2, "Large Soda",     PESOS(80)  },
+    { 3, "Mineral Water",  PESOS(40)  },
+    { 4, "Wicked T-Shirt", PESOS(500) },
+};
+
+// ---------------------------------------------------------
+// HELPERS
+// ---------------------------------------------------------
+
+// Function: nextField
+// Purpose: Cuts the next '|'-separated field out of a line and trims it.
+static char* nextField(char** cursor) {
+    char* field = *cursor;
+    char* bar = strchr(field, '|');
+    if (bar != NULL) { *bar = '\0'; *cursor = bar + 1; }
+    else *cursor = field + strlen(field);
+
+    while (isspace((unsigned char)*field)) field++;
+    size_t length = strlen(field);
+    while (length > 0 && isspace((unsigned char)field[length - 1])) field[--length] = '\0';
+    return field;
+}
+
+// Function: useDefaultConcessions
+static void useDefaultConcessions() {
+    int i;
+    numItems = (int)(sizeof(defaultItems) / sizeof(defaultItems[0]));
+    for(i = 0; i < numItems; i++) {
+        items[i] = defaultItems[i];
+        stockLeft[i] = STOCK_UNLIMITED;
+    }
+}
+
+// ---------------------------------------------------------
+// LOADING
+// ---------------------------------------------------------
+
+// Function: loadConcessions
+// Purpose: Reads the whole file into scratch tables first; a bad line
+// leaves the defaults in place instead of half a menu.
+int loadConcessions(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) { useDefaultConcessions(); return 0; }
+
+    ConcessionItem newItems[MAX_CONCESSIONS];
+    int newStock[MAX_CONCESSIONS];
+    int count = 0, valid = 1, i;
+    char line[256];
+
+    while (valid && fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char* p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0' || *p == '#') continue;
+        if (strncmp(p, "sku ", 4) != 0 || count >= MAX_CONCESSIONS) { valid = 0; break; }
+
+        char* cursor = p + 4;
+        char* number = nextField(&cursor);
+        char* name = nextField(&cursor);
+        char* price = nextField(&cursor);
+        char* stock = nextField(&cursor);
+
+        ConcessionItem* item = &newItems[count];
+        item->sku = atoi(number);
+        if (!isdigit((unsigned char)number[0]) || item->sku < 1 || item->sku > 65535 ||
+            name[0] == '\0' || strlen(name) >= CONCESSION_NAME_MAX ||
+            parseMoney(price, &item->price) != (int)strlen(price) || item->price < 0 ||
+            item->price > PESOS(1000000)) { valid = 0; break; }
+        snprintf(item->name, sizeof(item->name), "%s", name);
+
+        if (strcmp(stock, "-") == 0) newStock[count] = STOCK_UNLIMITED;
+        else if (isdigit((unsigned char)stock[0])) newStock[count] = atoi(stock);
+        else { valid = 0; break; }
+
+        for(i = 0; i < count; i++) {
+            if (newItems[i].sku == item->sku) valid = 0; // Listed twice
+        }
+        count++;
+    }
+    fclose(f);
+
+    if (!valid || count == 0) { useDefaultConcessions(); return 0; }
+    memcpy(items, newItems, sizeof(ConcessionItem) * count);
+    memcpy(stockLeft, newStock, sizeof(int) * count);
+    numItems = count;
+    return 1;
+}
+
+// Function: restoreConcessionStock
+// Purpose: The file holds the stock at the start of the shift; whatever
+// the sales log already sold is off the shelf.
+void restoreConcessionStock(const char* logPath) {
+    SalesView view;
+    if (!mapSalesFile(logPath, &view)) return;
+
+    PackedItem sold[MAX_SALE_ITEMS];
+    long long i;
+    int k;
+    for(i = 0; i < view.count && isSalesRecordComplete(&view, i); i = nextSalesRecord(&view, i)) {
+        if (view.records[i].kind != REC_SALE || view.records[i].followers == 0) continue;
+        int count = getSaleItems(&view, i, sold, MAX_SALE_ITEMS);
+        for(k = 0; k < count; k++) {
+            int item = findConcession(sold[k].sku);
+            if (item < 0 || stockLeft[item] == STOCK_UNLIMITED) continue;
+            stockLeft[item] = (stockLeft[item] > sold[k].qty) ? stockLeft[item] - sold[k].qty : 0;
+        }
+    }
+    unmapSalesFile(&view);
+}
+
+// ---------------------------------------------------------
+// THE STAND
+// ---------------------------------------------------------
+
+int getNumConcessions() {
+    return numItems;
+}
+
+const ConcessionItem* getConcessionItem(int item) {
+    return &items[item];
+}
+
+// Function: findConcession
+// Purpose: A stand has a few dozen SKUs at most: a straight scan of the
+// packed array is as fast as any index.
+int findConcession(int sku) {
+    int i;
+    for(i = 0; i < numItems; i++) {
+        if (items[i].sku == sku) return i;
+    }
+    return -1;
+}
+
+int getStockLeft(int item) {
+    return __atomic_load_n(&stockLeft[item], __ATOMIC_RELAXED);
+}
+
+void setStockLeft(int item, int left) {
+    __atomic_store_n(&stockLeft[item], left, __ATOMIC_RELAXED);
+}
+
+// Function: takeStock
+// Purpose: Compare-and-swap from 'left' to 'left - qty'. If another kiosk
+// changed the counter in between, the CAS fails, 'left' is reloaded and
+// we try again; nobody ever waits for a lock.
+int takeStock(int item, int qty) {
+    if (isRemoteKiosk()) return remoteTakeStock(items[item].sku, qty);
+
+    int left = __atomic_load_n(&stockLeft[item], __ATOMIC_RELAXED);
+    do {
+        if (left == STOCK_UNLIMITED) return 1;
+        if (left < qty) return 0;
+    } while (!__atomic_compare_exchange_n(&stockLeft[item], &left, left - qty, 1,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+    return 1;
+}
+
+// Function: returnStock
+void returnStock(int item, int qty) {
+    if (isRemoteKiosk()) { remoteReturnStock(items[item].sku, qty); return; }
+    if (__atomic_load_n(&stockLeft[item], __ATOMIC_RELAXED) == STOCK_UNLIMITED) return;
+    __atomic_add_fetch(&stockLeft[item], qty, __ATOMIC_ACQ_REL);
+}
+
+// ---------------------------------------------------------
+// ORDERS
+// ---------------------------------------------------------
+
+void startOrder(ConcessionOrder* order) {
+    order->lineCount = 0;
+    order->total = 0;
+}
+
+// Function: addToOrder
+// Purpose: Same SKU again = one more on its line (the receipt lists each once).
+int addToOrder(ConcessionOrder* order, int item, int qty) {
+    int line;
+    for(line = 0; line < order->lineCount; line++) {
+        if (order->lines[line].item == item) break;
+    }
+    if (line == order->lineCount && line >= MAX_ORDER_LINES) return -1;
+    if (!takeStock(item, qty)) return 0;
+
+    if (line == order->lineCount) {
+        order->lines[line].item = item;
+        order->lines[line].qty = 0;
+        order->lines[line].unitPrice = items[item].price;
+        order->lineCount++;
+    }
+    order->lines[line].qty += qty;
+    order->total += items[item].price * qty;
+    return 1;
+}
+
+void cancelOrder(ConcessionOrder* order) {
+    int line;
+    for(line = 0; line < order->lineCount; line++) {
+        returnStock(order->lines[line].item, order->lines[line].qty);
+    }
+    startOrder(order);
+}
+
+int packOrder(const ConcessionOrder* order, PackedItem* out, int max) {
+    int line;
+    for(line = 0; line < order->lineCount && line < max; line++) {
+        out[line].sku = (uint16_t)items[order->lines[line].item].sku;
+        out[line].qty = (uint16_t)order->lines[line].qty;
+        out[line].unitCentavos = (int32_t)order->lines[line].unitPrice;
+    }
+    return line;
+}
+
+// Function: formatPackedItems
+int formatPackedItems(const PackedItem* list, int count, char* buffer, int size) {
+    int used = 0, i;
+    if (count == 0) return snprintf(buffer, size, "-") < size;
+    for(i = 0; i < count; i++) {
+        int n = snprintf(buffer + used, size - used, "%s%u:%u:%ld", (i == 0) ? "" : ",",
+                         (unsigned)list[i].sku, (unsigned)list[i].qty, (long)list[i].unitCentavos);
+        if (n < 0 || n >= size - used) return 0;
+        used += n;
+    }
+    return 1;
+}
+
+// Function: parsePackedItems
+int parsePackedItems(const char* text, PackedItem* out, int max) {
+    if (strcmp(text, "-") == 0) return 0;
+
+    int count = 0;
+    const char* p = text;
+    while (*p != '\0') {
+        unsigned sku, qty;
+        long unit;
+        int length;
+        if (count >= max || sscanf(p, "%u:%u:%ld%n", &sku, &qty, &unit, &length) != 3) return -1;
+        if (findConcession((int)sku) < 0 || qty == 0 || qty > 65535 || unit < 0) return -1;
+        out[count].sku = (uint16_t)sku;
+        out[count].qty = (uint16_t)qty;
+        out[count].unitCentavos = (int32_t)unit;
+        count++;
+
+        p += length;
+        if (*p == ',') p++;
+        else if (*p != '\0') return -1;
+    }
+    return count;
+}
@@ -0,0 +1,109 @@
+#ifndef CONCESSIONS_H
+#define CONCESSIONS_H
+
+#include "money.h"
+#include "salesrec.h"
+
+// ---------------------------------------------------------
+// CONCESSION STAND
+// ---------------------------------------------------------
+// The snacks and merchandise are read at startup from a text file (see
+// concessions.txt), one SKU per line:
+//
+//   sku <number> | <name> | <price> | <stock at the start of the shift | ->
+//
+// The number is what the menu shows, what scripts type and what the sales
+// log stores ("-" = stock not counted). Every SKU has its own stock
+// counter, taken with a compare-and-swap when an item goes into an order,
+// so any number of kiosks can sell from the stand at once without a lock.
+// Items of a cancelled order go back on the shelf. The sales already in
+// the log are subtracted again after a restart (restoreConcessionStock).
+#define CONCESSIONS_FILE "concessions.txt"
+
+#define MAX_CONCESSIONS 64
+#define CONCESSION_NAME_MAX 24
+#define STOCK_UNLIMITED -1
+
+#define MAX_ORDER_LINES 16       // Different SKUs in one order
+
+// One SKU of the stand.
+typedef struct {
+    int sku;
+    char name[CONCESSION_NAME_MAX];
+    Money price;
+} ConcessionItem;
+
+// One line of a customer's order (the price is the one charged).
+typedef struct {
+    int item;                    // Index in the stand (getConcessionItem)
+    int qty;
+    Money unitPrice;
+} OrderLine;
+
+// The extras of one purchase. Its items are already taken from stock.
+typedef struct {
+    int lineCount;
+    OrderLine lines[MAX_ORDER_LINES];
+    Money total;
+} ConcessionOrder;
+
+// ---------------------------------------------------------
+// THE STAND
+// ---------------------------------------------------------
+
+// Loads the SKUs and their opening stock. Without a usable file the stand
+// sells the four classic items (popcorn, soda, water, T-shirt; SKUs 1-4)
+// without counting stock.
+// Returns: 1 if the file was loaded, 0 if the defaults are used.
+int loadConcessions(const char* path);
+
+// Subtracts the items of every sale in the sales log from the stock
+// (call once at startup, after the log is repaired, like restoreInventory).
+void restoreConcessionStock(const char* logPath);
+
+int getNumConcessions();
+const ConcessionItem* getConcessionItem(int item);
+
+// Index of a SKU number, or -1 if the stand does not sell it.
+int findConcession(int sku);
+
+// Units left of an item (STOCK_UNLIMITED if not counted).
+int getStockLeft(int item);
+
+// Takes 'qty' units off the shelf (all or nothing, lock-free).
+// Returns: 1 if taken, 0 if there are not enough left.
+int takeStock(int item, int qty);
+
+// Puts units back (cancelled order).
+void returnStock(int item, int qty);
+
+// Sets the stock of a SKU (thin-client kiosk: the mirror of the server's counters).
+void setStockLeft(int item, int left);
+
+// ---------------------------------------------------------
+// ORDERS
+// ---------------------------------------------------------
+
+// Empties an order (nothing is taken from stock).
+void startOrder(ConcessionOrder* order);
+
+// Adds units of an item to the order, taking them from stock.
+// Returns: 1 if added, 0 if sold out, -1 if the order has no free line.
+int addToOrder(ConcessionOrder* order, int item, int qty);
+
+// Returns every item of the order to stock and empties it.
+void cancelOrder(ConcessionOrder* order);
+
+// Copies the order into sales log form (SKU, quantity, unit price).
+// Returns: Number of items written (at most 'max').
+int packOrder(const ConcessionOrder* order, PackedItem* out, int max);
+
+// Writes "1:2:15000,3:1:4000" (sku:qty:centavos each) or "-" for no items.
+// Returns: 1 on success, 0 if the buffer is too small.
+int formatPackedItems(const PackedItem* items, int count, char* buffer, int size);
+
+// Reads the text of formatPackedItems() (the SKUs must exist).
+// Returns: Number of items, or -1 if the text is invalid.
+int parsePackedItems(const char* text, PackedItem* out, int max);
+
+#endif
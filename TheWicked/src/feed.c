@@ -0,0 +1,82 @@
+#include <stdlib.h>
+#include <string.h>
+#include "feed.h"
+#include "inventory.h"
+
+// One ring per showtime. 'head' is the sequence number of the newest
+// delta; delta 'seq' lives in slot seq % FEED_RING_SIZE.
+// Publishing takes a tiny spin lock: the row words are read inside it,
+// so a later sequence number always carries the newer row state even
+// when two kiosks change the same row at the same moment.
+typedef struct {
+    char lock;
+    unsigned long long head;
+    SeatDelta ring[FEED_RING_SIZE];
+} ShowtimeFeed;
+
+static ShowtimeFeed* feeds = NULL;   // One per showtime of the schedule
+static int feedCount = 0;
+
+// Function: lockFeed
+// Purpose: Spin until the ring is ours (held for a few loads and stores).
+static void lockFeed(ShowtimeFeed* feed) {
+    while (__atomic_test_and_set(&feed->lock, __ATOMIC_ACQUIRE)) { }
+}
+
+// Function: unlockFeed
+static void unlockFeed(ShowtimeFeed* feed) {
+    __atomic_clear(&feed->lock, __ATOMIC_RELEASE);
+}
+
+// Function: resetSeatFeed
+// Purpose: Sized to the schedule, since the catalog can have a few
+// hundred showtimes (about 4 KB of ring each).
+void resetSeatFeed() {
+    free(feeds);
+    feedCount = getNumShowtimes();
+    feeds = calloc((size_t)feedCount + 1, sizeof(ShowtimeFeed));
+    if (feeds == NULL) feedCount = 0;
+}
+
+// Function: publishRowChange
+void publishRowChange(int showtimeIndex, int r) {
+    if (showtimeIndex < 0 || showtimeIndex >= feedCount) return;
+    ShowtimeFeed* feed = &feeds[showtimeIndex];
+
+    lockFeed(feed);
+    SeatDelta* delta = &feed->ring[(feed->head + 1) % FEED_RING_SIZE];
+    delta->seq = feed->head + 1;
+    delta->row = r;
+    copyRowWords(showtimeIndex, r, &delta->taken, &delta->sold);
+    __atomic_store_n(&feed->head, delta->seq, __ATOMIC_RELEASE);
+    unlockFeed(feed);
+}
+
+// Function: getFeedSequence
+unsigned long long getFeedSequence(int showtimeIndex) {
+    if (showtimeIndex < 0 || showtimeIndex >= feedCount) return 0;
+    return __atomic_load_n(&feeds[showtimeIndex].head, __ATOMIC_ACQUIRE);
+}
+
+// Function: readSeatFeed
+int readSeatFeed(int showtimeIndex, unsigned long long after, SeatDelta* out, int max) {
+    if (showtimeIndex < 0 || showtimeIndex >= feedCount) return FEED_RESYNC;
+    ShowtimeFeed* feed = &feeds[showtimeIndex];
+
+    // Cheap check first: most polls find nothing new
+    unsigned long long head = getFeedSequence(showtimeIndex);
+    if (after == head) return 0;
+
+    lockFeed(feed);
+    head = feed->head;
+    // Too old (overwritten), too many, or from before a reset
+    if (after > head || head - after > FEED_RING_SIZE || head - after > (unsigned long long)max) {
+        unlockFeed(feed);
+        return FEED_RESYNC;
+    }
+    int count = 0;
+    unsigned long long seq;
+    for(seq = after + 1; seq <= head; seq++) out[count++] = feed->ring[seq % FEED_RING_SIZE];
+    unlockFeed(feed);
+    return count;
+}
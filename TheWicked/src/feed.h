@@ -0,0 +1,50 @@
+#ifndef FEED_H
+#define FEED_H
+
+#include "hall.h"
+
+// ---------------------------------------------------------
+// SEAT CHANGE FEED
+// ---------------------------------------------------------
+// Every time a row of the inventory changes (claim, release, sale,
+// hold expiry, restore) the new state of that row is appended to a
+// per-showtime ring with a sequence number. A screen that has drawn
+// the map at sequence N only needs the deltas after N to catch up,
+// so the cost of keeping many displays current follows the number of
+// sales, not the number of displays times the size of the hall.
+//
+// A delta carries the whole row (both words), so applying it is an
+// overwrite: deltas can be applied more than once and a copy of the
+// map taken while they were being published is fixed up by them.
+// A reader that fell more than FEED_RING_SIZE deltas behind has to
+// start over from a full copy (copyShowtimeWords + getFeedSequence).
+#define FEED_RING_SIZE 128   // Deltas kept per showtime (power of two)
+#define FEED_RESYNC -1       // readSeatFeed(): take a full copy instead
+
+// The state of one row after a change.
+typedef struct {
+    unsigned long long seq;   // 1, 2, 3, ... per showtime
+    int row;
+    SeatWord taken;           // Claimed or sold (see inventory.h)
+    SeatWord sold;
+} SeatDelta;
+
+// Empties every ring (sequence numbers start again at 0) and sizes them
+// for the current schedule. Called by buildInventory().
+void resetSeatFeed();
+
+// Appends the current state of one row. Called by the inventory after
+// every change; safe from several kiosk threads at once.
+void publishRowChange(int showtimeIndex, int r);
+
+// Sequence number of the newest delta of a showtime (0 = none yet).
+// Read it BEFORE copying the map, then ask for the deltas after it.
+unsigned long long getFeedSequence(int showtimeIndex);
+
+// Copies the deltas newer than 'after' into 'out', oldest first.
+// Returns: Number of deltas (0 = up to date), or FEED_RESYNC if some are
+// no longer in the ring or more than 'max' are pending (then a full
+// copy of the map is smaller anyway).
+int readSeatFeed(int showtimeIndex, unsigned long long after, SeatDelta* out, int max);
+
+#endif
@@ -0,0 +1,319 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "groups.h"
+#include "hall.h"
+#include "inventory.h"
+#include "holds.h"
+#include "pricing.h"
+#include "remote.h"
+#include "utilities.h"
+
+// ---------------------------------------------------------
+// DATA STRUCTURE: The Search
+// ---------------------------------------------------------
+// A run is a stretch of adjacent free seats in one row. Parties are always
+// seated from the LEFT end of what is still free in a run, so the state of
+// a run is a single number ('left' = free seats at its right end) and
+// seating / un-seating a party is one addition.
+#define MAX_GROUP_RUNS (MAX_ROWS * SEATS_PER_WORD / 2) // Every other seat free
+#define MAX_GROUP_SEATS (MAX_ROWS * MAX_COLS)
+#define SPLIT_PARTY -1             // Choice: the party fits in no run whole
+#define BUDGET_CHECK_NODES 256     // Read the clock once per this many nodes
+
+typedef struct {
+    int row;
+    int start;                     // Column of the first seat of the run
+    int length;
+} FreeRun;
+
+// One piece of a split party (kept so the split can be undone).
+typedef struct {
+    int run;
+    int count;
+} RunPiece;
+
+typedef struct {
+    FreeRun runs[MAX_GROUP_RUNS];
+    int left[MAX_GROUP_RUNS];
+    int runCount;
+
+    int partyCount;
+    int order[MAX_GROUP_PARTIES];  // Party indices, largest party first
+    int sizes[MAX_GROUP_PARTIES];  // Sizes in that order
+
+    int choice[MAX_GROUP_PARTIES]; // Run of each party on the current path
+    int bestChoice[MAX_GROUP_PARTIES];
+    int bestCost;
+    int found;
+
+    RunPiece pieces[MAX_GROUP_SEATS];
+    int pieceTop;
+
+    long long nodes;
+    long long deadlineUs;
+    int stopped;                   // The time budget ran out
+} GroupSearch;
+
+// ---------------------------------------------------------
+// HELPERS
+// ---------------------------------------------------------
+
+// Function: collectRuns
+// Purpose: Splits the free seats of every row of the class into runs,
+// front row first. Wheelchair bays are left out, as in reserveSeats().
+// Returns: Total free seats in the runs.
+static int collectRuns(GroupSearch* search, int showtimeIndex, int type) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    int total = 0, i;
+    search->runCount = 0;
+
+    for(i = 0; i < hall->classRowCount[type]; i++) {
+        int r = hall->classRows[type][i];
+        SeatWord freeBits = getRowFreeMask(showtimeIndex, r) & ~hall->wheelMask[r];
+
+        while (freeBits != 0 && search->runCount < MAX_GROUP_RUNS) {
+            int start = lowestBitIndex(freeBits);
+            // The run ends at the first zero above 'start'
+            SeatWord above = ~(freeBits >> start);
+            int length = (above == 0) ? SEATS_PER_WORD - start : lowestBitIndex(above);
+
+            FreeRun* run = &search->runs[search->runCount];
+            run->row = r;
+            run->start = start;
+            run->length = length;
+            search->left[search->runCount] = length;
+            search->runCount++;
+            total += length;
+
+            if (start + length >= SEATS_PER_WORD) break;
+            freeBits &= ~((((SeatWord)1 << length) - 1) << start);
+        }
+    }
+    return total;
+}
+
+// Function: takeSeats
+// Purpose: Seats 'count' people at the left end of what is free in a run.
+// With 'out' == NULL only the count changes (the search); otherwise the
+// seats are written out too (the final plan).
+static void takeSeats(GroupSearch* search, int run, int count, SeatSelection* out, int type, Money price) {
+    const FreeRun* r = &search->runs[run];
+    int first = r->start + (r->length - search->left[run]);
+    int i;
+    search->left[run] -= count;
+    if (out == NULL) return;
+
+    for(i = 0; i < count; i++) {
+        out[i].r = r->row;
+        out[i].c = first + i;
+        out[i].type = type;
+        out[i].rowChar = 'A' + r->row;
+        out[i].price = price;
+    }
+}
+
+// Function: splitParty
+// Purpose: A party larger than every run: keeps filling the largest run
+// until the rest fits in one run, then puts the rest in the tightest one.
+// That is the fewest pieces possible. The pieces go on the piece stack.
+// Returns: Number of pieces (0 if the free seats ran out).
+static int splitParty(GroupSearch* search, int size, SeatSelection* out, int type, Money price) {
+    int need = size, pieces = 0, i;
+    while (need > 0) {
+        int fit = -1, largest = -1;
+        for(i = 0; i < search->runCount; i++) {
+            int left = search->left[i];
+            if (left >= need && (fit < 0 || left < search->left[fit])) fit = i;
+            if (left > 0 && (largest < 0 || left > search->left[largest])) largest = i;
+        }
+        if (largest < 0) break;
+
+        int run = (fit >= 0) ? fit : largest;
+        int count = (fit >= 0) ? need : search->left[largest];
+        takeSeats(search, run, count, out, type, price);
+        if (out != NULL) out += count;
+        search->pieces[search->pieceTop].run = run;
+        search->pieces[search->pieceTop].count = count;
+        search->pieceTop++;
+        pieces++;
+        need -= count;
+    }
+    return (need == 0) ? pieces : 0;
+}
+
+// Function: countOrphans
+// Purpose: Single seats the plan cut off (a run that was longer than one
+// seat and now has exactly one free seat left).
+static int countOrphans(const GroupSearch* search) {
+    int orphans = 0, i;
+    for(i = 0; i < search->runCount; i++) {
+        if (search->left[i] == 1 && search->runs[i].length > 1) orphans++;
+    }
+    return orphans;
+}
+
+// Function: searchPlans
+// Purpose: Depth-first search over the parties (largest first).
+// 'cost' is what the path costs so far without its orphans; it only ever
+// grows, so a path that already costs as much as the best plan is dropped.
+// Candidate runs are tried tightest first, and of several runs with the
+// same free length only the front-most is tried (they give the same cost).
+static void searchPlans(GroupSearch* search, int depth, int cost) {
+    if (search->stopped || cost >= search->bestCost) return;
+
+    search->nodes++;
+    if (search->found && (search->nodes % BUDGET_CHECK_NODES) == 0 &&
+        getMonotonicMicros() > search->deadlineUs) {
+        search->stopped = 1;
+        return;
+    }
+
+    if (depth == search->partyCount) {
+        int total = cost + GROUP_ORPHAN_COST * countOrphans(search);
+        if (total < search->bestCost) {
+            search->bestCost = total;
+            memcpy(search->bestChoice, search->choice, sizeof(int) * search->partyCount);
+            search->found = 1;
+        }
+        return;
+    }
+
+    int size = search->sizes[depth];
+    if (size <= SEATS_PER_WORD) {
+        // First run of every (free length, untouched) kind
+        int firstRun[SEATS_PER_WORD + 1][2];
+        int i, length, untouched, tried = 0;
+        memset(firstRun, -1, sizeof(firstRun));
+        for(i = 0; i < search->runCount; i++) {
+            int left = search->left[i];
+            untouched = (left == search->runs[i].length);
+            if (left >= size && firstRun[left][untouched] < 0) firstRun[left][untouched] = i;
+        }
+
+        for(length = size; length <= SEATS_PER_WORD; length++) {
+            for(untouched = 0; untouched < 2; untouched++) {
+                int run = firstRun[length][untouched];
+                if (run < 0) continue;
+                tried = 1;
+                search->choice[depth] = run;
+                search->left[run] -= size;
+                searchPlans(search, depth + 1, cost + (untouched ? GROUP_RUN_COST : 0));
+                search->left[run] += size;
+                if (search->stopped) return;
+            }
+        }
+        if (tried) return;
+    }
+
+    // No run holds the whole party: split it
+    int base = search->pieceTop, opened = 0, i;
+    search->choice[depth] = SPLIT_PARTY;
+    int pieces = splitParty(search, size, NULL, 0, 0);
+    for(i = base; i < search->pieceTop; i++) {
+        const RunPiece* piece = &search->pieces[i];
+        if (search->left[piece->run] + piece->count == search->runs[piece->run].length) opened++;
+    }
+    if (pieces > 0) {
+        searchPlans(search, depth + 1, cost + GROUP_SPLIT_COST * (pieces - 1) + GROUP_RUN_COST * opened);
+    }
+    while (search->pieceTop > base) {
+        search->pieceTop--;
+        search->left[search->pieces[search->pieceTop].run] += search->pieces[search->pieceTop].count;
+    }
+}
+
+// ---------------------------------------------------------
+// PUBLIC API
+// ---------------------------------------------------------
+
+// Function: parsePartySizes
+int parsePartySizes(const char* text, int* sizes) {
+    int count = 0;
+    const char* p = text;
+    while (*p != '\0') {
+        while (isspace((unsigned char)*p)) p++;
+        if (!isdigit((unsigned char)*p) || count >= MAX_GROUP_PARTIES) return -1;
+
+        long size = strtol(p, (char**)&p, 10);
+        if (size < 1 || size > MAX_GROUP_SEATS) return -1;
+        sizes[count++] = (int)size;
+
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == ',') p++;
+        else if (*p != '\0') return -1;
+    }
+    return (count > 0) ? count : -1;
+}
+
+// Function: planGroupSeating
+// Purpose: Runs the search on a private copy of the free runs, then replays
+// the cheapest plan to write out the seats of every party.
+int planGroupSeating(int showtimeIndex, int type, const int* partySizes, int partyCount,
+                     int budgetUs, SeatSelection* seats, GroupPlan* plan) {
+    long long startUs = getMonotonicMicros();
+    int i, j;
+
+    memset(plan, 0, sizeof(GroupPlan));
+    if (partyCount < 1 || partyCount > MAX_GROUP_PARTIES) return 0;
+    plan->partyCount = partyCount;
+    for(i = 0; i < partyCount; i++) {
+        plan->sizes[i] = partySizes[i];
+        plan->firstSeat[i] = plan->totalSeats;
+        plan->totalSeats += partySizes[i];
+    }
+
+    if (isRemoteKiosk()) syncRemoteShowtime(showtimeIndex);
+    else advanceHolds(); // Expired holds go back to the pool first
+
+    GroupSearch* search = malloc(sizeof(GroupSearch));
+    if (search == NULL) return 0;
+    if (collectRuns(search, showtimeIndex, type) < plan->totalSeats) { free(search); return 0; }
+
+    // Largest party first (insertion sort: a block has a few dozen parties)
+    search->partyCount = partyCount;
+    for(i = 0; i < partyCount; i++) {
+        int party = i;
+        for(j = i; j > 0 && partySizes[search->order[j - 1]] < partySizes[party]; j--) {
+            search->order[j] = search->order[j - 1];
+        }
+        search->order[j] = party;
+    }
+    for(i = 0; i < partyCount; i++) search->sizes[i] = partySizes[search->order[i]];
+
+    search->bestCost = 0x7FFFFFFF;
+    search->found = 0;
+    search->pieceTop = 0;
+    search->nodes = 0;
+    search->stopped = 0;
+    search->deadlineUs = startUs + ((budgetUs > 0) ? budgetUs : GROUP_SEARCH_BUDGET_US);
+    searchPlans(search, 0, 0);
+
+    if (!search->found) { free(search); return 0; }
+
+    // Replay the best plan from the untouched runs, this time writing seats
+    Money price = currentSeatPrice(showtimeIndex, type, CUSTOMER_GUEST);
+    for(i = 0; i < search->runCount; i++) search->left[i] = search->runs[i].length;
+    search->pieceTop = 0;
+    for(i = 0; i < partyCount; i++) {
+        int party = search->order[i];
+        SeatSelection* out = &seats[plan->firstSeat[party]];
+        int run = search->bestChoice[i];
+        if (run == SPLIT_PARTY) {
+            plan->pieces[party] = splitParty(search, search->sizes[i], out, type, price);
+            plan->splits += plan->pieces[party] - 1;
+        } else {
+            takeSeats(search, run, search->sizes[i], out, type, price);
+            plan->pieces[party] = 1;
+        }
+    }
+
+    plan->orphans = countOrphans(search);
+    plan->cost = search->bestCost;
+    plan->nodes = search->nodes;
+    plan->complete = !search->stopped;
+    plan->elapsedUs = getMonotonicMicros() - startUs;
+    free(search);
+    return 1;
+}
@@ -0,0 +1,64 @@
+#ifndef GROUPS_H
+#define GROUPS_H
+
+#include "tickets.h"
+
+// ---------------------------------------------------------
+// GROUP (BLOCK) BOOKINGS
+// ---------------------------------------------------------
+// Schools and companies buy a block of seats for many parties at once,
+// e.g. "12,8,8,5" = four classes that each want to sit together.
+// Placing them one by one with reserveSeats() fills the front rows
+// first-fit and leaves odd gaps that nobody can buy afterwards.
+//
+// planGroupSeating() places every party of the block in one pass:
+//   1. The free runs of the class are collected (adjacent free seats in a
+//      row; aisles and wheelchair bays end a run, as for auto-assign).
+//   2. A depth-first search tries, largest party first, each distinct run
+//      length the party fits in (tightest fit first). A party that fits in
+//      no run is split across the fewest runs possible.
+//   3. Every plan gets a cost and the cheapest one is kept:
+//        GROUP_SPLIT_COST   per extra piece a party is split into
+//        GROUP_ORPHAN_COST  per single seat left alone between parties
+//        GROUP_RUN_COST     per run that was opened (keeps long runs whole
+//                           for the walk-up customers)
+// The first plan found is the classic best-fit-decreasing one, so even a
+// search stopped by its time budget returns a sensible plan.
+#define MAX_GROUP_PARTIES 64
+#define GROUP_SEARCH_BUDGET_US 20000   // Default time budget (20 ms)
+
+#define GROUP_SPLIT_COST  100
+#define GROUP_ORPHAN_COST 10
+#define GROUP_RUN_COST    1
+
+// The plan of one block booking (parties in the order they were given).
+typedef struct {
+    int partyCount;
+    int totalSeats;
+    int sizes[MAX_GROUP_PARTIES];
+    int firstSeat[MAX_GROUP_PARTIES]; // Index in 'seats' of the party's first seat
+    int pieces[MAX_GROUP_PARTIES];    // 1 = the party sits together
+    int splits;                       // Extra pieces over all parties
+    int orphans;                      // Single free seats the plan leaves behind
+    int cost;
+    long long nodes;                  // Search nodes visited
+    int complete;                     // 1 = every plan was considered (not cut by the budget)
+    long long elapsedUs;
+} GroupPlan;
+
+// Reads "12,8,8,5" into 'sizes'.
+// Returns: Number of parties, or -1 if the list is invalid (empty, a size
+// below 1, or more than MAX_GROUP_PARTIES parties).
+int parsePartySizes(const char* text, int* sizes);
+
+// Seats every party of the block in class 'type' (TYPE_VIP / TYPE_REG).
+// 'seats' must have room for the sum of the sizes; each party's seats are
+// written one after the other, in the order of 'partySizes', front seat
+// first, priced for a guest (priceSeats() can re-price them).
+// The seats are only planned: hold them with holdSeats() like any order.
+// 'budgetUs' bounds the search (0 = GROUP_SEARCH_BUDGET_US).
+// Returns: 1 if the block fits, 0 if the class has fewer free seats than the block.
+int planGroupSeating(int showtimeIndex, int type, const int* partySizes, int partyCount,
+                     int budgetUs, SeatSelection* seats, GroupPlan* plan);
+
+#endif
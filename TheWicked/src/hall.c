@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "hall.h"
+#include "tickets.h"
+#include "inventory.h"
+
+// ---------------------------------------------------------
+// DATA STRUCTURE: The Auditoriums
+// ---------------------------------------------------------
+// One compiled layout per screen; every showtime names the screen it
+// plays in, so getHall() is a single array lookup.
+// With a plain hall_layout.txt there is one screen shared by all showtimes.
+static HallLayout screens[MAX_SCREENS];
+static int numScreens = 0;
+static ShowtimeInfo showtimes[MAX_SHOWTIMES];
+static int numShowtimes = 0;
+
+// Function: compareSeatScores
+// Purpose: qsort order for rankSeats(): better score first, then front
+// row first, then left seat first (so equal seats always rank the same way).
+static const HallLayout* rankingHall;
+static int compareSeatScores(const void* a, const void* b) {
+    int seatA = *(const unsigned short*)a, seatB = *(const unsigned short*)b;
+    int scoreA = rankingHall->seatScore[seatA / MAX_COLS][seatA % MAX_COLS];
+    int scoreB = rankingHall->seatScore[seatB / MAX_COLS][seatB % MAX_COLS];
+    if (scoreA != scoreB) return scoreA - scoreB;
+    return seatA - seatB;
+}
+
+// Function: rankSeats
+// Purpose: Scores every seat by how far it is from the sweet spot, then
+// sorts the seats of each class best-first. Done once per layout, so the
+// inventory can keep the free seats in this order (see inventory.h).
+//   row distance: from the row two thirds of the way back, in thirds of a row
+//   column distance: from the screen centerline, in half seats
+// Example (4 x 6 hall): the ideal row is C, the centerline runs between
+// seats 3 and 4, so C3 and C4 score 0 + 3*1 = 3 and A1 scores 4*6 + 3*5 = 39.
+static void rankSeats(HallLayout* hall) {
+    int counts[3] = { 0, 0, 0 };
+    int r, c, type;
+
+    for(r = 0; r < hall->rows; r++) {
+        int rowDistance = abs(3 * r - 2 * (hall->rows - 1));
+        for(c = 0; c < MAX_COLS; c++) {
+            if (!((hall->seatMask[r] >> c) & 1)) { hall->seatScore[r][c] = 0xFFFF; continue; }
+            int score = SCORE_ROW_WEIGHT * rowDistance + SCORE_COL_WEIGHT * abs(2 * c - (hall->cols - 1));
+            if ((hall->wheelMask[r] >> c) & 1) score += SCORE_WHEELCHAIR;
+            hall->seatScore[r][c] = (unsigned short)score;
+            type = hall->rowClass[r];
+            hall->rankedSeats[type][counts[type]++] = (unsigned short)(r * MAX_COLS + c);
+        }
+    }
+
+    rankingHall = hall;
+    for(type = TYPE_VIP; type <= TYPE_REG; type++) {
+        int k;
+        qsort(hall->rankedSeats[type], counts[type], sizeof(unsigned short), compareSeatScores);
+        for(k = 0; k < counts[type]; k++) {
+            int seat = hall->rankedSeats[type][k];
+            hall->seatRank[seat / MAX_COLS][seat % MAX_COLS] = (unsigned short)k;
+        }
+    }
+}
+
+// Function: finishHall
+// Purpose: Derives the totals (capacity), the per-class row lists and the
+// seat ranking once the row masks and class tags are filled.
+static void finishHall(HallLayout* hall) {
+    int r;
+    hall->capacity = 0;
+    memset(hall->classRowCount, 0, sizeof(hall->classRowCount));
+    for(r = 0; r < hall->rows; r++) {
+        int type = hall->rowClass[r];
+        hall->capacity += bitCount(hall->seatMask[r]);
+        hall->classIndex[r] = hall->classRowCount[type];
+        hall->classRows[type][hall->classRowCount[type]++] = r;
+    }
+    rankSeats(hall);
+}
+
+// Function: parseRowMap
+// Purpose: Converts a seat map like "##.##W" into seat / wheelchair masks.
+// Returns: The number of seat positions, or -1 if the map is invalid.
+static int parseRowMap(const char* map, SeatWord* seats, SeatWord* wheels) {
+    int c = 0;
+    *seats = 0;
+    *wheels = 0;
+    while (*map && !isspace((unsigned char)*map)) {
+        if (c >= MAX_COLS) return -1;
+        if (*map == '#') *seats |= (SeatWord)1 << c;
+        else if (*map == 'W' || *map == 'w') { *seats |= (SeatWord)1 << c; *wheels |= (SeatWord)1 << c; }
+        else if (*map != '.') return -1;
+        c++;
+        map++;
+    }
+    return c;
+}
+
+// Function: readHallLayout
+// Purpose: Reads the layout file line by line and compiles it into a HallLayout.
+// Lines: "show <time> | <label>" and "row <VIP|REG> <seat map>". '#' starts a comment.
+int readHallLayout(const char* path, HallLayout* hall, ShowtimeInfo* shows, int maxShows) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return -1;
+
+    ShowtimeInfo ignored;
+    int showCount = 0;
+    int valid = 1;
+    char line[256];
+
+    memset(hall, 0, sizeof(*hall));
+
+    while (valid && fgets(line, sizeof(line), f)) {
+        // Strip the newline (and the '\r' of Windows-edited files)
+        line[strcspn(line, "\r\n")] = '\0';
+
+        char* p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0' || *p == '#') continue;
+
+        if (strncmp(p, "show ", 5) == 0) {
+            if (shows != NULL && showCount >= maxShows) { valid = 0; break; }
+            char* bar = strchr(p + 5, '|');
+            ShowtimeInfo* s = (shows != NULL) ? &shows[showCount] : &ignored;
+            showCount++;
+            memset(s, 0, sizeof(*s));
+            if (bar != NULL) {
+                *bar = '\0';
+                sscanf(bar + 1, " %31[^\n]", s->label);
+            }
+            sscanf(p + 5, " %15[^\n]", s->time);
+            // Trim trailing spaces left before the '|'
+            size_t len = strlen(s->time);
+            while (len > 0 && s->time[len-1] == ' ') s->time[--len] = '\0';
+        }
+        else if (strncmp(p, "row ", 4) == 0) {
+            char cls[8], map[MAX_COLS + 2];
+            if (hall->rows >= MAX_ROWS || sscanf(p + 4, "%7s %65s", cls, map) != 2) { valid = 0; break; }
+
+            int r = hall->rows++;
+            if (strcmp(cls, "VIP") == 0) hall->rowClass[r] = TYPE_VIP;
+            else if (strcmp(cls, "REG") == 0) hall->rowClass[r] = TYPE_REG;
+            else { valid = 0; break; }
+
+            int width = parseRowMap(map, &hall->seatMask[r], &hall->wheelMask[r]);
+            if (width <= 0) { valid = 0; break; }
+            if (width > hall->cols) hall->cols = width;
+        }
+        else {
+            valid = 0; // Unknown directive
+        }
+    }
+    fclose(f);
+
+    if (!valid || hall->rows == 0) return -1;
+    finishHall(hall);
+    return showCount;
+}
+
+// Function: loadHallLayout
+// Purpose: One hall and its own "show" lines become the whole schedule.
+int loadHallLayout(const char* path) {
+    HallLayout hall;
+    ShowtimeInfo shows[MAX_SHOWTIMES];
+    int showCount = readHallLayout(path, &hall, shows, MAX_SHOWTIMES);
+    if (showCount <= 0) return 0;
+
+    installSchedule(&hall, 1, shows, showCount);
+    return 1;
+}
+
+// Function: installSchedule
+void installSchedule(const HallLayout* halls, int hallCount, const ShowtimeInfo* shows, int showCount) {
+    int i;
+    if (hallCount > MAX_SCREENS) hallCount = MAX_SCREENS;
+    if (showCount > MAX_SHOWTIMES) showCount = MAX_SHOWTIMES;
+    memcpy(screens, halls, sizeof(HallLayout) * hallCount);
+    numScreens = hallCount;
+    memcpy(showtimes, shows, sizeof(ShowtimeInfo) * showCount);
+    numShowtimes = showCount;
+    for(i = 0; i < numShowtimes; i++) {
+        // A bad index would make getHall() read past the table
+        if (showtimes[i].screen < 0 || showtimes[i].screen >= numScreens) showtimes[i].screen = 0;
+    }
+}
+
+// Function: useDefaultHallLayout
+// Purpose: The original cinema: 4 rows x 6 seats, Row A is VIP, 4 showtimes.
+void useDefaultHallLayout() {
+    static const char* times[4]  = { "10:30 AM", "01:15 PM", "04:45 PM", "08:00 PM" };
+    static const char* labels[4] = { "Matinee", "Afternoon", "Prime", "Evening" };
+    int i;
+
+    HallLayout* hall = &screens[0];
+    memset(hall, 0, sizeof(*hall));
+    hall->rows = 4;
+    hall->cols = 6;
+    for(i = 0; i < hall->rows; i++) {
+        hall->rowClass[i] = (i == 0) ? TYPE_VIP : TYPE_REG;
+        hall->seatMask[i] = 0x3F; // 6 seats
+    }
+    finishHall(hall);
+    numScreens = 1;
+
+    for(i = 0; i < 4; i++) {
+        strcpy(showtimes[i].time, times[i]);
+        strcpy(showtimes[i].label, labels[i]);
+        showtimes[i].screen = 0;
+    }
+    numShowtimes = 4;
+}
+
+// ---------------------------------------------------------
+// LOOKUPS
+// ---------------------------------------------------------
+
+const HallLayout* getHall(int showtimeIndex) {
+    return &screens[showtimes[showtimeIndex].screen];
+}
+
+int getNumScreens() {
+    return numScreens;
+}
+
+const HallLayout* getScreenHall(int screen) {
+    return &screens[screen];
+}
+
+int getNumShowtimes() {
+    return numShowtimes;
+}
+
+// Function: fnv1a
+// Purpose: 64-bit FNV-1a, continued from 'hash'.
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t length) {
+    const unsigned char* p = data;
+    size_t i;
+    for(i = 0; i < length; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Function: getLayoutFingerprint
+// Purpose: Hashes the shape of every screen and the screen of every
+// showtime. A snapshot or a kiosk with a different fingerprint would put
+// its seat bits on other seats.
+uint64_t getLayoutFingerprint() {
+    uint64_t hash = 14695981039346656037ULL;
+    int i;
+    hash = fnv1a(hash, &numShowtimes, sizeof(numShowtimes));
+    for(i = 0; i < numShowtimes; i++) hash = fnv1a(hash, &showtimes[i].screen, sizeof(int));
+    for(i = 0; i < numScreens; i++) {
+        const HallLayout* hall = &screens[i];
+        hash = fnv1a(hash, &hall->rows, sizeof(hall->rows));
+        hash = fnv1a(hash, hall->seatMask, sizeof(SeatWord) * hall->rows);
+        hash = fnv1a(hash, hall->rowClass, sizeof(int) * hall->rows);
+    }
+    return hash;
+}
+
+const ShowtimeInfo* getShowtimeInfo(int showtimeIndex) {
+    return &showtimes[showtimeIndex];
+}
+
+int getRowClass(int showtimeIndex, int r) {
+    return getHall(showtimeIndex)->rowClass[r];
+}
+
+int seatExists(int showtimeIndex, int r, int c) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    if (r < 0 || r >= hall->rows || c < 0 || c >= hall->cols) return 0;
+    return (int)((hall->seatMask[r] >> c) & 1);
+}
+
+int isWheelchairSeat(int showtimeIndex, int r, int c) {
+    if (!seatExists(showtimeIndex, r, c)) return 0;
+    return (int)((getHall(showtimeIndex)->wheelMask[r] >> c) & 1);
+}
+
+int getClassCapacity(int showtimeIndex, int type) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    int total = 0;
+    int r;
+    for(r = 0; r < hall->rows; r++) {
+        if (hall->rowClass[r] == type) total += bitCount(hall->seatMask[r]);
+    }
+    return total;
+}
+
+// Function: describeClassRows
+// Purpose: Groups consecutive rows of a class into ranges for menu text.
+// Example: VIP rows 0,1 and 5 -> "Rows A-B, F".
+void describeClassRows(int showtimeIndex, int type, char* buffer, int size) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    char ranges[128] = "";
+    int rowCount = 0;
+    int r = 0;
+
+    while (r < hall->rows) {
+        if (hall->rowClass[r] != type) { r++; continue; }
+        int start = r;
+        while (r + 1 < hall->rows && hall->rowClass[r + 1] == type) r++;
+
+        char part[8];
+        if (start == r) sprintf(part, "%c", 'A' + start);
+        else            sprintf(part, "%c-%c", 'A' + start, 'A' + r);
+        if (ranges[0] != '\0') strcat(ranges, ", ");
+        strcat(ranges, part);
+        rowCount += r - start + 1;
+        r++;
+    }
+    snprintf(buffer, size, "%s %s", (rowCount == 1) ? "Row" : "Rows", ranges);
+}
@@ -0,0 +1,120 @@
+#ifndef HALL_H
+#define HALL_H
+
+#include <stdint.h>
+
+// ---------------------------------------------------------
+// HALL LAYOUT CONFIGURATION
+// ---------------------------------------------------------
+// The auditorium is no longer hard-coded. It is described in a text
+// file that is read once at startup (see hall_layout.txt).
+#define HALL_LAYOUT_FILE "hall_layout.txt"
+
+// One 64-bit word holds one row of seats (bit 'c' = seat 'c').
+typedef uint64_t SeatWord;
+#define SEATS_PER_WORD 64
+
+// Seat quality weights (see rankSeats() in hall.c). One row away from the
+// ideal row costs as much as two seats away from the centerline.
+#define SCORE_ROW_WEIGHT 4        // Per third of a row from the ideal row
+#define SCORE_COL_WEIGHT 3        // Per half seat from the screen centerline
+#define SCORE_WHEELCHAIR 10000    // Bays are only auto-assigned once every other seat is gone
+
+// Limits of the layout format.
+#define MAX_ROWS 26        // Rows are labelled with a single letter (A-Z)
+#define MAX_COLS 64        // One SeatWord per row
+#define MAX_SHOWTIMES 250  // Screenings per day (sales records keep the index in one byte)
+#define MAX_SCREENS 24     // Auditoriums (see catalog.h)
+
+// ---------------------------------------------------------
+// DATA STRUCTURES
+// ---------------------------------------------------------
+// The compiled hall. Everything is a fixed-size array indexed by row,
+// so a seat lookup is plain offset arithmetic (no pointer chasing).
+typedef struct {
+    int rows;                       // Number of rows (front row = 0)
+    int cols;                       // Width of the widest row, in seat positions
+    int capacity;                   // Number of real seats in the hall
+    int rowClass[MAX_ROWS];         // Class tag per row (TYPE_VIP / TYPE_REG)
+    SeatWord seatMask[MAX_ROWS];    // 1 = a seat exists at this position (0 = aisle)
+    SeatWord wheelMask[MAX_ROWS];   // 1 = wheelchair bay (subset of seatMask)
+
+    // Rows grouped by class, front to back (filled when the layout is compiled).
+    // Example: classRows[TYPE_VIP] = {0}, classRows[TYPE_REG] = {1, 2, 3}.
+    int classRows[3][MAX_ROWS];     // Indexed by TYPE_VIP / TYPE_REG
+    int classRowCount[3];
+    int classIndex[MAX_ROWS];       // Position of each row inside its class list
+
+    // Seat quality (also filled when the layout is compiled, see rankSeats()).
+    // seatScore: 0 = the sweet spot (on the screen centerline, about two
+    // thirds of the way back); the larger, the worse the view.
+    // The seats of each class are numbered best-first: seatRank[r][c] is
+    // the place of a seat inside its class, rankedSeats[type][k] the seat
+    // at place k (row * MAX_COLS + col).
+    unsigned short seatScore[MAX_ROWS][MAX_COLS];
+    unsigned short seatRank[MAX_ROWS][MAX_COLS];
+    unsigned short rankedSeats[3][MAX_ROWS * MAX_COLS];
+} HallLayout;
+
+// A screening slot shown in the "Select Showtime" menu.
+typedef struct {
+    char time[16];   // Printed on the ticket, e.g. "10:30 AM"
+    char label[32];  // Menu description, e.g. "Matinee"
+    int screen;      // Auditorium it plays in (index of its HallLayout)
+} ShowtimeInfo;
+
+// ---------------------------------------------------------
+// FUNCTION PROTOTYPES
+// ---------------------------------------------------------
+
+// Reads and compiles a layout file.
+// Returns: 1 on success, 0 if the file is missing or invalid (the
+// previous layout is kept in that case).
+int loadHallLayout(const char* path);
+
+// Installs the classic 4 x 6 hall (Row A VIP) with the 4 daily showtimes.
+void useDefaultHallLayout();
+
+// Compiles a layout file without installing it (the catalog uses this for
+// each of its screens). The "show" lines are copied into 'shows' (up to
+// 'maxShows'; pass NULL / 0 to ignore them).
+// Returns: Number of "show" lines, or -1 if the file is missing or invalid.
+int readHallLayout(const char* path, HallLayout* hall, ShowtimeInfo* shows, int maxShows);
+
+// Installs several auditoriums and the screenings that play in them
+// (ShowtimeInfo.screen indexes 'halls'). Replaces the current schedule.
+void installSchedule(const HallLayout* halls, int hallCount, const ShowtimeInfo* shows, int showCount);
+
+// Returns the compiled hall used by a showtime.
+const HallLayout* getHall(int showtimeIndex);
+
+// Number of auditoriums, and the compiled hall of one of them.
+int getNumScreens();
+const HallLayout* getScreenHall(int screen);
+
+// Fingerprint of every hall shape and of which hall each showtime uses.
+// Seat words saved under one fingerprint only fit a schedule with the same one.
+uint64_t getLayoutFingerprint();
+
+// Number of screenings defined by the layout.
+int getNumShowtimes();
+
+// Returns the time / menu label for a screening.
+const ShowtimeInfo* getShowtimeInfo(int showtimeIndex);
+
+// Returns the class tag (TYPE_VIP / TYPE_REG) of a row.
+int getRowClass(int showtimeIndex, int r);
+
+// Returns 1 if a real seat exists at (r, c), 0 for aisles and out-of-range.
+int seatExists(int showtimeIndex, int r, int c);
+
+// Returns 1 if (r, c) is a wheelchair bay.
+int isWheelchairSeat(int showtimeIndex, int r, int c);
+
+// Number of real seats of one class in the hall of a showtime.
+int getClassCapacity(int showtimeIndex, int type);
+
+// Builds a short description of the rows of a class, e.g. "Row A" or "Rows B-D".
+void describeClassRows(int showtimeIndex, int type, char* buffer, int size);
+
+#endif
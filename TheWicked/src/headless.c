@@ -0,0 +1,271 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "headless.h"
+#include "tickets.h"
+#include "hall.h"
+#include "catalog.h"
+#include "pricing.h"
+#include "groups.h"
+#include "ui.h"
+#include "utilities.h"
+#include "salesrec.h"
+#include "wal.h"
+
+// ---------------------------------------------------------
+// PARSING HELPERS
+// ---------------------------------------------------------
+
+// Function: nextField
+// Purpose: Cuts the next space-separated field out of the line.
+// Returns: The field, or NULL at the end of the line.
+static char* nextField(char** cursor) {
+    char* p = *cursor;
+    while (*p != '\0' && isspace((unsigned char)*p)) p++;
+    if (*p == '\0') { *cursor = p; return NULL; }
+
+    char* start = p;
+    while (*p != '\0' && !isspace((unsigned char)*p)) p++;
+    if (*p != '\0') *p++ = '\0';
+    *cursor = p;
+    return start;
+}
+
+// Function: parseClass
+// Purpose: "VIP" / "REG" (any case, "V" / "R" also accepted) to a ticket type.
+static int parseClass(const char* text) {
+    if (toupper((unsigned char)text[0]) == 'V') return TYPE_VIP;
+    if (toupper((unsigned char)text[0]) == 'R') return TYPE_REG;
+    return 0;
+}
+
+// Function: parseSeatList
+// Purpose: Reads "A1,A2,B7" into 'outputSeats' with the same checks as
+// manualSeatSelect(): the seat exists, is in the right class and is not
+// listed twice. Whether it is still free is left to holdSeats().
+// Returns: NULL on success, otherwise the reason the list was refused.
+static const char* parseSeatList(char* list, int qty, int type, int showtimeIndex, SeatSelection* outputSeats) {
+    Money price = currentSeatPrice(showtimeIndex, type, CUSTOMER_GUEST);
+    SeatWord picked[MAX_ROWS];
+    memset(picked, 0, sizeof(picked));
+
+    int count = 0;
+    char* code = list;
+    while (*code != '\0') {
+        char* comma = strchr(code, ',');
+        if (comma != NULL) *comma = '\0';
+
+        if (count == qty) return "more seats listed than tickets";
+        char rowChar = (char)toupper((unsigned char)code[0]);
+        int rowIdx = rowChar - 'A';
+        int colIdx = atoi(&code[1]) - 1;
+
+        if (!seatExists(showtimeIndex, rowIdx, colIdx)) return "no such seat";
+        int rowClass = getRowClass(showtimeIndex, rowIdx);
+        if (type == TYPE_VIP && rowClass != TYPE_VIP) return "seat is not VIP";
+        if (type == TYPE_REG && rowClass == TYPE_VIP) return "seat is VIP";
+
+        SeatWord bit = (SeatWord)1 << colIdx;
+        if (picked[rowIdx] & bit) return "seat listed twice";
+        picked[rowIdx] |= bit;
+
+        outputSeats[count].r = rowIdx;
+        outputSeats[count].c = colIdx;
+        outputSeats[count].rowChar = rowChar;
+        outputSeats[count].type = type;
+        outputSeats[count].price = price;
+        count++;
+
+        if (comma == NULL) break;
+        code = comma + 1;
+    }
+    if (count != qty) return "fewer seats listed than tickets";
+    return NULL;
+}
+
+// Function: parseSnacks
+// Purpose: Takes "1,2,2" (SKU numbers, "-" = none) off the shelf into the
+// order, like picking them one by one at the concession stand.
+// Returns: NULL on success, otherwise the reason (the order is emptied again).
+static const char* parseSnacks(char* list, ConcessionOrder* order) {
+    if (strcmp(list, "-") == 0) return NULL;
+
+    char* item = list;
+    while (*item != '\0') {
+        int index = findConcession(atoi(item));
+        int added = (index < 0) ? -2 : addToOrder(order, index, 1);
+        if (added != 1) {
+            cancelOrder(order);
+            if (added == -2) return "unknown concession item";
+            return (added == 0) ? "concession item sold out" : "too many different concession items";
+        }
+
+        char* comma = strchr(item, ',');
+        if (comma == NULL) break;
+        item = comma + 1;
+    }
+    return NULL;
+}
+
+// ---------------------------------------------------------
+// ONE BOOKING
+// ---------------------------------------------------------
+
+// Function: runHeadlessBooking
+// Purpose: The kiosk purchase flow for one script line:
+// availability -> seats -> hold -> payment -> commit -> sales log.
+const char* runHeadlessBooking(char* line, int session, HeadlessStats* stats) {
+    char* cursor = line;
+    char* fields[6];
+    int i;
+    for(i = 0; i < 6; i++) {
+        fields[i] = nextField(&cursor);
+        if (fields[i] == NULL) return "expected: showtime class qty seats snacks cash [promo]";
+    }
+    char* promo = nextField(&cursor); // Optional 7th field
+    if (nextField(&cursor) != NULL) return "too many fields";
+
+    // STEP 1: SHOWTIME, CLASS AND QUANTITY
+    int showtimeIdx = isdigit((unsigned char)fields[0][0]) ? atoi(fields[0]) : findShowing(fields[0]);
+    if (showtimeIdx < 0 || showtimeIdx >= getNumShowtimes()) return "no such showtime";
+    int ticketType = parseClass(fields[1]);
+    if (ticketType == 0) return "class must be VIP or REG";
+    int qty = atoi(fields[2]);
+    if (qty < 1) return "quantity must be at least 1";
+    Money cash;
+    if (parseMoney(fields[5], &cash) == 0) return "cash must be an amount";
+    int customer = CUSTOMER_GUEST;
+    if (promo != NULL && (customer = findPromoCode(promo)) < 0) return "unknown promo code";
+
+    if (!checkAvailability(qty, ticketType, showtimeIdx)) return "not enough seats in this class";
+
+    // STEP 2: SEATS (auto-assign or the listed codes)
+    SeatSelection* selectedSeats = malloc(sizeof(SeatSelection) * qty);
+    if (selectedSeats == NULL) return "out of memory";
+
+    if (strcmp(fields[3], "auto") == 0) {
+        reserveSeats(qty, ticketType, showtimeIdx, selectedSeats);
+    } else if (strncmp(fields[3], "block:", 6) == 0) {
+        // Block booking: every party seated by one search (groups.h)
+        int sizes[MAX_GROUP_PARTIES], blockSeats = 0;
+        int parties = parsePartySizes(fields[3] + 6, sizes);
+        for(i = 0; i < parties; i++) blockSeats += sizes[i];
+        GroupPlan plan;
+        const char* problem = NULL;
+        if (parties < 0) problem = "invalid party sizes";
+        else if (blockSeats != qty) problem = "party sizes do not add up to the quantity";
+        else if (!planGroupSeating(showtimeIdx, ticketType, sizes, parties, 0, selectedSeats, &plan)) {
+            problem = "block does not fit in this class";
+        }
+        if (problem != NULL) { free(selectedSeats); return problem; }
+    } else {
+        const char* problem = parseSeatList(fields[3], qty, ticketType, showtimeIdx, selectedSeats);
+        if (problem != NULL) { free(selectedSeats); return problem; }
+    }
+
+    // STEP 3: HOLD, exactly like a kiosk waiting for payment
+    int holdId = holdSeats(qty, selectedSeats, showtimeIdx, session);
+    if (holdId < 0) { free(selectedSeats); return "seat already taken"; }
+
+    // STEP 3b: CONCESSIONS (taken from stock while the seats are held)
+    ConcessionOrder extras;
+    startOrder(&extras);
+    const char* problem = parseSnacks(fields[4], &extras);
+    if (problem != NULL) {
+        releaseHeldSeats(holdId, session);
+        free(selectedSeats);
+        return problem;
+    }
+
+    // STEP 4: PAYMENT (the cash is handed over in one go)
+    priceSeats(qty, selectedSeats, showtimeIdx, customer);
+    Money ticketTotal = 0;
+    for(i = 0; i < qty; i++) ticketTotal += selectedSeats[i].price;
+    Money dueCentavos = ticketTotal + extras.total;
+    if (cash < dueCentavos) {
+        releaseHeldSeats(holdId, session);
+        cancelOrder(&extras);
+        free(selectedSeats);
+        return "not enough cash";
+    }
+
+    // STEP 5: COMMIT AND LOG
+    if (!commitHeldSeats(holdId, session, qty, selectedSeats, showtimeIdx)) {
+        cancelOrder(&extras);
+        free(selectedSeats);
+        return "seat hold was lost";
+    }
+    int saved = saveTransaction(showtimeIdx, qty, selectedSeats, ticketTotal, &extras);
+    free(selectedSeats);
+    if (!saved) return "sales log write failed";
+
+    stats->sold++;
+    stats->tickets += qty;
+    stats->revenueCentavos += dueCentavos;
+    return NULL;
+}
+
+// ---------------------------------------------------------
+// PUBLIC API
+// ---------------------------------------------------------
+
+// Function: runHeadlessScript
+// Purpose: Feeds every line of the script to runHeadlessBooking() and times the run.
+int runHeadlessScript(const char* path) {
+    FILE* script = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    if (script == NULL) {
+        fprintf(stderr, "Cannot open script '%s'\n", path);
+        return 1;
+    }
+
+    static char line[HEADLESS_LINE_MAX];
+    HeadlessStats stats;
+    memset(&stats, 0, sizeof(stats));
+    long long lineNo = 0;
+    int session = 0;
+
+    // One thread: no other booking can join a batch, so the WAL need not wait
+    setGroupCommitWindow(0);
+
+    long long startUs = getMonotonicMicros();
+    while (fgets(line, sizeof(line), script) != NULL) {
+        lineNo++;
+
+        size_t len = strlen(line);
+        if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+            // Over-long line: report it once and skip the rest of it
+            int ch;
+            while ((ch = fgetc(script)) != EOF && ch != '\n') { }
+            fprintf(stderr, "line %lld: line too long\n", lineNo);
+            stats.lines++;
+            stats.rejected++;
+            continue;
+        }
+
+        char* start = line;
+        while (isspace((unsigned char)*start)) start++;
+        if (*start == '\0' || *start == '#') continue;
+
+        stats.lines++;
+        const char* problem = runHeadlessBooking(start, ++session, &stats);
+        if (problem != NULL) {
+            stats.rejected++;
+            fprintf(stderr, "line %lld: %s\n", lineNo, problem);
+        }
+    }
+    long long elapsedUs = getMonotonicMicros() - startUs;
+    if (script != stdin) fclose(script);
+
+    // Summary
+    char revenue[32];
+    formatMoney(stats.revenueCentavos, revenue, sizeof(revenue));
+    double seconds = elapsedUs / 1000000.0;
+
+    printf("Bookings:     %lld\n", stats.lines);
+    printf("Sold:         %lld (%lld tickets, PHP %s)\n", stats.sold, stats.tickets, revenue);
+    printf("Rejected:     %lld\n", stats.rejected);
+    printf("Elapsed:      %.3f ms\n", elapsedUs / 1000.0);
+    if (elapsedUs > 0) printf("Throughput:   %.1f transactions/s\n", stats.sold / seconds);
+    return 0;
+}
@@ -0,0 +1,48 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// ---------------------------------------------------------
+// HEADLESS SCRIPT MODE
+// ---------------------------------------------------------
+// "TheWicked --script bookings.txt" (or "--script -" for stdin) runs a
+// list of bookings through the same seat, hold and sales-log code as the
+// kiosk, without drawing a screen, asking for input or pausing.
+// One booking per line, fields separated by spaces:
+//
+//   <showtime> <VIP|REG> <qty> <auto|block:12,8,...|A1,A2,...> <snacks> <cash> [promo]
+//
+//   showtime  Showtime index as stored in the sales log (0 = first screening),
+//             or a showing id from the catalog, e.g. "S3" (see catalog.h)
+//   seats     "auto" = best seats (reserveSeats), "block:" + party sizes adding
+//             up to 'qty' = a block booking seated by planGroupSeating()
+//             (groups.h), or exactly 'qty' seat codes
+//   snacks    Concession SKU numbers, e.g. "1,2,2" (see concessions.txt), or "-"
+//   cash      Pesos handed over; a booking that is short is cancelled
+//   promo     Optional promo code from pricing.txt (see pricing.h)
+//
+// Blank lines and lines starting with '#' are skipped. Rejected lines are
+// reported on stderr with their line number; a summary with the number of
+// transactions per second is printed at the end.
+#define HEADLESS_LINE_MAX 8192   // Longest script line (a whole hall listed by hand)
+
+// Running totals for the summary at the end of a script.
+typedef struct {
+    long long lines;           // Bookings read (comments and blank lines excluded)
+    long long sold;            // Transactions completed and logged
+    long long rejected;        // Bookings that were refused or cancelled
+    long long tickets;         // Seats sold
+    long long revenueCentavos; // Tickets + concessions of the completed sales
+} HeadlessStats;
+
+// Runs one booking line (no comment, no newline needed). The line is cut
+// up in place. 'session' is the hold owner and must differ per booking.
+// Completed sales are added to 'stats' (lines / rejected are left to the caller).
+// Returns: NULL if the sale went through, otherwise the reason it did not.
+const char* runHeadlessBooking(char* line, int session, HeadlessStats* stats);
+
+// Runs every booking in the script ("-" = standard input).
+// Call after the inventory is restored and the sales log is open.
+// Returns: 0 if the script was read to the end, 1 if it could not be opened.
+int runHeadlessScript(const char* path);
+
+#endif
@@ -0,0 +1,276 @@
+#include <stdlib.h>
+#include <string.h>
+#include "holds.h"
+#include "inventory.h"
+#include "utilities.h"
+
+// ---------------------------------------------------------
+// TIMING WHEEL CONFIGURATION
+// ---------------------------------------------------------
+// Level 0: 64 slots x 1 tick    =  6.4 seconds
+// Level 1: 64 slots x 64 ticks  =  6.8 minutes
+// Level 2: 64 slots x 4096 ticks = 7.3 hours (longer holds wait in the last slot)
+// When level 0 wraps around, the matching level 1 slot is "cascaded":
+// its holds are re-inserted closer to the present, and so on upward.
+#define WHEEL_BITS   6
+#define WHEEL_SLOTS  (1 << WHEEL_BITS)
+#define WHEEL_MASK   (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS 3
+
+// Hold IDs pack a pool index (low bits) with a generation counter, so a
+// stale ID from an old, reused slot is never mistaken for the new hold.
+#define HOLD_INDEX_BITS 20
+#define HOLD_INDEX_MASK ((1 << HOLD_INDEX_BITS) - 1)
+
+// ---------------------------------------------------------
+// DATA STRUCTURES
+// ---------------------------------------------------------
+typedef struct {
+    int inUse;
+    int generation;
+    int showtime;
+    int owner;
+    long long deadlineTick;
+    int prev, next;                 // Links inside a wheel slot (or the free list)
+    int level, slot;                // Where the hold currently sits in the wheel
+    SeatWord rowMasks[MAX_ROWS];    // The seats being held
+} Hold;
+
+static Hold* pool = NULL;
+static int poolSize = 0;
+static int freeHead = -1;
+static int activeHolds = 0;
+
+static int wheel[WHEEL_LEVELS][WHEEL_SLOTS];   // Head of each slot list (-1 = empty)
+static long long currentTick = 0;
+static int wheelStarted = 0;
+
+// Hold bookkeeping is touched by every kiosk thread, so it sits behind a
+// tiny spinlock. Seat claims themselves stay lock-free (see claimRowMasks).
+static volatile char holdLock = 0;
+
+static void lockHolds()   { while (__atomic_test_and_set(&holdLock, __ATOMIC_ACQUIRE)) { } }
+static void unlockHolds() { __atomic_clear(&holdLock, __ATOMIC_RELEASE); }
+
+// ---------------------------------------------------------
+// WHEEL HELPERS (call with the lock held)
+// ---------------------------------------------------------
+
+// Function: startWheel
+// Purpose: Empties every slot and syncs the wheel with the monotonic clock.
+static void startWheel() {
+    int level, slot;
+    for(level = 0; level < WHEEL_LEVELS; level++) {
+        for(slot = 0; slot < WHEEL_SLOTS; slot++) wheel[level][slot] = -1;
+    }
+    currentTick = getMonotonicMs() / WHEEL_TICK_MS;
+    wheelStarted = 1;
+}
+
+// Function: wheelInsert
+// Purpose: Files a hold in the slot matching how far away its deadline is.
+static void wheelInsert(int index) {
+    Hold* h = &pool[index];
+    long long delta = h->deadlineTick - currentTick;
+    int level;
+
+    if (delta < ((long long)1 << WHEEL_BITS)) level = 0;
+    else if (delta < ((long long)1 << (2 * WHEEL_BITS))) level = 1;
+    else level = 2;
+
+    long long when = h->deadlineTick;
+    if (delta >= ((long long)1 << (3 * WHEEL_BITS))) {
+        // Beyond the wheel: park in the furthest level 2 slot and re-file later
+        when = currentTick + ((long long)WHEEL_MASK << (2 * WHEEL_BITS));
+    }
+
+    h->level = level;
+    h->slot = (int)((when >> (level * WHEEL_BITS)) & WHEEL_MASK);
+    h->prev = -1;
+    h->next = wheel[level][h->slot];
+    if (h->next >= 0) pool[h->next].prev = index;
+    wheel[level][h->slot] = index;
+}
+
+// Function: wheelRemove
+// Purpose: Unlinks a hold from its slot (doubly linked list = O(1)).
+static void wheelRemove(int index) {
+    Hold* h = &pool[index];
+    if (h->prev >= 0) pool[h->prev].next = h->next;
+    else wheel[h->level][h->slot] = h->next;
+    if (h->next >= 0) pool[h->next].prev = h->prev;
+}
+
+// Function: freeHold
+// Purpose: Returns a pool entry to the free list and invalidates its old ID.
+static void freeHold(int index) {
+    pool[index].inUse = 0;
+    pool[index].generation++;
+    pool[index].next = freeHead;
+    freeHead = index;
+    activeHolds--;
+}
+
+// Function: allocHold
+// Purpose: Takes an entry from the free list, growing the pool when empty.
+// Returns: The pool index, or -1 if out of memory.
+static int allocHold() {
+    if (freeHead < 0) {
+        int newSize = (poolSize == 0) ? 64 : poolSize * 2;
+        if (newSize > HOLD_INDEX_MASK + 1) return -1;
+        Hold* grown = realloc(pool, sizeof(Hold) * newSize);
+        if (grown == NULL) return -1;
+        pool = grown;
+
+        int i;
+        for(i = newSize - 1; i >= poolSize; i--) {
+            pool[i].inUse = 0;
+            pool[i].generation = 0;
+            pool[i].next = freeHead;
+            freeHead = i;
+        }
+        poolSize = newSize;
+    }
+    int index = freeHead;
+    freeHead = pool[index].next;
+    activeHolds++;
+    return index;
+}
+
+// Function: findHold
+// Purpose: Decodes a hold ID and checks it still refers to a live hold.
+static int findHold(int holdId, int owner) {
+    if (holdId < 0) return -1;
+    int index = holdId & HOLD_INDEX_MASK;
+    int generation = holdId >> HOLD_INDEX_BITS;
+    if (index >= poolSize) return -1;
+
+    Hold* h = &pool[index];
+    if (!h->inUse || (h->generation & 0x7FF) != generation || h->owner != owner) return -1;
+    return index;
+}
+
+// Function: cascade
+// Purpose: Re-files every hold of one higher-level slot (they are now closer).
+static void cascade(int level, int slot) {
+    int index = wheel[level][slot];
+    wheel[level][slot] = -1;
+    while (index >= 0) {
+        int next = pool[index].next;
+        wheelInsert(index);
+        index = next;
+    }
+}
+
+// Function: tickOnce
+// Purpose: Advances the wheel by one tick and expires the level 0 slot.
+static void tickOnce() {
+    currentTick++;
+    int slot0 = (int)(currentTick & WHEEL_MASK);
+    if (slot0 == 0) {
+        int slot1 = (int)((currentTick >> WHEEL_BITS) & WHEEL_MASK);
+        if (slot1 == 0) cascade(2, (int)((currentTick >> (2 * WHEEL_BITS)) & WHEEL_MASK));
+        cascade(1, slot1);
+    }
+
+    int index = wheel[0][slot0];
+    wheel[0][slot0] = -1;
+    while (index >= 0) {
+        Hold* h = &pool[index];
+        int next = h->next;
+        // Give the seats back to the free pool
+        releaseRowMasks(h->showtime, h->rowMasks);
+        freeHold(index);
+        index = next;
+    }
+}
+
+// ---------------------------------------------------------
+// PUBLIC API
+// ---------------------------------------------------------
+
+// Function: createHold
+// Purpose: Claims the seats lock-free, then records the hold and its deadline.
+int createHold(int showtimeIndex, const SeatWord* rowMasks, int owner, int ttlMs) {
+    if (!claimRowMasks(showtimeIndex, rowMasks)) return HOLD_NONE;
+
+    lockHolds();
+    if (!wheelStarted) startWheel();
+
+    int index = allocHold();
+    if (index < 0) {
+        unlockHolds();
+        releaseRowMasks(showtimeIndex, rowMasks);
+        return HOLD_NONE;
+    }
+
+    Hold* h = &pool[index];
+    h->inUse = 1;
+    h->showtime = showtimeIndex;
+    h->owner = owner;
+    memcpy(h->rowMasks, rowMasks, sizeof(h->rowMasks));
+
+    long long ticks = ttlMs / WHEEL_TICK_MS;
+    if (ticks < 1) ticks = 1;
+    h->deadlineTick = currentTick + ticks;
+    wheelInsert(index);
+
+    int holdId = ((h->generation & 0x7FF) << HOLD_INDEX_BITS) | index;
+    unlockHolds();
+    return holdId;
+}
+
+// Function: commitHold
+// Purpose: Payment done: the held seats become Sold and the hold disappears.
+int commitHold(int holdId, int owner) {
+    advanceHolds(); // An overdue hold must not be committed
+
+    lockHolds();
+    int index = findHold(holdId, owner);
+    if (index < 0) { unlockHolds(); return 0; }
+
+    Hold* h = &pool[index];
+    wheelRemove(index);
+    sellRowMasks(h->showtime, h->rowMasks);
+    freeHold(index);
+    unlockHolds();
+    return 1;
+}
+
+// Function: cancelHold
+// Purpose: Customer walked away: release the seats right now.
+void cancelHold(int holdId, int owner) {
+    lockHolds();
+    int index = findHold(holdId, owner);
+    if (index >= 0) {
+        Hold* h = &pool[index];
+        wheelRemove(index);
+        releaseRowMasks(h->showtime, h->rowMasks);
+        freeHold(index);
+    }
+    unlockHolds();
+}
+
+// Function: advanceHolds
+// Purpose: Catches the wheel up with the clock, one tick at a time.
+// With no outstanding holds we simply jump straight to the present.
+void advanceHolds() {
+    lockHolds();
+    if (!wheelStarted) startWheel();
+
+    long long nowTick = getMonotonicMs() / WHEEL_TICK_MS;
+    while (currentTick < nowTick) {
+        if (activeHolds == 0) { currentTick = nowTick; break; }
+        tickOnce();
+    }
+    unlockHolds();
+}
+
+// Function: countActiveHolds
+// Purpose: How many customers are currently mid-payment.
+int countActiveHolds() {
+    lockHolds();
+    int count = activeHolds;
+    unlockHolds();
+    return count;
+}
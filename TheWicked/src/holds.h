@@ -0,0 +1,40 @@
+#ifndef HOLDS_H
+#define HOLDS_H
+
+#include "hall.h"
+
+// ---------------------------------------------------------
+// TIMED SEAT HOLDS
+// ---------------------------------------------------------
+// A hold is a set of claimed seats that belongs to one kiosk session
+// (the "owner") until a deadline. If the customer pays in time the hold
+// is committed (seats become Sold). If not, the hold expires and the
+// seats go back to the free pool automatically.
+//
+// Deadlines are kept in a hierarchical timing wheel (3 levels x 64 slots,
+// 100 ms per tick), so adding, cancelling or expiring a hold is O(1)
+// no matter how many holds are outstanding.
+
+#define HOLD_NONE -1          // Returned when a hold could not be created
+#define WHEEL_TICK_MS 100     // Resolution of hold deadlines
+
+// Claims the seats (all-or-nothing) and starts a hold that expires after 'ttlMs'.
+// 'rowMasks' has one seat mask per hall row.
+// Returns: The hold ID, or HOLD_NONE if a seat was already taken.
+int createHold(int showtimeIndex, const SeatWord* rowMasks, int owner, int ttlMs);
+
+// Turns a hold into sold seats.
+// Returns: 1 on success, 0 if the hold expired, was cancelled, or belongs to another owner.
+int commitHold(int holdId, int owner);
+
+// Releases a hold early (customer cancelled). Unknown/expired holds are ignored.
+void cancelHold(int holdId, int owner);
+
+// Moves the wheel up to "now" and frees every hold whose deadline has passed.
+// Cheap to call often: does nothing if no tick has elapsed.
+void advanceHolds();
+
+// Number of holds still waiting for payment.
+int countActiveHolds();
+
+#endif
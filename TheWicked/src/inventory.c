@@ -0,0 +1,650 @@
+#include <stdlib.h>
+#include <string.h>
+#include "inventory.h"
+#include "tickets.h"
+#include "feed.h"
+
+// ---------------------------------------------------------
+// DATA STRUCTURE: The Bit-Packed Seating Chart
+// ---------------------------------------------------------
+// A single contiguous block of rows: [TimeSlot][Row] flattened. Showtimes
+// in different screens have different row counts, so each one records
+// where its rows start (see ShowtimeBlock below).
+// Each row has two words:
+//   taken - seat is claimed by a kiosk OR sold (not available to anyone else)
+//   sold  - seat is paid for (subset of 'taken')
+// Example: seatArena[0].sold bit 0 is Row A, Seat 1 for the first show.
+typedef struct {
+    SeatWord taken;
+    SeatWord sold;
+} SeatRow;
+
+static SeatRow* seatArena = NULL;
+static int arenaWords = 0; // Rows of all showtimes together
+static unsigned long long soldVersion = 0; // Bumped whenever a seat becomes sold
+
+// ---------------------------------------------------------
+// DATA STRUCTURE: The Free-Run Index
+// ---------------------------------------------------------
+// One segment tree per [TimeSlot][Class], stored back to back in a single
+// block. Node 1 is the root, node i has children 2i and 2i+1, and the
+// leaves start at 'treeLeaves[type]' (a power of two >= rows in the class).
+// Example: 3 Regular rows -> 4 leaves -> 8 nodes (node 0 unused).
+//
+// Several kiosks may update the same tree at once, so a "yes" from the
+// index is only a hint: it is re-checked against the row words, and the
+// compare-and-swap in claimRowMasks() is what really decides who gets a seat.
+// A "no" is trusted, so no node may stay below its children: each writer
+// looks at the children again after its store and writes again until what
+// it stored is still their max (a stale store by a slower kiosk is repaired
+// by that kiosk itself).
+static unsigned char* runTree = NULL;
+
+// ---------------------------------------------------------
+// DATA STRUCTURE: The Best-Seat Index
+// ---------------------------------------------------------
+// One bitmap per [TimeSlot][Class] with the seats in QUALITY order instead
+// of row order: bit k is set while the k-th best seat of the class (see
+// seatRank in hall.h) is free. A summary word in front of it has bit w set
+// while bitmap word w has any free seat, so the best free seat is two
+// count-trailing-zeros away and the best N cost N more, however big the
+// hall (a class has at most 26 x 64 = 1664 seats = 26 words).
+// Example: summary 0x5 -> words 0 and 2 have free seats; the best free
+// seat is the lowest bit of word 0.
+// It is updated seat by seat as seats are claimed, released and sold,
+// with the same atomic operations as the row words (no lock).
+static SeatWord* rankIndexArena = NULL;
+
+// Where one showtime lives inside the arena and the tree block.
+// Filled once by buildInventory(), read-only afterwards.
+typedef struct {
+    int firstRow;        // Arena index of its row 0
+    int firstNode;       // Start of its trees inside runTree
+    int treeLeaves[3];   // Leaf count per class (TYPE_VIP / TYPE_REG)
+    int treeBase[3];     // Offset of the class tree from firstNode
+    int rankBase[3];     // Start of the class best-seat index (summary word first)
+} ShowtimeBlock;
+
+static ShowtimeBlock* blocks = NULL;
+
+// ---------------------------------------------------------
+// ATOMIC ACCESS
+// ---------------------------------------------------------
+// Row words are shared by every kiosk thread. We use the GCC/Clang
+// __atomic builtins (also in MinGW) because the project builds as C99,
+// which has no <stdatomic.h>.
+#define LOAD_WORD(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define OR_WORD(p, bits)    __atomic_fetch_or((p), (bits), __ATOMIC_ACQ_REL)
+#define CLEAR_WORD(p, bits) __atomic_fetch_and((p), ~(bits), __ATOMIC_ACQ_REL)
+#define LOAD_NODE(p)        __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define STORE_NODE(p, v)    __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+
+// Function: rowAt
+// Purpose: The one place that knows the arena layout.
+static SeatRow* rowAt(int showtimeIndex, int r) {
+    return &seatArena[blocks[showtimeIndex].firstRow + r];
+}
+
+// ---------------------------------------------------------
+// BIT HELPERS
+// ---------------------------------------------------------
+
+// Function: bitCount
+// Purpose: Population count. Uses the compiler builtin on GCC/Clang,
+// and the classic SWAR (SIMD-within-a-register) fallback elsewhere.
+int bitCount(SeatWord word) {
+    #if defined(__GNUC__)
+        return __builtin_popcountll(word);
+    #else
+        word = word - ((word >> 1) & 0x5555555555555555ULL);
+        word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (int)((word * 0x0101010101010101ULL) >> 56);
+    #endif
+}
+
+// Function: lowestBitIndex
+// Purpose: Count-trailing-zeros. Caller guarantees 'word' is not zero.
+int lowestBitIndex(SeatWord word) {
+    #if defined(__GNUC__)
+        return __builtin_ctzll(word);
+    #else
+        // Isolate the lowest bit, then count the ones below it.
+        return bitCount((word & (~word + 1)) - 1);
+    #endif
+}
+
+// Function: longestRun
+// Purpose: Length of the longest block of consecutive set bits.
+// Each "x &= x >> 1" shortens every run by one, so we count the steps
+// until the word is empty (at most 64 iterations).
+static int longestRun(SeatWord word) {
+    int len = 0;
+    while (word != 0) {
+        word &= word >> 1;
+        len++;
+    }
+    return len;
+}
+
+// Function: firstRunStart
+// Purpose: Lowest bit index where 'len' consecutive set bits begin, or -1.
+// After the loop, bit c of 'm' is set only if bits c .. c+len-1 were all set.
+// The run length doubles each step, so this takes O(log len) word operations.
+static int firstRunStart(SeatWord word, int len) {
+    SeatWord m = word;
+    int have = 1;
+    if (len <= 0 || len > SEATS_PER_WORD) return -1;
+    while (have * 2 <= len) {
+        m &= m >> have;
+        have *= 2;
+    }
+    if (have < len) m &= m >> (len - have);
+    return (m != 0) ? lowestBitIndex(m) : -1;
+}
+
+// ---------------------------------------------------------
+// FREE-RUN INDEX MAINTENANCE
+// ---------------------------------------------------------
+
+// Function: classTree
+// Purpose: Start of the segment tree for one showtime + class.
+static unsigned char* classTree(int showtimeIndex, int type) {
+    const ShowtimeBlock* block = &blocks[showtimeIndex];
+    return runTree + block->firstNode + block->treeBase[type];
+}
+
+// Function: rowRunMask
+// Purpose: The seats that count toward contiguous runs (free, not wheelchair).
+static SeatWord rowRunMask(int showtimeIndex, int r) {
+    return getRowFreeMask(showtimeIndex, r) & ~getHall(showtimeIndex)->wheelMask[r];
+}
+
+// Function: childMax
+// Purpose: The larger of the two children of a tree node.
+static unsigned char childMax(unsigned char* tree, int node) {
+    unsigned char left = LOAD_NODE(&tree[2 * node]), right = LOAD_NODE(&tree[2 * node + 1]);
+    return (left > right) ? left : right;
+}
+
+// Function: updateRunIndex
+// Purpose: Recomputes the leaf of one row and walks up to the root,
+// repeating each store until it matches the row / children read after it.
+// Cost: one run scan of a single word + log2(rows) max() steps (more only
+// while another kiosk is changing the same rows).
+static void updateRunIndex(int showtimeIndex, int r) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    int type = hall->rowClass[r];
+    unsigned char* tree = classTree(showtimeIndex, type);
+    int node = blocks[showtimeIndex].treeLeaves[type] + hall->classIndex[r];
+    unsigned char value;
+
+    do {
+        value = (unsigned char)longestRun(rowRunMask(showtimeIndex, r));
+        STORE_NODE(&tree[node], value);
+    } while ((unsigned char)longestRun(rowRunMask(showtimeIndex, r)) != value);
+
+    for(node /= 2; node >= 1; node /= 2) {
+        do {
+            value = childMax(tree, node);
+            STORE_NODE(&tree[node], value);
+        } while (childMax(tree, node) != value);
+    }
+}
+
+// Function: rankIndex
+// Purpose: Start of the best-seat index of one showtime + class.
+static SeatWord* rankIndex(int showtimeIndex, int type) {
+    return rankIndexArena + blocks[showtimeIndex].rankBase[type];
+}
+
+// Function: updateRankIndex
+// Purpose: Copies the state of the 'changed' seats of a row into the
+// best-seat index. Another kiosk may change the same seat while we write,
+// and our write could then undo its update; so after writing we look at
+// the row word again and repeat until what we wrote is still true.
+static void updateRankIndex(int showtimeIndex, int r, SeatWord changed) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    SeatWord* index = rankIndex(showtimeIndex, hall->rowClass[r]);
+    changed &= hall->seatMask[r];
+
+    while (changed != 0) {
+        int c = lowestBitIndex(changed);
+        changed &= changed - 1;
+
+        int rank = hall->seatRank[r][c];
+        SeatWord* word = &index[1 + rank / SEATS_PER_WORD];
+        SeatWord bit = (SeatWord)1 << (rank % SEATS_PER_WORD);
+        SeatWord group = (SeatWord)1 << (rank / SEATS_PER_WORD);
+        int isFree;
+        do {
+            isFree = (int)((getRowFreeMask(showtimeIndex, r) >> c) & 1);
+            if (isFree) {
+                OR_WORD(word, bit);
+                OR_WORD(&index[0], group);
+            } else if ((CLEAR_WORD(word, bit) & ~bit) == 0) {
+                // Word now empty: drop it from the summary, unless a seat
+                // came back in the meantime
+                CLEAR_WORD(&index[0], group);
+                if (LOAD_WORD(word) != 0) OR_WORD(&index[0], group);
+            }
+        } while ((int)((getRowFreeMask(showtimeIndex, r) >> c) & 1) != isFree);
+    }
+}
+
+// Function: rowChanged
+// Purpose: Every change to a row goes through here: the free-run index and
+// the best-seat index are refreshed ('changed' = the seats that may have
+// changed) and the new row state is published to the change feed.
+static void rowChanged(int showtimeIndex, int r, SeatWord changed) {
+    updateRunIndex(showtimeIndex, r);
+    updateRankIndex(showtimeIndex, r, changed);
+    publishRowChange(showtimeIndex, r);
+}
+
+// ---------------------------------------------------------
+// INVENTORY OPERATIONS
+// ---------------------------------------------------------
+
+// Function: buildInventory
+// Purpose: Sizes the arena from the halls of the showtimes (the sum of
+// their rows), zeroes it (all seats available) and builds the free-run
+// and best-seat indexes.
+int buildInventory() {
+    int showCount = getNumShowtimes();
+    int rows = 0, nodes = 0, rankWords = 0;
+    int type, t, r, k;
+
+    free(blocks);
+    blocks = calloc((size_t)showCount + 1, sizeof(ShowtimeBlock));
+    if (blocks == NULL) { arenaWords = 0; return 0; }
+
+    // Each showtime gets its rows and one tree per class, back to back
+    for(t = 0; t < showCount; t++) {
+        const HallLayout* hall = getHall(t);
+        ShowtimeBlock* block = &blocks[t];
+        block->firstRow = rows;
+        block->firstNode = nodes;
+        for(type = TYPE_VIP; type <= TYPE_REG; type++) {
+            block->treeLeaves[type] = 1;
+            while (block->treeLeaves[type] < hall->classRowCount[type]) block->treeLeaves[type] *= 2;
+            block->treeBase[type] = nodes - block->firstNode;
+            nodes += 2 * block->treeLeaves[type];
+
+            block->rankBase[type] = rankWords;
+            rankWords += 1 + (getClassCapacity(t, type) + SEATS_PER_WORD - 1) / SEATS_PER_WORD;
+        }
+        rows += hall->rows;
+    }
+
+    free(seatArena);
+    free(runTree);
+    free(rankIndexArena);
+    seatArena = calloc((size_t)rows + 1, sizeof(SeatRow));
+    runTree = calloc((size_t)nodes + 1, 1);
+    rankIndexArena = calloc((size_t)rankWords + 1, sizeof(SeatWord));
+    if (seatArena == NULL || runTree == NULL || rankIndexArena == NULL) { arenaWords = 0; return 0; }
+
+    arenaWords = rows;
+    resetSeatFeed();
+    for(t = 0; t < showCount; t++) {
+        for(r = 0; r < getHall(t)->rows; r++) updateRunIndex(t, r);
+
+        // Every seat is free: the first 'capacity' bits of each index are set
+        for(type = TYPE_VIP; type <= TYPE_REG; type++) {
+            SeatWord* index = rankIndex(t, type);
+            int capacity = getClassCapacity(t, type);
+            for(k = 0; k < capacity; k++) {
+                index[1 + k / SEATS_PER_WORD] |= (SeatWord)1 << (k % SEATS_PER_WORD);
+                index[0] |= (SeatWord)1 << (k / SEATS_PER_WORD);
+            }
+        }
+    }
+    return 1;
+}
+
+// Function: getRowWord
+// Purpose: Exposes a whole row at once so callers can use bit tricks
+// (e.g. iterate only the free seats) instead of probing seat by seat.
+SeatWord getRowWord(int showtimeIndex, int r) {
+    return LOAD_WORD(&rowAt(showtimeIndex, r)->sold);
+}
+
+// Function: getRowFreeMask
+// Purpose: Real seats of the row that are neither claimed nor sold.
+SeatWord getRowFreeMask(int showtimeIndex, int r) {
+    return getHall(showtimeIndex)->seatMask[r] & ~LOAD_WORD(&rowAt(showtimeIndex, r)->taken);
+}
+
+// Function: isInventorySeatSold
+// Purpose: Tests a single bit. Returns 1 (Sold) or 0 (Available).
+int isInventorySeatSold(int showtimeIndex, int r, int c) {
+    return (int)((LOAD_WORD(&rowAt(showtimeIndex, r)->sold) >> c) & 1);
+}
+
+// Function: isInventorySeatTaken
+// Purpose: Returns 1 if the seat is claimed by a kiosk or sold.
+int isInventorySeatTaken(int showtimeIndex, int r, int c) {
+    return (int)((LOAD_WORD(&rowAt(showtimeIndex, r)->taken) >> c) & 1);
+}
+
+// Function: countFreeInClass
+// Purpose: One popcount per row instead of one comparison per seat.
+int countFreeInClass(int showtimeIndex, int type) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    int freeCount = 0;
+    int i;
+    for(i = 0; i < hall->classRowCount[type]; i++) {
+        freeCount += bitCount(getRowFreeMask(showtimeIndex, hall->classRows[type][i]));
+    }
+    return freeCount;
+}
+
+// Function: countSoldInShowtime
+// Purpose: Total sold seats for one showtime (one popcount per row).
+int countSoldInShowtime(int showtimeIndex) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    int sold = 0;
+    int r;
+    for(r = 0; r < hall->rows; r++) {
+        sold += bitCount(getRowWord(showtimeIndex, r) & hall->seatMask[r]);
+    }
+    return sold;
+}
+
+// ---------------------------------------------------------
+// LOCK-FREE CLAIMS
+// ---------------------------------------------------------
+
+// Function: claimRowMasks
+// Purpose: All-or-nothing claim of a set of seats in one showtime.
+// For each row (front to back) we compare-and-swap the 'taken' word from
+// 'old' to 'old | mask'. If any wanted seat is already taken, every row we
+// already claimed is given back and the whole claim fails.
+// No lock is held, so kiosks working on other rows/showtimes never wait.
+int claimRowMasks(int showtimeIndex, const SeatWord* rowMasks) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    int r, undo;
+
+    for(r = 0; r < hall->rows; r++) {
+        SeatWord want = rowMasks[r];
+        if (want == 0) continue;
+
+        SeatRow* row = rowAt(showtimeIndex, r);
+        SeatWord old = LOAD_WORD(&row->taken);
+        int claimed = 0;
+
+        // Aisles can never be claimed
+        if ((want & ~hall->seatMask[r]) == 0) {
+            while ((old & want) == 0) {
+                if (__atomic_compare_exchange_n(&row->taken, &old, old | want, 1,
+                                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                    claimed = 1;
+                    break;
+                }
+                // CAS failed: 'old' now holds the fresh value, check it again
+            }
+        }
+
+        if (!claimed) {
+            // Roll back the rows we already own
+            for(undo = 0; undo < r; undo++) {
+                if (rowMasks[undo] == 0) continue;
+                CLEAR_WORD(&rowAt(showtimeIndex, undo)->taken, rowMasks[undo]);
+                rowChanged(showtimeIndex, undo, rowMasks[undo]);
+            }
+            return 0;
+        }
+        rowChanged(showtimeIndex, r, want);
+    }
+    return 1;
+}
+
+// Function: releaseRowMasks
+// Purpose: Gives claimed (unpaid) seats back to the free pool.
+// Sold seats are never released.
+void releaseRowMasks(int showtimeIndex, const SeatWord* rowMasks) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    int r;
+    for(r = 0; r < hall->rows; r++) {
+        if (rowMasks[r] == 0) continue;
+        SeatRow* row = rowAt(showtimeIndex, r);
+        CLEAR_WORD(&row->taken, rowMasks[r] & ~LOAD_WORD(&row->sold));
+        rowChanged(showtimeIndex, r, rowMasks[r]);
+    }
+}
+
+// Function: sellRowMasks
+// Purpose: Turns claimed seats into sold seats.
+void sellRowMasks(int showtimeIndex, const SeatWord* rowMasks) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    int r;
+    for(r = 0; r < hall->rows; r++) {
+        if (rowMasks[r] == 0) continue;
+        SeatRow* row = rowAt(showtimeIndex, r);
+        OR_WORD(&row->taken, rowMasks[r]);
+        OR_WORD(&row->sold, rowMasks[r]);
+        rowChanged(showtimeIndex, r, rowMasks[r]);
+    }
+    __atomic_add_fetch(&soldVersion, 1, __ATOMIC_RELEASE);
+}
+
+// Function: unsellRowMasks
+// Purpose: Puts sold seats back on sale. Only for a sale the sales log
+// never got: the version bump makes the next snapshot drop them too.
+void unsellRowMasks(int showtimeIndex, const SeatWord* rowMasks) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    int r;
+    for(r = 0; r < hall->rows; r++) {
+        if (rowMasks[r] == 0) continue;
+        SeatRow* row = rowAt(showtimeIndex, r);
+        CLEAR_WORD(&row->sold, rowMasks[r]); // Sold first, so a seat is never free but sold
+        CLEAR_WORD(&row->taken, rowMasks[r]);
+        rowChanged(showtimeIndex, r, rowMasks[r]);
+    }
+    __atomic_add_fetch(&soldVersion, 1, __ATOMIC_RELEASE);
+}
+
+// ---------------------------------------------------------
+// SNAPSHOT SUPPORT
+// ---------------------------------------------------------
+
+// Function: getInventoryWordCount
+// Purpose: Number of row words in the arena (the rows of every showtime).
+int getInventoryWordCount() {
+    return arenaWords;
+}
+
+// Function: getInventoryVersion
+// Purpose: Lets the snapshot writer skip a pass when nothing was sold.
+unsigned long long getInventoryVersion() {
+    return __atomic_load_n(&soldVersion, __ATOMIC_ACQUIRE);
+}
+
+// Function: copySoldWords
+// Purpose: Copies every sold word, in arena order, into 'out'.
+// Each word is read atomically, so kiosks can keep selling meanwhile.
+void copySoldWords(SeatWord* out) {
+    int i, count = getInventoryWordCount();
+    for(i = 0; i < count; i++) out[i] = LOAD_WORD(&seatArena[i].sold);
+}
+
+// Function: restoreSoldWords
+// Purpose: Marks the seats of a snapshot as sold (only adds, never clears)
+// and refreshes the free-run index. Called once at startup.
+void restoreSoldWords(const SeatWord* words, int count) {
+    int t, r;
+    if (count > getInventoryWordCount()) count = getInventoryWordCount();
+    for(t = 0; t < getNumShowtimes(); t++) {
+        for(r = 0; r < getHall(t)->rows; r++) {
+            int i = blocks[t].firstRow + r;
+            if (i >= count) return;
+            SeatWord bits = words[i] & getHall(t)->seatMask[r];
+            if (bits == 0) continue;
+            OR_WORD(&seatArena[i].taken, bits);
+            OR_WORD(&seatArena[i].sold, bits);
+            rowChanged(t, r, bits);
+        }
+    }
+    __atomic_add_fetch(&soldVersion, 1, __ATOMIC_RELEASE);
+}
+
+// ---------------------------------------------------------
+// BOOKING SERVER SUPPORT
+// ---------------------------------------------------------
+
+// Function: copyShowtimeWords
+// Purpose: The server's answer to a seat map query: both words of every row.
+void copyShowtimeWords(int showtimeIndex, SeatWord* taken, SeatWord* sold) {
+    int r;
+    for(r = 0; r < getHall(showtimeIndex)->rows; r++) {
+        SeatRow* row = rowAt(showtimeIndex, r);
+        taken[r] = LOAD_WORD(&row->taken);
+        sold[r] = LOAD_WORD(&row->sold);
+    }
+}
+
+// Function: copyRowWords
+// Purpose: Both words of one row (what the change feed publishes).
+void copyRowWords(int showtimeIndex, int r, SeatWord* taken, SeatWord* sold) {
+    SeatRow* row = rowAt(showtimeIndex, r);
+    *taken = LOAD_WORD(&row->taken);
+    *sold = LOAD_WORD(&row->sold);
+}
+
+// Function: loadRowWords
+// Purpose: A thin client or display overwrites one row of its mirror with
+// the server's words (seats can become free again, unlike restoreSoldWords).
+void loadRowWords(int showtimeIndex, int r, SeatWord taken, SeatWord sold) {
+    if (r < 0 || r >= getHall(showtimeIndex)->rows) return;
+    SeatRow* row = rowAt(showtimeIndex, r);
+    SeatWord mask = getHall(showtimeIndex)->seatMask[r];
+    SeatWord before = LOAD_WORD(&row->taken);
+    __atomic_store_n(&row->taken, taken & mask, __ATOMIC_RELEASE);
+    __atomic_store_n(&row->sold, sold & mask, __ATOMIC_RELEASE);
+    rowChanged(showtimeIndex, r, before ^ (taken & mask));
+    __atomic_add_fetch(&soldVersion, 1, __ATOMIC_RELEASE);
+}
+
+// Function: loadShowtimeWords
+// Purpose: The same for every row of one showtime.
+void loadShowtimeWords(int showtimeIndex, const SeatWord* taken, const SeatWord* sold) {
+    int r;
+    for(r = 0; r < getHall(showtimeIndex)->rows; r++) loadRowWords(showtimeIndex, r, taken[r], sold[r]);
+}
+
+// ---------------------------------------------------------
+// FREE-RUN QUERIES
+// ---------------------------------------------------------
+
+// Function: getLongestFreeRun
+// Purpose: The root of the class tree = best run in the whole class.
+int getLongestFreeRun(int showtimeIndex, int type) {
+    if (getHall(showtimeIndex)->classRowCount[type] == 0) return 0;
+    return LOAD_NODE(&classTree(showtimeIndex, type)[1]);
+}
+
+// Function: findContiguousSeats
+// Purpose: Walks down the class tree, always preferring the left child
+// (the front-most rows), to the first row whose longest run is >= qty.
+// Then locates the run inside that row with a few word operations.
+int findContiguousSeats(int showtimeIndex, int type, int qty, int* row, int* col) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    if (getLongestFreeRun(showtimeIndex, type) < qty) return 0;
+
+    unsigned char* tree = classTree(showtimeIndex, type);
+    int node = 1;
+    int leaves = blocks[showtimeIndex].treeLeaves[type];
+    while (node < leaves) {
+        node = (LOAD_NODE(&tree[2 * node]) >= qty) ? 2 * node : 2 * node + 1;
+    }
+
+    // Re-check the row itself: another kiosk may have changed it meanwhile
+    int r = hall->classRows[type][node - leaves];
+    int c = firstRunStart(rowRunMask(showtimeIndex, r), qty);
+    if (c < 0) {
+        // Stale hint: fall back to checking every row of the class
+        int i;
+        for(i = 0; i < hall->classRowCount[type] && c < 0; i++) {
+            r = hall->classRows[type][i];
+            c = firstRunStart(rowRunMask(showtimeIndex, r), qty);
+        }
+        if (c < 0) return 0;
+    }
+    *row = r;
+    *col = c;
+    return 1;
+}
+
+// ---------------------------------------------------------
+// BEST-SEAT QUERIES
+// ---------------------------------------------------------
+
+// Function: findBestFreeSeats
+// Purpose: Walks the best-seat index lowest bit first: the summary word
+// says which bitmap words have free seats, each set bit is the next best
+// seat. Every seat is checked against its row word before it is returned
+// (the index may be a step behind a kiosk that is claiming it right now).
+int findBestFreeSeats(int showtimeIndex, int type, int max, unsigned short* seats) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    SeatWord* index = rankIndex(showtimeIndex, type);
+    SeatWord groups = LOAD_WORD(&index[0]);
+    int found = 0;
+
+    while (groups != 0 && found < max) {
+        int w = lowestBitIndex(groups);
+        groups &= groups - 1;
+
+        SeatWord bits = LOAD_WORD(&index[1 + w]);
+        while (bits != 0 && found < max) {
+            int seat = hall->rankedSeats[type][w * SEATS_PER_WORD + lowestBitIndex(bits)];
+            bits &= bits - 1;
+            if (!isInventorySeatTaken(showtimeIndex, seat / MAX_COLS, seat % MAX_COLS)) seats[found++] = (unsigned short)seat;
+        }
+    }
+    return found;
+}
+
+// Function: findBestContiguousSeats
+// Purpose: Goes through the free seats best first and stops at the first
+// one whose row has a run of 'qty' free seats around it (the free-run
+// index says which rows can have one at all). Of the windows of 'qty'
+// seats that include that seat, the one closest to the centerline wins.
+// Example: qty 3, best free seat C4 in a 6-seat row -> C3-C5 (or C2-C4).
+int findBestContiguousSeats(int showtimeIndex, int type, int qty, int* row, int* col) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    if (qty < 1 || qty > SEATS_PER_WORD || getLongestFreeRun(showtimeIndex, type) < qty) return 0;
+
+    unsigned char* tree = classTree(showtimeIndex, type);
+    int leaves = blocks[showtimeIndex].treeLeaves[type];
+    SeatWord* index = rankIndex(showtimeIndex, type);
+    SeatWord groups = LOAD_WORD(&index[0]);
+    SeatWord window = (qty == SEATS_PER_WORD) ? ~(SeatWord)0 : (((SeatWord)1 << qty) - 1);
+
+    while (groups != 0) {
+        int w = lowestBitIndex(groups);
+        groups &= groups - 1;
+
+        SeatWord bits = LOAD_WORD(&index[1 + w]);
+        while (bits != 0) {
+            int seat = hall->rankedSeats[type][w * SEATS_PER_WORD + lowestBitIndex(bits)];
+            int r = seat / MAX_COLS, c = seat % MAX_COLS;
+            bits &= bits - 1;
+            if (LOAD_NODE(&tree[leaves + hall->classIndex[r]]) < qty) continue; // No room in this row
+
+            SeatWord runs = rowRunMask(showtimeIndex, r);
+            int start, bestStart = -1, bestDistance = 0;
+            for(start = (c - qty + 1 > 0) ? c - qty + 1 : 0; start <= c && start + qty <= SEATS_PER_WORD; start++) {
+                if ((runs & (window << start)) != (window << start)) continue;
+                int distance = abs(2 * start + qty - 1 - (hall->cols - 1));
+                if (bestStart < 0 || distance < bestDistance) { bestStart = start; bestDistance = distance; }
+            }
+            if (bestStart >= 0) {
+                *row = r;
+                *col = bestStart;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
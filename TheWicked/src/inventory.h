@@ -0,0 +1,148 @@
+#ifndef INVENTORY_H
+#define INVENTORY_H
+
+#include "hall.h"
+
+// ---------------------------------------------------------
+// BIT-PACKED SEAT INVENTORY
+// ---------------------------------------------------------
+// Every row of every showtime is stored as 64-bit words (one bit per seat).
+// Bit 'c' of the sold word is set when seat 'c' of that row is sold.
+// Example: row word 0x05 (binary 000101) means seats 1 and 3 are sold.
+// A second "taken" word also marks seats claimed by a kiosk mid-purchase.
+//
+// This lets us answer questions with a handful of word operations:
+//   - Free seats in a row  = popcount(seatMask & ~row)
+//   - First free seat      = count-trailing-zeros(seatMask & ~row)
+//
+// All rows of all showtimes live in ONE flat arena allocated when the
+// hall layout is compiled: the rows of showtime 0, then those of showtime 1,
+// and so on (each showtime has as many rows as the hall it plays in).
+
+// ---------------------------------------------------------
+// BIT HELPERS
+// ---------------------------------------------------------
+// Number of set bits in a word (compiles to a single POPCNT where available).
+int bitCount(SeatWord word);
+
+// Index of the lowest set bit. The word must NOT be zero.
+int lowestBitIndex(SeatWord word);
+
+// ---------------------------------------------------------
+// INVENTORY PROTOTYPES
+// ---------------------------------------------------------
+
+// (Re)allocates the arena for the current schedule and marks every seat available.
+// Returns: 1 on success, 0 if out of memory.
+int buildInventory();
+
+// Returns the raw sold-bits word for one row of one showtime.
+SeatWord getRowWord(int showtimeIndex, int r);
+
+// Returns the FREE real seats of a row as a bit mask (aisles excluded).
+SeatWord getRowFreeMask(int showtimeIndex, int r);
+
+// Returns 1 if the seat is sold, 0 if it is available.
+int isInventorySeatSold(int showtimeIndex, int r, int c);
+
+// Returns 1 if the seat is claimed by a kiosk or sold.
+int isInventorySeatTaken(int showtimeIndex, int r, int c);
+
+// Counts the free (unclaimed, unsold) seats in all rows of one class.
+int countFreeInClass(int showtimeIndex, int type);
+
+// Counts the sold seats of one showtime.
+int countSoldInShowtime(int showtimeIndex);
+
+// ---------------------------------------------------------
+// LOCK-FREE CLAIMS (Concurrent Kiosks)
+// ---------------------------------------------------------
+// 'rowMasks' has one entry per hall row: the seats of that row in the set
+// (0 = row not involved). Safe to call from many threads at once.
+
+// Claims every seat in the set, or none of them.
+// Returns: 1 if the whole set is now ours, 0 if any seat was already taken.
+int claimRowMasks(int showtimeIndex, const SeatWord* rowMasks);
+
+// Returns claimed (unpaid) seats to the free pool.
+void releaseRowMasks(int showtimeIndex, const SeatWord* rowMasks);
+
+// Marks the seats as sold (normally after a successful claim + payment).
+void sellRowMasks(int showtimeIndex, const SeatWord* rowMasks);
+
+// Undoes sellRowMasks() for a sale that was never logged (refunded).
+void unsellRowMasks(int showtimeIndex, const SeatWord* rowMasks);
+
+// ---------------------------------------------------------
+// SNAPSHOT SUPPORT (see snapshot.c)
+// ---------------------------------------------------------
+// The sold words are exported/imported in arena order: showtime by showtime,
+// front row first.
+
+// Number of row words in the arena (the rows of every showtime).
+int getInventoryWordCount();
+
+// Counter that changes every time a seat is sold.
+unsigned long long getInventoryVersion();
+
+// Copies all sold words into 'out' (getInventoryWordCount() entries).
+void copySoldWords(SeatWord* out);
+
+// Marks the seats in 'words' as sold. Existing sales are kept.
+void restoreSoldWords(const SeatWord* words, int count);
+
+// ---------------------------------------------------------
+// BOOKING SERVER SUPPORT
+// ---------------------------------------------------------
+// 'taken' / 'sold' have one word per hall row.
+
+// Copies the claimed-or-sold and the sold words of one showtime.
+void copyShowtimeWords(int showtimeIndex, SeatWord* taken, SeatWord* sold);
+
+// Replaces one showtime with words received from the booking server.
+void loadShowtimeWords(int showtimeIndex, const SeatWord* taken, const SeatWord* sold);
+
+// Copies both words of a single row.
+void copyRowWords(int showtimeIndex, int r, SeatWord* taken, SeatWord* sold);
+
+// Replaces a single row (one change-feed delta, see feed.h).
+void loadRowWords(int showtimeIndex, int r, SeatWord taken, SeatWord sold);
+
+// ---------------------------------------------------------
+// FREE-RUN INDEX (Contiguous Seating)
+// ---------------------------------------------------------
+// For every showtime and class we keep a small segment tree over the
+// rows of that class. Each leaf holds the longest run of adjacent free
+// seats in its row; each parent holds the max of its children.
+// The tree is updated in place whenever a seat is sold, so
+// "find N adjacent seats" is a walk from the root to one leaf.
+// Wheelchair bays are not counted as part of a run (auto-assign skips them).
+
+// Longest run of adjacent free seats anywhere in a class (the tree root).
+int getLongestFreeRun(int showtimeIndex, int type);
+
+// Finds the front-most row of a class with 'qty' adjacent free seats.
+// Returns: 1 and fills (*row, *col) with the leftmost seat of the run,
+// or 0 if no row can seat the whole party together.
+int findContiguousSeats(int showtimeIndex, int type, int qty, int* row, int* col);
+
+// ---------------------------------------------------------
+// BEST-SEAT INDEX (Auto-Assign)
+// ---------------------------------------------------------
+// The free seats of every showtime and class are also kept in seat-quality
+// order (seatRank in hall.h) as a two-level bitmap, updated seat by seat
+// whenever seats are claimed, released or sold. Finding the best N free
+// seats costs O(N) word operations instead of a scan and sort of the hall.
+
+// Writes the best 'max' free seats of a class into 'seats', best first
+// (row * MAX_COLS + col). Wheelchair bays rank after every other seat.
+// Returns: Number of seats written (fewer than 'max' if the class is nearly full).
+int findBestFreeSeats(int showtimeIndex, int type, int max, unsigned short* seats);
+
+// Finds 'qty' adjacent free seats (no wheelchair bays) around the best
+// free seat that has room for the whole party.
+// Returns: 1 and fills (*row, *col) with the leftmost seat of the run,
+// or 0 if no row can seat the whole party together.
+int findBestContiguousSeats(int showtimeIndex, int type, int qty, int* row, int* col);
+
+#endif
@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include "lobby.h"
+#include "remote.h"
+#include "tickets.h"
+#include "hall.h"
+#include "catalog.h"
+#include "inventory.h"
+#include "ui.h"
+#include "utilities.h"
+
+// Function: drawShowtimeLine
+// Purpose: One line of the board: free seats per class, held, sold and a
+// sold-out bar. Reads the local mirror, which the pushes keep current.
+static void drawShowtimeLine(int showtimeIndex) {
+    const ShowtimeInfo* info = getShowtimeInfo(showtimeIndex);
+    const HallLayout* hall = getHall(showtimeIndex);
+    int freeVip = countFreeInClass(showtimeIndex, TYPE_VIP);
+    int freeReg = countFreeInClass(showtimeIndex, TYPE_REG);
+    int sold = countSoldInShowtime(showtimeIndex);
+    int held = hall->capacity - freeVip - freeReg - sold;
+
+    char bar[13];
+    int filled = (hall->capacity > 0) ? (sold * 12 + hall->capacity - 1) / hall->capacity : 0, i;
+    for(i = 0; i < 12; i++) bar[i] = (i < filled) ? '#' : '.';
+    bar[12] = '\0';
+
+    // A multiplex board names the film; a single-film cinema the show label
+    const ShowingInfo* showing = getShowingInfo(showtimeIndex);
+    const char* name = (getNumFilms() > 1 && showing != NULL) ? getFilmInfo(showing->film)->title : info->label;
+
+    const char* status = (freeVip + freeReg == 0) ? COLOR_RED "SOLD OUT" : COLOR_GREEN "SELLING ";
+    gotoxy(2, 10 + showtimeIndex);
+    screenPrintf(COLOR_CYAN "%-9s" COLOR_WHITE "%-13.13s " COLOR_YELLOW "VIP %3d free  " COLOR_WHITE "REG %4d free  "
+                 COLOR_YELLOW "Held %3d  " COLOR_RED "Sold %4d  " COLOR_MAGENTA "[%s] %s" COLOR_RESET,
+                 info->time, name, freeVip, freeReg, held, sold, bar, status);
+}
+
+// Function: runLobbyDisplay
+int runLobbyDisplay(const char* address) {
+    if (!connectBookingServer(address) || !subscribeSeatFeed(-1)) {
+        fprintf(stderr, "Cannot subscribe to a booking server with this hall layout at '%s'.\n", address);
+        return 1;
+    }
+
+    int shown = getNumShowtimes();
+    if (shown > LOBBY_MAX_LINES) shown = LOBBY_MAX_LINES;
+    long long updates = 0;
+    int t;
+
+    printHeader("NOW SELLING - THE WICKED GOOD");
+    gotoxy(2, 8);
+    screenPrintf(COLOR_MAGENTA "%-9s%-14s%-53s%s" COLOR_RESET, "Time", "Show", "Seats", "Sold so far");
+    for(t = 0; t < shown; t++) drawShowtimeLine(t);
+    presentScreen();
+
+    while (1) {
+        int changed = readSeatPush();
+        if (changed == -2) break;       // Server gone
+        if (changed < 0 || changed >= shown) continue;
+
+        updates++;
+        drawShowtimeLine(changed);
+        printDivider(11 + shown);
+        gotoxy(30, 12 + shown);
+        screenPrintf(COLOR_WHITE "Live updates received: %lld" COLOR_RESET, updates);
+        presentScreen();
+    }
+
+    printCentered(14 + shown, "Connection to the booking server lost.", COLOR_RED);
+    gotoxy(0, 16 + shown);
+    presentScreen();
+    return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef LOBBY_H
+#define LOBBY_H
+
+// ---------------------------------------------------------
+// LOBBY DISPLAY
+// ---------------------------------------------------------
+// "TheWicked --display [address]" turns a screen in the lobby into a live
+// sales board for every showtime of the day. It subscribes to the booking
+// server's seat change feed (see feed.h / server.h): the server pushes the
+// whole map once, then only the rows that change, and the board is redrawn
+// (through the frame buffer, so only changed cells) after each change.
+// Nothing is polled, so adding displays does not add load while no
+// tickets are being sold.
+#define LOBBY_MAX_LINES 36   // Showtimes that fit on the board
+
+// Connects, subscribes and keeps the board current until the server goes away.
+// Returns: 0 when the server closed the connection, 1 if it could not connect.
+int runLobbyDisplay(const char* address);
+
+#endif
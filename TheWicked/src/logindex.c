@@ -0,0 +1,105 @@
+#include <stdlib.h>
+#include <string.h>
+#include "logindex.h"
+
+// ---------------------------------------------------------
+// HELPERS
+// ---------------------------------------------------------
+
+// Function: addCheckpoint
+// Purpose: Appends one checkpoint, doubling the array when full.
+static int addCheckpoint(SalesIndex* index, long long record, long long timeUs) {
+    if (index->checkpointCount == index->checkpointCapacity) {
+        long long newCap = (index->checkpointCapacity == 0) ? 64 : index->checkpointCapacity * 2;
+        LogCheckpoint* grown = realloc(index->checkpoints, sizeof(LogCheckpoint) * (size_t)newCap);
+        if (grown == NULL) return 0;
+        index->checkpoints = grown;
+        index->checkpointCapacity = newCap;
+    }
+    index->checkpoints[index->checkpointCount].record = record;
+    index->checkpoints[index->checkpointCount].timeUs = timeUs;
+    index->checkpointCount++;
+    return 1;
+}
+
+// Function: isStillValid
+// Purpose: The log only ever grows between cashouts. If it got shorter, or
+// the last sale we saw is no longer where we saw it, it was trimmed.
+static int isStillValid(const SalesIndex* index, const SalesView* view) {
+    if (view->count < index->scannedRecords) return 0;
+    if (index->sales == 0) return 1;
+    const SalesRecord* rec = &view->records[index->lastSaleRecord];
+    return rec->kind == REC_SALE && rec->body.sale.timeUs == index->lastSaleUs;
+}
+
+// ---------------------------------------------------------
+// PUBLIC API
+// ---------------------------------------------------------
+
+// Function: refreshSalesIndex
+// Purpose: Walks only the records appended since the last refresh.
+int refreshSalesIndex(SalesIndex* index, const SalesView* view) {
+    if (!isStillValid(index, view)) clearSalesIndex(index);
+
+    long long i = index->scannedRecords;
+    while (i < view->count && isSalesRecordComplete(view, i)) {
+        const SalesRecord* rec = &view->records[i];
+        if (rec->kind == REC_SALE) {
+            if (index->sales % LOG_CHECKPOINT_EVERY == 0 && !addCheckpoint(index, i, rec->body.sale.timeUs)) return 0;
+            index->sales++;
+            index->lastSaleRecord = i;
+            index->lastSaleUs = rec->body.sale.timeUs;
+        }
+        i = nextSalesRecord(view, i);
+    }
+    index->scannedRecords = i;
+    return 1;
+}
+
+// Function: findSaleRecord
+// Purpose: Checkpoint for the block, then hop sale by sale (< 64 hops).
+long long findSaleRecord(const SalesIndex* index, const SalesView* view, long long saleNumber) {
+    if (saleNumber < 0 || saleNumber >= index->sales) return -1;
+
+    long long i = index->checkpoints[saleNumber / LOG_CHECKPOINT_EVERY].record;
+    long long skip = saleNumber % LOG_CHECKPOINT_EVERY;
+    while (skip > 0) {
+        i = nextSalesRecord(view, i);
+        if (view->records[i].kind == REC_SALE) skip--;
+    }
+    return i;
+}
+
+// Function: findSaleAtTime
+// Purpose: Binary search over the checkpoint times, then a short walk
+// inside the one block that can contain the answer.
+long long findSaleAtTime(const SalesIndex* index, const SalesView* view, long long timeUs) {
+    if (index->sales == 0) return 0;
+
+    // Last checkpoint that is still before 'timeUs'
+    long long low = 0, high = index->checkpointCount;
+    while (low < high) {
+        long long mid = low + (high - low) / 2;
+        if (index->checkpoints[mid].timeUs < timeUs) low = mid + 1;
+        else high = mid;
+    }
+    if (low == 0) return 0;
+
+    long long block = low - 1;
+    long long sale = block * LOG_CHECKPOINT_EVERY;
+    long long i = index->checkpoints[block].record;
+    while (sale < index->sales) {
+        if (view->records[i].kind == REC_SALE) {
+            if (view->records[i].body.sale.timeUs >= timeUs) break;
+            sale++;
+        }
+        i = nextSalesRecord(view, i);
+    }
+    return sale;
+}
+
+// Function: clearSalesIndex
+void clearSalesIndex(SalesIndex* index) {
+    free(index->checkpoints);
+    memset(index, 0, sizeof(*index));
+}
@@ -0,0 +1,48 @@
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include "salesrec.h"
+
+// ---------------------------------------------------------
+// SPARSE SALES INDEX (Paged Log Viewer)
+// ---------------------------------------------------------
+// Records are fixed-width, but a big party takes several records, so
+// "sale number N" is not simply record N. The index remembers where
+// every 64th sale starts (a checkpoint) and when it happened.
+// Finding any sale = one checkpoint lookup + at most 63 hops forward,
+// whatever the size of the log.
+//
+// The index is extended incrementally: each refresh only looks at the
+// records appended since the previous one. If the log was trimmed
+// (cashout) the index notices and starts over.
+#define LOG_CHECKPOINT_EVERY 64
+
+typedef struct {
+    long long record;    // Record number of the checkpoint sale
+    long long timeUs;    // Its timestamp
+} LogCheckpoint;
+
+typedef struct {
+    LogCheckpoint* checkpoints;
+    long long checkpointCount;
+    long long checkpointCapacity;
+    long long sales;             // Sales indexed so far
+    long long scannedRecords;    // Records already looked at
+    long long lastSaleRecord;    // Used to detect a trimmed / replaced log
+    long long lastSaleUs;
+} SalesIndex;
+
+// Brings the index up to date with the mapped log (new records only).
+// Returns: 1 on success, 0 if out of memory.
+int refreshSalesIndex(SalesIndex* index, const SalesView* view);
+
+// Record number of sale 'saleNumber' (0-based), or -1 if out of range.
+long long findSaleRecord(const SalesIndex* index, const SalesView* view, long long saleNumber);
+
+// Number of the first sale at or after 'timeUs' (index->sales if none).
+long long findSaleAtTime(const SalesIndex* index, const SalesView* view, long long timeUs);
+
+// Frees the checkpoints and empties the index.
+void clearSalesIndex(SalesIndex* index);
+
+#endif
@@ -1,23 +1,135 @@
 #include <stdio.h>
 #include <stdlib.h> 
+#include <string.h>
 #include <time.h>   
 #include "ui.h"
 #include "tickets.h"
 #include "payments.h"
 #include "utilities.h"
+#include "inventory.h"
+#include "pricing.h"
+#include "wal.h"
+#include "snapshot.h"
+#include "spool.h"
+#include "ticketid.h"
+#include "salesrec.h"
+#include "archive.h"
+#include "headless.h"
+#include "metrics.h"
+#include "server.h"
+#include "remote.h"
+#include "lobby.h"
+
+int main(int argc, char** argv) {
+    // "--script <file>" runs bookings without the kiosk screens (see headless.h)
+    // "--server [address]" shares this machine's seats with thin-client kiosks (server.h)
+    // "--connect [address]" runs the kiosk against such a server (remote.h)
+    // "--display [address]" shows a live sales board fed by such a server (lobby.h)
+    // "--kiosk <n>" (alone or after --connect) numbers this kiosk for its ticket ids (ticketid.h);
+    // required with --connect, otherwise the first number free in this folder is taken
+    const char* scriptPath = NULL;
+    const char* serverAddress = NULL;
+    const char* connectAddress = NULL;
+    if (argc >= 2 && strcmp(argv[1], "--script") == 0) {
+        if (argc < 3) {
+            fprintf(stderr, "Usage: %s --script <file | ->\n", argv[0]);
+            return 2;
+        }
+        scriptPath = argv[2];
+    }
+    else if (argc >= 2 && strcmp(argv[1], "--server") == 0) {
+        serverAddress = (argc >= 3) ? argv[2] : BOOKING_SOCKET;
+    }
+    else if (argc >= 2 && strcmp(argv[1], "--connect") == 0) {
+        connectAddress = (argc >= 3 && strcmp(argv[2], "--kiosk") != 0) ? argv[2] : BOOKING_SOCKET;
+    }
+    else if (argc >= 2 && strcmp(argv[1], "--display") == 0) {
+        initSeats();
+        return runLobbyDisplay((argc >= 3) ? argv[2] : BOOKING_SOCKET);
+    }
+
+    // Every kiosk sharing a server (or a ticket_ids.bin) needs its own number
+    int kioskNumber = -1;
+    int argi;
+    for(argi = 1; argi < argc; argi++) {
+        if (strcmp(argv[argi], "--kiosk") != 0) continue;
+        char* end = NULL;
+        long number = (argi + 1 < argc) ? strtol(argv[argi + 1], &end, 10) : -1;
+        if (end == NULL || *end != '\0' || number < 0 || number >= MAX_TICKET_SHARDS) {
+            fprintf(stderr, "Usage: %s [--connect [address]] --kiosk <0-%d>\n", argv[0], MAX_TICKET_SHARDS - 1);
+            return 2;
+        }
+        kioskNumber = (int)number;
+    }
+    // Kiosks on other machines cannot see which numbers are taken here
+    if (connectAddress != NULL && kioskNumber < 0) {
+        fprintf(stderr, "Usage: %s --connect [address] --kiosk <0-%d> (a number no other kiosk of the server uses)\n", argv[0], MAX_TICKET_SHARDS - 1);
+        return 2;
+    }
+
 
-int main() {
     // 1. INITIALIZATION
-    // Seed the random number generator for ticket IDs
-    srand(time(NULL));
-    
-    // Initialize the 3D Seat Matrix (Clears seats for all 4 showtimes)
+    // Load the hall layout and build the seat inventory (Clears seats for every showtime)
     initSeats(); 
+
+    // The concession stand's SKUs, prices and opening stock
+    loadConcessions(CONCESSIONS_FILE);
+
+    // Thin client: the server has the sales log and the real inventory
+    if (connectAddress != NULL && !connectBookingServer(connectAddress)) {
+        fprintf(stderr, "Cannot reach a booking server with this hall layout at '%s'.\n", connectAddress);
+        return 1;
+    }
+
+    if (!isRemoteKiosk()) {
+        // One-time upgrade of the old text log/archive to binary records
+        importLegacySalesText(LEGACY_SALES_LOG_FILE, SALES_LOG_FILE);
+        importLegacySalesText(LEGACY_ARCHIVE_FILE, ARCHIVE_FILE);
+        prepareSalesFile(SALES_LOG_FILE);
+
+        // Bring back the seats sold before a restart or crash (snapshot + log tail)
+        restoreInventory(SNAPSHOT_FILE, SALES_LOG_FILE);
+        restoreConcessionStock(SALES_LOG_FILE);
+
+        // Open the write-ahead sales log once for the whole session
+        openSalesLog(SALES_LOG_FILE, GROUP_COMMIT_MS);
+
+        // Save the inventory in the background from now on
+        startSnapshotWriter(SNAPSHOT_FILE, SNAPSHOT_INTERVAL_MS);
+    }
+
+    // Booking server: no screens, serve kiosks until stopped
+    if (serverAddress != NULL) {
+        int status = runBookingServer(serverAddress);
+        stopSnapshotWriter();
+        closeSalesLog();
+        return status;
+    }
+
+    // Headless run: process the script, then shut down like "Exit System"
+    if (scriptPath != NULL) {
+        int status = runHeadlessScript(scriptPath);
+        stopSnapshotWriter();
+        closeSalesLog();
+        return status;
+    }
     
+    // Today's ticket ids (for the usher's check), then background printing
+    if (openTicketIds(TICKET_ID_FILE, kioskNumber) < 0) {
+        if (kioskNumber >= 0) fprintf(stderr, "Kiosk number %d is already in use by another kiosk in this folder.\n", kioskNumber);
+        else fprintf(stderr, "Cannot number this kiosk: every kiosk number is in use (or %s.lock cannot be opened).\n", TICKET_ID_FILE);
+        stopSnapshotWriter();
+        closeSalesLog();
+        disconnectBookingServer();
+        return 1;
+    }
+    startTicketSpooler(TICKET_SPOOL_DIR);
+
     // Show the "Welcome" Intro Screen
     showSplashScreen();
 
     int systemRunning = 1;
+    int purchaseSession = 0; // Owner ID for seat holds (one per purchase)
 
     // 2. MAIN SYSTEM LOOP
     // This keeps the application open until "Exit System" is chosen
@@ -30,6 +142,13 @@ int main() {
         if (role == 3) { 
             systemRunning = 0;
             printHeader("SHALOOM!"); // Exit Message
+            gotoxy(0, 8);
+            presentScreen();
+            stopTicketSpooler(); // Prints whatever is still queued
+            closeTicketIds();
+            stopSnapshotWriter();
+            closeSalesLog();
+            disconnectBookingServer();
             break; 
         }
 
@@ -45,39 +164,60 @@ int main() {
                 // === FLOW 1: BUY TICKETS (The Core Logic) ===
                 if (choice == 1) { 
                     
+                    // Stage timings: 'stageStart' moves forward at every boundary (see metrics.h)
+                    long long purchaseStart = getMonotonicMicros();
+                    long long stageStart = purchaseStart;
+
                     // STEP 1: SELECT SHOWTIME (V2 Feature)
-                    // We need the 'showtimeIdx' (0-3) to know WHICH seat map to load.
+                    // We need the 'showtimeIdx' to know WHICH seat map to load.
                     char selectedTime[20];
+                    reloadPricingIfChanged(); // Picks up edits to pricing.txt between customers
                     int showtimeIdx = selectShowtime(selectedTime);
+                    stageStart = markStage(STAGE_SHOWTIME, stageStart);
 
                     // STEP 2: SHOW MAP & SELECT CLASS
                     // Pass 'showtimeIdx' so we see availability for THAT specific time
                     showSeatMap(showtimeIdx);
-                    int ticketType = getTicketTypeInput(); // VIP or Regular?
+                    stageStart = markStage(STAGE_SEAT_MAP, stageStart);
+                    int ticketType = getTicketTypeInput(showtimeIdx); // VIP or Regular?
+                    stageStart = markStage(STAGE_CLASS, stageStart);
                     
                     // STEP 3: QUANTITY SELECTION
                     printHeader("TICKET COUNTER");
                     
+                    // The limit is whatever is still free in this class (no fixed cap)
+                    int maxQty = countFreeInClass(showtimeIdx, ticketType);
+                    if (maxQty == 0) {
+                        gotoxy(20, 12);
+                        screenPrintf(COLOR_RED "Sorry! This class is sold out for this showtime." COLOR_RESET);
+                        pauseExecution(2000);
+                        continue;
+                    }
+                    char qtyPrompt[50];
+                    sprintf(qtyPrompt, "How many tickets? (1-%d): ", maxQty);
+
                     // Uses coordinates (35, 9) to fix visual glitches
-                    int qty = getIntInput(35, 9, "How many tickets? (1-24): ", 1, 24);
+                    int qty = getIntInput(35, 9, qtyPrompt, 1, maxQty);
+                    stageStart = markStage(STAGE_QUANTITY, stageStart);
                     
                     // Check if enough seats exist for this Time + Class combo
                     if (!checkAvailability(qty, ticketType, showtimeIdx)) {
                         gotoxy(20, 12);
-                        printf(COLOR_RED "Sorry! Not enough seats available in this class." COLOR_RESET);
+                        screenPrintf(COLOR_RED "Sorry! Not enough seats available in this class." COLOR_RESET);
                         pauseExecution(2000);
                         continue; // Restart loop if full
                     }
 
                     // STEP 4: SEAT SELECTION METHOD
                     printDivider(14);
-                    gotoxy(30, 16); printf("1. Auto-Assign Best Seats");
-                    gotoxy(30, 17); printf("2. Select Seats Manually");
+                    gotoxy(30, 16); screenPrintf("1. Auto-Assign Best Seats");
+                    gotoxy(30, 17); screenPrintf("2. Select Seats Manually");
                     
                     int method = getIntInput(40, 19, "Choose Method > ", 1, 2);
 
-                    // Create array to hold the selected seats
-                    SeatSelection selectedSeats[24]; 
+                    // Create array to hold the selected seats (sized to the order)
+                    SeatSelection* selectedSeats = malloc(sizeof(SeatSelection) * qty);
+                    if (selectedSeats == NULL) continue;
 
                     if (method == 1) {
                         // Computer picks the best available seats automatically
@@ -86,57 +226,100 @@ int main() {
                         // User types "A1", "B2", etc. manually
                         manualSeatSelect(qty, ticketType, showtimeIdx, selectedSeats);
                     }
+                    stageStart = markStage(STAGE_SEATS, stageStart);
+
+                    // Hold the seats now so no other kiosk can sell them while we pay.
+                    // Each purchase is its own session; the hold expires if payment stalls.
+                    int session = ++purchaseSession;
+                    int holdId = holdSeats(qty, selectedSeats, showtimeIdx, session);
+                    stageStart = markStage(STAGE_HOLD, stageStart);
+                    if (holdId < 0) {
+                        printHeader("TICKET COUNTER");
+                        printCentered(12, "Sorry! Another kiosk just took one of those seats.", COLOR_RED);
+                        pauseExecution(2000);
+                        free(selectedSeats);
+                        continue;
+                    }
                     
                     // STEP 5: CONCESSIONS / EXTRAS
                     // Ask user if they want to buy food/drinks
                     printHeader("EXTRAS");
                     printCentered(12, "Would you like to visit the Concession Stand?", COLOR_CYAN);
-                    gotoxy(37, 14); printf(COLOR_WHITE "1. Yes (Buy Food/Drinks)" COLOR_RESET);
-                    gotoxy(37, 15); printf(COLOR_WHITE "2. No (Proceed to Checkout)" COLOR_RESET);
+                    gotoxy(37, 14); screenPrintf(COLOR_WHITE "1. Yes (Buy Food/Drinks)" COLOR_RESET);
+                    gotoxy(37, 15); screenPrintf(COLOR_WHITE "2. No (Proceed to Checkout)" COLOR_RESET);
                     
                     int wantSnacks = getIntInput(41, 17, "Select > ", 1, 2);
                     
-                    float snacksTotal = 0.0;
+                    // The order holds the picked items (already taken from stock)
+                    ConcessionOrder extras;
+                    startOrder(&extras);
+                    Money snacksTotal = 0;
                     if (wantSnacks == 1) {
                         // Opens the Concession Menu and returns total cost of snacks
-                        snacksTotal = buyConcessions();
+                        snacksTotal = buyConcessions(&extras);
                     }
+                    stageStart = markStage(STAGE_CONCESSIONS, stageStart);
 
                     // STEP 6: CALCULATION
-                    float ticketTotal = 0;
-                    float total;
+                    // Seats are priced from the compiled table (pricing.h): one lookup each
+                    priceSeats(qty, selectedSeats, showtimeIdx, askPromoCode());
+                    Money ticketTotal = 0;
                     int i;
-                    // Sum up ticket prices (VIP might be 700, Reg 450)
+                    // Sum up ticket prices
                     for(i=0; i<qty; i++) ticketTotal += selectedSeats[i].price;
                     
                     // Grand Total = Tickets + Popcorn/Drinks
-                    float grandTotal = ticketTotal + snacksTotal;
+                    Money grandTotal = ticketTotal + snacksTotal;
                     
                     // STEP 7: PAYMENT GATEWAY
-                    if (processPayment(grandTotal)) {
+                    int paid = processPayment(grandTotal);
+                    stageStart = markStage(STAGE_PAYMENT, stageStart);
+                    if (paid) {
                         // If payment success:
                         
-                        // A. Print Tickets (Animation Loop)
-                        int i;
-                        for (i = 0; i < qty; i++) {
-                            // Pass 'selectedTime' so the ticket prints "10:30 AM" etc.
-                            generateTicket(selectedSeats[i], i+1, qty, selectedTime);
-                            pauseExecution(3000); // Wait 3s to simulate printing
+                        // A. Finalize Data (Turn the held seats into Sold seats)
+                        int committed = commitHeldSeats(holdId, session, qty, selectedSeats, showtimeIdx);
+                        stageStart = markStage(STAGE_COMMIT, stageStart);
+                        if (!committed) {
+                            // The hold ran out and another kiosk sold the seats meanwhile
+                            printHeader("PAYMENT GATEWAY");
+                            printCentered(12, "Your seat hold expired and the seats were sold.", COLOR_RED);
+                            printCentered(13, "Please see the cashier for a refund.", COLOR_YELLOW);
+                            pauseExecution(3000);
+                            cancelOrder(&extras); // Refunded: the snacks go back on the shelf
+                            free(selectedSeats);
+                            continue;
                         }
-                        
-                        // B. Finalize Data (Mark seats as Sold in memory)
-                        markSeatsSold(qty, selectedSeats, showtimeIdx);
-                        
-                        // C. Save to File (For Admin Sales Log)
-                        saveTransaction(qty, grandTotal);
+
+                        // B. Save to File (For Admin Sales Log)
+                        // Done before printing so a crash mid-print cannot lose the sale
+                        int logged = saveTransactionOrRefund(showtimeIdx, qty, selectedSeats, ticketTotal, &extras);
+                        stageStart = markStage(STAGE_SAVE, stageStart);
+                        if (!logged) {
+                            cancelOrder(&extras); // Refunded: the snacks go back on the shelf
+                            free(selectedSeats);
+                            continue;
+                        }
+
+                        // C. Print Tickets (queued; the spooler writes them in the background)
+                        // Pass 'selectedTime' so the ticket prints "10:30 AM" etc.
+                        spoolTickets(showtimeIdx, qty, selectedSeats, selectedTime);
+                        stageStart = markStage(STAGE_TICKETS, stageStart);
                         
                         // D. Show Receipt (Lists seats + snack total)
-                        showTransactionSummary(qty, selectedSeats, ticketTotal, snacksTotal);
+                        showTransactionSummary(qty, selectedSeats, ticketTotal, &extras);
+                        markStage(STAGE_SUMMARY, stageStart);
+                        markStage(STAGE_PURCHASE, purchaseStart);
                         
                     } else {
-                        printf(COLOR_RED "\n  [Transaction Cancelled]\n" COLOR_RESET);
+                        // Give the held seats back to the other kiosks right away
+                        releaseHeldSeats(holdId, session);
+                        cancelOrder(&extras);
+                        screenPrintf(COLOR_RED "\n  [Transaction Cancelled]\n" COLOR_RESET);
                         pauseExecution(1500);
                     }
+
+                    free(selectedSeats);
                     
                 } 
                 // === FLOW 2: MOVIE INFO ===
@@ -166,9 +349,16 @@ int main() {
                 while (adminActive) {
                     int choice = showAdminMenu();
                     
-                    if (choice == 1) viewSalesLog();      // Read sales_log.txt
+                    // Thin client: the log tools run on the server machine
+                    if (isRemoteKiosk() && choice <= 4) viewServerSales();
+                    else if (choice == 1) viewSalesLog();      // Read sales_log.bin
                     else if (choice == 2) performCashout(); // Archive logs and clear drawer
-                    else if (choice == 3) adminActive = 0;  // Logout
+                    else if (choice == 3) exportSalesLog(); // Readable copy of the binary log
+                    else if (choice == 4) viewArchives();   // Closed shifts (indexed)
+                    else if (choice == 5) viewPipelineMetrics(); // Where purchase time goes
+                    else if (choice == 6) sellGroupBooking(++purchaseSession); // Block sales
+                    else if (choice == 7) checkTicketsAtDoor(); // Usher: validate & admit
+                    else if (choice == 8) adminActive = 0;  // Logout
                 }
             }
         }
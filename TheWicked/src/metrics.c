@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "metrics.h"
+#include "utilities.h"
+
+// One histogram: the bucket counters plus exact count / sum / min / max.
+// Updated with relaxed atomics so a future second thread (e.g. a network
+// kiosk) can record too; readers only ever need approximate snapshots.
+typedef struct {
+    unsigned long long buckets[LATENCY_BUCKETS];
+    unsigned long long count;
+    unsigned long long totalUs;
+    long long minPlusOne;  // Smallest value + 1 (0 = nothing recorded yet)
+    long long maxUs;
+} LatencyHistogram;
+
+static LatencyHistogram histograms[METRIC_COUNT];
+
+static const char* metricNames[METRIC_COUNT] = {
+    "Select Showtime", "Seat Map", "Ticket Class", "Quantity", "Seat Selection",
+    "Seat Hold", "Concessions", "Payment", "Commit Seats", "Save To Log",
+    "Print Tickets", "Receipt", "WHOLE PURCHASE",
+    "Screen Render", "Animation Waits"
+};
+
+// ---------------------------------------------------------
+// BUCKET MATH
+// ---------------------------------------------------------
+
+// Function: bucketIndex
+// Purpose: Values below 8 us get a bucket each; above that, the top
+// bit picks the power of two and the next 3 bits pick the slice.
+static int bucketIndex(long long micros) {
+    if (micros < LATENCY_SUB_BUCKETS) return (micros < 0) ? 0 : (int)micros;
+    int top = 63 - __builtin_clzll((unsigned long long)micros);   // Highest set bit (>= 3)
+    int slice = (int)((micros >> (top - 3)) & (LATENCY_SUB_BUCKETS - 1));
+    int index = (top - 2) * LATENCY_SUB_BUCKETS + slice;
+    return (index < LATENCY_BUCKETS) ? index : LATENCY_BUCKETS - 1;
+}
+
+// Function: bucketLow
+// Purpose: Smallest value that lands in a bucket.
+static long long bucketLow(int index) {
+    if (index < LATENCY_SUB_BUCKETS) return index;
+    int top = index / LATENCY_SUB_BUCKETS + 2;
+    int slice = index % LATENCY_SUB_BUCKETS;
+    return (long long)(LATENCY_SUB_BUCKETS + slice) << (top - 3);
+}
+
+// Function: bucketHigh
+// Purpose: First value past the end of a bucket.
+static long long bucketHigh(int index) {
+    if (index < LATENCY_SUB_BUCKETS) return index + 1;
+    int top = index / LATENCY_SUB_BUCKETS + 2;
+    return bucketLow(index) + (1LL << (top - 3));
+}
+
+// ---------------------------------------------------------
+// RECORDING
+// ---------------------------------------------------------
+
+// Function: recordLatency
+void recordLatency(int metric, long long micros) {
+    if (metric < 0 || metric >= METRIC_COUNT) return;
+    LatencyHistogram* h = &histograms[metric];
+    if (micros < 0) micros = 0;
+
+    __atomic_fetch_add(&h->buckets[bucketIndex(micros)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->totalUs, (unsigned long long)micros, __ATOMIC_RELAXED);
+
+    // Min / max: retry only if another thread moved them meanwhile.
+    // 'count' goes last so a reader that sees count > 0 also sees min/max.
+    long long seen = __atomic_load_n(&h->maxUs, __ATOMIC_RELAXED);
+    while (micros > seen && !__atomic_compare_exchange_n(&h->maxUs, &seen, micros, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) { }
+    seen = __atomic_load_n(&h->minPlusOne, __ATOMIC_RELAXED);
+    while ((seen == 0 || micros + 1 < seen) && !__atomic_compare_exchange_n(&h->minPlusOne, &seen, micros + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) { }
+    __atomic_fetch_add(&h->count, 1, __ATOMIC_RELEASE);
+}
+
+// Function: markStage
+long long markStage(int metric, long long since) {
+    long long now = getMonotonicMicros();
+    recordLatency(metric, now - since);
+    return now;
+}
+
+// ---------------------------------------------------------
+// READING
+// ---------------------------------------------------------
+
+// Function: getMetricName
+const char* getMetricName(int metric) {
+    if (metric < 0 || metric >= METRIC_COUNT) return "?";
+    return metricNames[metric];
+}
+
+// Function: getLatencySummary
+// Purpose: Copies the counters and walks the buckets once for the percentiles.
+void getLatencySummary(int metric, LatencySummary* out) {
+    memset(out, 0, sizeof(*out));
+    if (metric < 0 || metric >= METRIC_COUNT) return;
+    LatencyHistogram* h = &histograms[metric];
+
+    out->count = (long long)__atomic_load_n(&h->count, __ATOMIC_ACQUIRE);
+    if (out->count == 0) return;
+    out->totalUs = (long long)__atomic_load_n(&h->totalUs, __ATOMIC_RELAXED);
+    out->minUs = __atomic_load_n(&h->minPlusOne, __ATOMIC_RELAXED) - 1;
+    out->maxUs = __atomic_load_n(&h->maxUs, __ATOMIC_RELAXED);
+
+    // Ranks of the percentiles (nearest rank, 1-based)
+    long long rank50 = (out->count * 50 + 99) / 100;
+    long long rank90 = (out->count * 90 + 99) / 100;
+    long long rank99 = (out->count * 99 + 99) / 100;
+    long long seen = 0;
+    int i, found50 = 0, found90 = 0;
+    for(i = 0; i < LATENCY_BUCKETS && seen < rank99; i++) {
+        unsigned long long n = __atomic_load_n(&h->buckets[i], __ATOMIC_RELAXED);
+        if (n == 0) continue;
+        seen += (long long)n;
+        // Upper bucket edge, but never past the largest value actually seen
+        long long edge = bucketHigh(i) - 1;
+        if (edge > out->maxUs) edge = out->maxUs;
+        if (!found50 && seen >= rank50) { out->p50Us = edge; found50 = 1; }
+        if (!found90 && seen >= rank90) { out->p90Us = edge; found90 = 1; }
+        if (seen >= rank99) out->p99Us = edge;
+    }
+}
+
+// Function: formatLatency
+void formatLatency(long long micros, char* buffer, int size) {
+    if (micros < 1000) snprintf(buffer, size, "%lld us", micros);
+    else if (micros < 1000000) snprintf(buffer, size, "%.1f ms", micros / 1000.0);
+    else snprintf(buffer, size, "%.2f s", micros / 1000000.0);
+}
+
+// Function: dumpMetrics
+// Purpose: Human-readable report; written under a temporary name and
+// renamed into place so a reader never sees half a report.
+int dumpMetrics(const char* path) {
+    char tmpPath[256];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    FILE* f = fopen(tmpPath, "w");
+    if (f == NULL) return 0;
+
+    time_t now = time(NULL);
+    fprintf(f, "# THE WICKED GOOD - purchase pipeline timings, %s", ctime(&now));
+    fprintf(f, "# Times in microseconds. Percentiles are bucket upper edges (<= 12.5%% high).\n\n");
+    fprintf(f, "%-16s %10s %12s %12s %12s %12s %12s %12s\n",
+            "stage", "count", "mean", "min", "p50", "p90", "p99", "max");
+
+    int m, i;
+    for(m = 0; m < METRIC_COUNT; m++) {
+        LatencySummary s;
+        getLatencySummary(m, &s);
+        fprintf(f, "%-16s %10lld %12lld %12lld %12lld %12lld %12lld %12lld\n",
+                getMetricName(m), s.count, s.count ? s.totalUs / s.count : 0,
+                s.minUs, s.p50Us, s.p90Us, s.p99Us, s.maxUs);
+    }
+
+    // Raw buckets, so the numbers can be re-analysed elsewhere
+    for(m = 0; m < METRIC_COUNT; m++) {
+        if (__atomic_load_n(&histograms[m].count, __ATOMIC_ACQUIRE) == 0) continue;
+        fprintf(f, "\n[%s]\n", getMetricName(m));
+        for(i = 0; i < LATENCY_BUCKETS; i++) {
+            unsigned long long n = __atomic_load_n(&histograms[m].buckets[i], __ATOMIC_RELAXED);
+            if (n > 0) fprintf(f, "%lld-%lld %llu\n", bucketLow(i), bucketHigh(i) - 1, n);
+        }
+    }
+
+    int ok = (fflush(f) == 0);
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || !replaceFileAtomically(tmpPath, path)) {
+        remove(tmpPath);
+        return 0;
+    }
+    return 1;
+}
+
+// Function: resetMetrics
+void resetMetrics() {
+    int m, i;
+    for(m = 0; m < METRIC_COUNT; m++) {
+        LatencyHistogram* h = &histograms[m];
+        __atomic_store_n(&h->count, 0, __ATOMIC_RELEASE);
+        for(i = 0; i < LATENCY_BUCKETS; i++) __atomic_store_n(&h->buckets[i], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&h->totalUs, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&h->minPlusOne, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&h->maxUs, 0, __ATOMIC_RELAXED);
+    }
+}
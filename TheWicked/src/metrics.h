@@ -0,0 +1,70 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+// ---------------------------------------------------------
+// PURCHASE PIPELINE TIMINGS
+// ---------------------------------------------------------
+// Every stage of a purchase (and the screen / animation / disk work
+// underneath) feeds one latency histogram. A histogram is a fixed array
+// of counters, so recording a value is one clock read plus an atomic add
+// and memory never grows, however long the kiosk runs.
+//
+// Buckets are log-linear: each power of two (1-2 us, 2-4 us, 4-8 us, ...)
+// is split into 8 equal slices, so every bucket is at most 12.5% wide
+// from a microsecond up to days. Percentiles are read from the buckets.
+#define METRICS_FILE "pipeline_metrics.txt"
+
+// Purchase stages (main.c), in the order a customer goes through them
+#define STAGE_SHOWTIME    0   // selectShowtime
+#define STAGE_SEAT_MAP    1   // showSeatMap
+#define STAGE_CLASS       2   // getTicketTypeInput
+#define STAGE_QUANTITY    3   // How many tickets
+#define STAGE_SEATS       4   // Auto-assign / manual seat selection
+#define STAGE_HOLD        5   // holdSeats
+#define STAGE_CONCESSIONS 6   // Extras question + buyConcessions
+#define STAGE_PAYMENT     7   // processPayment
+#define STAGE_COMMIT      8   // commitHeldSeats (seats marked sold)
+#define STAGE_SAVE        9   // saveTransaction (durable log write)
+#define STAGE_TICKETS     10  // spoolTickets (queues the tickets for the printer)
+#define STAGE_SUMMARY     11  // showTransactionSummary
+#define STAGE_PURCHASE    12  // Whole purchase, showtime to receipt
+// Work underneath the stages
+#define METRIC_RENDER     13  // presentScreen (diff + terminal write)
+#define METRIC_ANIMATION  14  // pauseExecution (hard-coded waits)
+#define METRIC_COUNT      15
+
+#define LATENCY_SUB_BUCKETS 8                          // Slices per power of two
+#define LATENCY_BUCKETS (LATENCY_SUB_BUCKETS * 40)     // Up to 2^42 us (~50 days)
+
+// Summary of one histogram (all times in microseconds).
+typedef struct {
+    long long count;
+    long long totalUs;
+    long long minUs, maxUs;
+    long long p50Us, p90Us, p99Us;
+} LatencySummary;
+
+// Adds one measurement.
+void recordLatency(int metric, long long micros);
+
+// Stage boundary: records (now - since) and returns now, so consecutive
+// stages chain as  t = markStage(STAGE_A, t); ... t = markStage(STAGE_B, t);
+long long markStage(int metric, long long since);
+
+// Display name of a metric ("Seat Map", "Payment", ...).
+const char* getMetricName(int metric);
+
+// Reads one histogram. Percentiles are the upper edge of their bucket.
+void getLatencySummary(int metric, LatencySummary* out);
+
+// Formats a duration for a table cell, e.g. "840 us", "12.4 ms", "3.02 s".
+void formatLatency(long long micros, char* buffer, int size);
+
+// Writes every summary plus the non-empty buckets to a text file.
+// Returns: 1 on success, 0 on I/O error.
+int dumpMetrics(const char* path);
+
+// Empties every histogram.
+void resetMetrics();
+
+#endif
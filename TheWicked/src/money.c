@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <ctype.h>
+#include "money.h"
+
+// Function: formatMoney
+// Purpose: Splits the centavos into pesos and the two decimals. The sign
+// is printed separately so "-0.50" does not lose its minus.
+void formatMoney(Money amount, char* buffer, size_t size) {
+    const char* sign = (amount < 0) ? "-" : "";
+    unsigned long long magnitude = (amount < 0) ? 0ULL - (unsigned long long)amount : (unsigned long long)amount;
+    snprintf(buffer, size, "%s%llu.%02llu", sign, magnitude / CENTAVOS_PER_PESO, magnitude % CENTAVOS_PER_PESO);
+}
+
+// Function: parseMoney
+// Purpose: Decimal text -> centavos, digit by digit. strtod() would go
+// through binary floating point and back (and is slower than this loop).
+int parseMoney(const char* text, Money* out) {
+    const char* p = text;
+    Money pesos = 0, centavos = 0;
+    int negative = 0, digits = 0, decimals = 0, pesoDigits = 0;
+
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p == '-' || *p == '+') negative = (*p++ == '-');
+
+    while (isdigit((unsigned char)*p)) {
+        // More digits would overflow the 64-bit centavos (and no one pays that)
+        if (pesos > 0 && ++pesoDigits == MAX_PESO_DIGITS) { *out = 0; return 0; }
+        pesos = pesos * 10 + (*p++ - '0');
+        digits++;
+    }
+    if (*p == '.') {
+        p++;
+        while (isdigit((unsigned char)*p)) {
+            if (decimals < 2) { centavos = centavos * 10 + (*p - '0'); decimals++; }
+            p++;
+            digits++;
+        }
+    }
+    if (digits == 0) { *out = 0; return 0; }
+
+    if (decimals == 1) centavos *= 10; // "450.5" = 450.50
+    *out = (pesos * CENTAVOS_PER_PESO + centavos) * (negative ? -1 : 1);
+    return (int)(p - text);
+}
+
+// Function: nonNegativeMoney
+// Purpose: 'amount >> 63' is all ones for a negative amount (arithmetic
+// shift on GCC / MinGW), so the mask clears it to 0 and keeps the rest.
+Money nonNegativeMoney(Money amount) {
+    return amount & ~(amount >> 63);
+}
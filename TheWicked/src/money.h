@@ -0,0 +1,39 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <stddef.h>
+
+// ---------------------------------------------------------
+// MONEY
+// ---------------------------------------------------------
+// Every amount in the system is a whole number of centavos in a 64-bit
+// integer (PHP 450.00 = 45000). Sums are exact however many sales a day
+// brings, and they are the very numbers the sales records store
+// (see salesrec.h), so nothing is converted on the way to the log.
+typedef long long Money;
+
+#define CENTAVOS_PER_PESO 100
+#define PESOS(whole) ((Money)(whole) * CENTAVOS_PER_PESO)   // PESOS(450) = 45000
+#define MAX_PESO_DIGITS 13   // parseMoney() limit: up to PHP 9,999,999,999,999.99
+
+// printf() helpers for amounts that are never negative (prices, totals):
+//   screenPrintf("PHP " PESO_FORMAT, PESO_ARGS(total));
+#define PESO_FORMAT "%lld.%02lld"
+#define PESO_ARGS(amount) (long long)((amount) / CENTAVOS_PER_PESO), (long long)((amount) % CENTAVOS_PER_PESO)
+
+// Room for any amount formatMoney() writes ("-92233720368547758.08").
+#define MONEY_TEXT_MAX 24
+
+// Writes an amount as "1234.50" (negative: "-12.05").
+void formatMoney(Money amount, char* buffer, size_t size);
+
+// Reads "450", "450.5", "450.50" or "-1" with integer arithmetic only
+// (digits after the second decimal are ignored, not rounded).
+// Returns: Characters read (0 = no amount there, or more than
+// MAX_PESO_DIGITS peso digits); the amount goes to *out.
+int parseMoney(const char* text, Money* out);
+
+// Negative amounts become 0 (without a branch): what is still owed.
+Money nonNegativeMoney(Money amount);
+
+#endif
@@ -8,8 +8,8 @@
 // ---------------------------------------------------------
 // Note: This is a legacy helper. The main logic now calculates totals 
 // dynamically in main.c based on seat types (VIP/Regular) + Snacks.
-float calculateTotal(int ticketCount) {
-    return ticketCount * 12.50; 
+Money calculateTotal(int ticketCount) {
+    return ticketCount * TICKET_PRICE; 
 }
 
 // ---------------------------------------------------------
@@ -18,25 +18,22 @@ float calculateTotal(int ticketCount) {
 // This handles the "Cash Register" experience.
 // It loops until the user pays enough money.
 // Returns: 1 if successful, 0 if cancelled.
-int processPayment(float totalAmount) {
-    float payment = 0.0; // How much the user has put in so far
-    float input = 0.0;   // The specific bill/coin just entered
+int processPayment(Money totalAmount) {
+    Money payment = 0;   // How much the user has put in so far (centavos)
+    Money input = 0;     // The specific bill/coin just entered
     char buffer[50];     // Temp storage for typing
 
     // 1. SETUP UI
-    // Wipe the screen to show a clean "Payment Gateway"
-    clearScreen();
+    // printHeader() starts a fresh frame, so no extra clearScreen() is needed
     printHeader("PAYMENT GATEWAY");
 
     // Format the total due message
     char msg[50];
-    sprintf(msg, "Total Due: PHP %.2f", totalAmount);
+    sprintf(msg, "Total Due: PHP " PESO_FORMAT, PESO_ARGS(totalAmount));
     
     // 2. DISPLAY TOTAL (Centered)
-    // We clear screen again briefly to ensure no overlap from previous menus
-    clearScreen();
     gotoxy(40, 9);
-    printf(COLOR_YELLOW "%s" COLOR_RESET, msg);
+    screenPrintf(COLOR_YELLOW "%s" COLOR_RESET, msg);
     printDivider(11);
 
     // 3. PAYMENT LOOP
@@ -44,20 +41,22 @@ int processPayment(float totalAmount) {
     while (payment < totalAmount) {
         // Show current status
         gotoxy(35, 13);
-        printf("Amount Paid: " COLOR_GREEN "PHP %.2f    " COLOR_RESET, payment); // Spaces needed to wipe old numbers
+        screenPrintf("Amount Paid: " COLOR_GREEN "PHP " PESO_FORMAT "    " COLOR_RESET, PESO_ARGS(payment)); // Spaces needed to wipe old numbers
         
         gotoxy(35, 14);
-        printf(COLOR_RED "Remaining: PHP %.2f    " COLOR_RESET, totalAmount - payment);
+        screenPrintf(COLOR_RED "Remaining: PHP " PESO_FORMAT "    " COLOR_RESET, PESO_ARGS(nonNegativeMoney(totalAmount - payment)));
         
         // Input Prompt
         gotoxy(35, 16);
-        printf("Enter cash (or -1 to cancel): ");
+        screenPrintf("Enter cash (or -1 to cancel): ");
         
         // Safe Input Handling
+        presentScreenForInput();
         if (fgets(buffer, sizeof(buffer), stdin) != NULL) {
-            if (sscanf(buffer, "%f", &input) == 1) {
+            // Exact decimal parse: "150.50" is 15050 centavos, never 150.4999
+            if (parseMoney(buffer, &input) > 0) {
                 // Option to cancel transaction
-                if (input == -1) return 0; 
+                if (input == -PESOS(1)) return 0; 
                 
                 // Add positive cash to the pile
                 if (input > 0) {
@@ -69,17 +68,16 @@ int processPayment(float totalAmount) {
 
     // 4. VERIFICATION ANIMATION
     // Once full amount is reached, show a "Processing" screen
-    clearScreen();
     printHeader("PAYMENT VERIFICATION");
     
     showLoadingAnimation("Verifying Bills");
     
     // 5. CALCULATE CHANGE
-    float change = payment - totalAmount;
+    Money change = payment - totalAmount;
     
     // Show Success Message
     gotoxy(32, 18);
-    printf(COLOR_GREEN "Payment Successful! Change: PHP %.2f\n" COLOR_RESET, change);
+    screenPrintf(COLOR_GREEN "Payment Successful! Change: PHP " PESO_FORMAT "\n" COLOR_RESET, PESO_ARGS(change));
     
     // Pause so the user can read the success message
     pauseExecution(1500); 
@@ -1,8 +1,10 @@
 #ifndef PAYMENTS_H
 #define PAYMENTS_H
 
+#include "money.h"
+
 // Prototypes
-float calculateTotal(int ticketCount); // With param / With return
-int processPayment(float totalAmount); // With param / With return
+Money calculateTotal(int ticketCount); // With param / With return
+int processPayment(Money totalAmount); // With param / With return (amounts in centavos)
 
 #endif
@@ -0,0 +1,379 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "pricing.h"
+#include "catalog.h"
+#include "hall.h"
+#include "inventory.h"
+
+// ---------------------------------------------------------
+// DATA STRUCTURE: The Rules
+// ---------------------------------------------------------
+// One "rule" line. Unused conditions hold their "any" value, so a rule
+// matches when every field agrees with the seat being priced.
+#define ADJUST_PERCENT 1         // price = price * (100 + amount) / 100
+#define ADJUST_ADD     2         // price = price + amount (centavos)
+#define ADJUST_SET     3         // price = amount
+
+#define RULE_ANY_CUSTOMER -1
+#define RULE_NO_TIME      -1
+
+typedef struct {
+    int classType;               // TYPE_VIP / TYPE_REG, 0 = both
+    int before;                  // Screening starts before this minute (-1 = any)
+    int from;                    // Screening starts at/after this minute (-1 = any)
+    int minBand;                 // Occupancy band at least this (0 = any)
+    int customer;                // Customer number, -1 = any
+    char film[CATALOG_ID_MAX];   // Film id ("" = any)
+    char show[CATALOG_ID_MAX];   // Showing id ("" = any)
+    int adjust;                  // ADJUST_...
+    Money amount;                // Percent (ADJUST_PERCENT) or centavos
+} PriceRule;
+
+static Money basePrices[2] = { PRICE_VIP, PRICE_REG };   // [0] = VIP, [1] = REG
+static char promoCodes[MAX_PROMO_CODES][PROMO_CODE_MAX];
+static int numPromoCodes = 0;
+static PriceRule rules[MAX_PRICE_RULES];
+static int numRules = 0;
+
+// Where the rules came from, for reloadPricingIfChanged()
+static char rulesPath[260] = "";
+static time_t rulesModified = 0;
+static long long rulesSize = -1;
+
+// ---------------------------------------------------------
+// DATA STRUCTURE: The Compiled Table
+// ---------------------------------------------------------
+// prices[((showtime * 2 + class) * PRICE_BANDS + band) * customers + customer]
+// A new table is published with one atomic pointer store, so a kiosk
+// thread pricing a seat never sees half a table. The table it replaced is
+// kept until the next compile in case a reader still holds it.
+typedef struct {
+    int showtimes;
+    int customers;               // 1 (guest) + promo codes
+    Money prices[];
+} PriceTable;
+
+static PriceTable* activeTable = NULL;
+static PriceTable* retiredTable = NULL;
+
+#define CLASS_SLOT(type) ((type) == TYPE_VIP ? 0 : 1)
+
+// ---------------------------------------------------------
+// PARSING
+// ---------------------------------------------------------
+
+// Function: upperCopy
+// Purpose: Copies a word in upper case (promo codes and classes ignore case).
+static void upperCopy(char* dest, const char* text, int size) {
+    int i;
+    for(i = 0; i < size - 1 && text[i] != '\0'; i++) dest[i] = (char)toupper((unsigned char)text[i]);
+    dest[i] = '\0';
+}
+
+// Function: parseClassWord
+// Purpose: "VIP" / "REG" (any case) to a ticket type, 0 if neither.
+static int parseClassWord(const char* text) {
+    char word[8];
+    upperCopy(word, text, sizeof(word));
+    if (strcmp(word, "VIP") == 0) return TYPE_VIP;
+    if (strcmp(word, "REG") == 0) return TYPE_REG;
+    return 0;
+}
+
+// Function: parseClock
+// Purpose: "HH:MM" to minutes after midnight, -1 if malformed.
+static int parseClock(const char* text) {
+    int hour, minute;
+    if (sscanf(text, "%d:%d", &hour, &minute) != 2) return -1;
+    if (hour < 0 || hour > 24 || minute < 0 || minute > 59) return -1;
+    return hour * 60 + minute;
+}
+
+// Function: findCode
+// Purpose: Customer number of an upper-case promo code among the first 'count'.
+static int findCode(const char codes[][PROMO_CODE_MAX], int count, const char* code) {
+    int i;
+    for(i = 0; i < count; i++) {
+        if (strcmp(codes[i], code) == 0) return i + 1;
+    }
+    return -1;
+}
+
+// Function: parseAdjustment
+// Purpose: "+10%", "-25.50", "=800" into the rule.
+// Returns: 1 if valid.
+static int parseAdjustment(const char* text, PriceRule* rule) {
+    char sign = text[0];
+    if (sign != '+' && sign != '-' && sign != '=') return 0;
+
+    size_t length = strlen(text);
+    if (text[length - 1] == '%') {
+        if (sign == '=' || !isdigit((unsigned char)text[1])) return 0;
+        rule->adjust = ADJUST_PERCENT;
+        rule->amount = atoi(text + 1) * (sign == '-' ? -1 : 1);
+        if (rule->amount < -100) rule->amount = -100;
+        return 1;
+    }
+
+    Money amount;
+    if (parseMoney(text + 1, &amount) != (int)(length - 1) || amount < 0) return 0;
+    rule->adjust = (sign == '=') ? ADJUST_SET : ADJUST_ADD;
+    rule->amount = (sign == '-') ? -amount : amount;
+    return 1;
+}
+
+// Function: parseRule
+// Purpose: Reads the words after "rule" (cut up in place).
+// Returns: 1 if valid.
+static int parseRule(char* text, PriceRule* rule, const char codes[][PROMO_CODE_MAX], int codeCount) {
+    memset(rule, 0, sizeof(*rule));
+    rule->before = rule->from = RULE_NO_TIME;
+    rule->customer = RULE_ANY_CUSTOMER;
+
+    char* word = strtok(text, " \t");
+    while (word != NULL && strcmp(word, ":") != 0) {
+        char* value = strtok(NULL, " \t");
+        if (strcmp(word, "guest") == 0) {
+            rule->customer = CUSTOMER_GUEST;
+            word = value;
+            continue;
+        }
+        if (value == NULL) return 0;
+
+        if (strcmp(word, "class") == 0) {
+            rule->classType = parseClassWord(value);
+            if (rule->classType == 0) return 0;
+        } else if (strcmp(word, "before") == 0) {
+            if ((rule->before = parseClock(value)) < 0) return 0;
+        } else if (strcmp(word, "from") == 0) {
+            if ((rule->from = parseClock(value)) < 0) return 0;
+        } else if (strcmp(word, "occupancy") == 0) {
+            int percent = atoi(value);
+            if (!isdigit((unsigned char)value[0]) || percent > 100) return 0;
+            rule->minBand = percent / 10;
+        } else if (strcmp(word, "promo") == 0) {
+            char code[PROMO_CODE_MAX];
+            upperCopy(code, value, sizeof(code));
+            // Codes must be declared before the rules that use them
+            if ((rule->customer = findCode(codes, codeCount, code)) < 0) return 0;
+        } else if (strcmp(word, "film") == 0) {
+            if (strlen(value) >= CATALOG_ID_MAX) return 0;
+            strcpy(rule->film, value);
+        } else if (strcmp(word, "show") == 0) {
+            if (strlen(value) >= CATALOG_ID_MAX) return 0;
+            strcpy(rule->show, value);
+        } else {
+            return 0; // Unknown condition
+        }
+        word = strtok(NULL, " \t");
+    }
+    if (word == NULL) return 0; // No ':'
+
+    char* adjustment = strtok(NULL, " \t");
+    if (adjustment == NULL || strtok(NULL, " \t") != NULL) return 0;
+    return parseAdjustment(adjustment, rule);
+}
+
+// ---------------------------------------------------------
+// COMPILING
+// ---------------------------------------------------------
+
+// Function: applyRule
+// Purpose: One adjustment to the price so far (percentages round to the centavo).
+static Money applyRule(const PriceRule* rule, Money price) {
+    switch (rule->adjust) {
+        case ADJUST_PERCENT: price = (price * (100 + rule->amount) + 50) / 100; break;
+        case ADJUST_ADD:     price += rule->amount; break;
+        default:             price = rule->amount; break;
+    }
+    return nonNegativeMoney(price);
+}
+
+// Function: compilePricing
+// Purpose: Evaluates the rules once for every table cell. The showtime
+// conditions (time, film, showing) are checked first so only the rules of
+// that screening are looped over for its 2 x 11 x customers cells.
+void compilePricing() {
+    int showtimes = getNumShowtimes();
+    int customers = 1 + numPromoCodes;
+    size_t cells = (size_t)showtimes * 2 * PRICE_BANDS * customers;
+    PriceTable* table = malloc(sizeof(PriceTable) + sizeof(Money) * cells);
+    if (table == NULL) return; // Keep the old table
+    table->showtimes = showtimes;
+    table->customers = customers;
+
+    const PriceRule* showRules[MAX_PRICE_RULES];
+    Money* cell = table->prices;
+    int t, cls, band, customer, i;
+    for(t = 0; t < showtimes; t++) {
+        const ShowingInfo* showing = getShowingInfo(t);
+        int start = (showing != NULL) ? showing->startMinute : -1;
+        int film = (showing != NULL) ? showing->film : -1;
+
+        int count = 0;
+        for(i = 0; i < numRules; i++) {
+            const PriceRule* rule = &rules[i];
+            if (rule->before >= 0 && (start < 0 || start >= rule->before)) continue;
+            if (rule->from >= 0 && (start < 0 || start < rule->from)) continue;
+            if (rule->film[0] != '\0' && (film < 0 || findFilm(rule->film) != film)) continue;
+            if (rule->show[0] != '\0' && findShowing(rule->show) != t) continue;
+            showRules[count++] = rule;
+        }
+
+        for(cls = 0; cls < 2; cls++) {
+            int type = (cls == 0) ? TYPE_VIP : TYPE_REG;
+            for(band = 0; band < PRICE_BANDS; band++) {
+                for(customer = 0; customer < customers; customer++) {
+                    Money price = basePrices[cls];
+                    for(i = 0; i < count; i++) {
+                        const PriceRule* rule = showRules[i];
+                        if (rule->classType != 0 && rule->classType != type) continue;
+                        if (band < rule->minBand) continue;
+                        if (rule->customer != RULE_ANY_CUSTOMER && rule->customer != customer) continue;
+                        price = applyRule(rule, price);
+                    }
+                    *cell++ = price;
+                }
+            }
+        }
+    }
+
+    PriceTable* old = __atomic_exchange_n(&activeTable, table, __ATOMIC_ACQ_REL);
+    free(retiredTable);
+    retiredTable = old;
+}
+
+// ---------------------------------------------------------
+// LOADING
+// ---------------------------------------------------------
+
+// Function: loadPricing
+// Purpose: Parses the whole file into scratch copies; the rules in use
+// are replaced only if every line is valid. Compiles the table either way
+// (the schedule may be new even if the rules are not).
+int loadPricing(const char* path) {
+    snprintf(rulesPath, sizeof(rulesPath), "%s", path);
+    struct stat info;
+    if (stat(path, &info) == 0) {
+        rulesModified = info.st_mtime;
+        rulesSize = (long long)info.st_size;
+    }
+
+    FILE* f = fopen(path, "r");
+    if (f == NULL) { compilePricing(); return 0; }
+
+    Money newBase[2] = { PRICE_VIP, PRICE_REG };
+    char newCodes[MAX_PROMO_CODES][PROMO_CODE_MAX];
+    PriceRule newRules[MAX_PRICE_RULES];
+    int codeCount = 0, ruleCount = 0;
+    int valid = 1;
+    char line[512];
+
+    while (valid && fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n#")] = '\0';
+        char* p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0') continue;
+
+        if (strncmp(p, "base ", 5) == 0) {
+            char classWord[8], amount[32];
+            Money price;
+            int type;
+            if (sscanf(p + 5, "%7s %31s", classWord, amount) != 2 ||
+                (type = parseClassWord(classWord)) == 0 ||
+                parseMoney(amount, &price) != (int)strlen(amount) || price < 0) { valid = 0; break; }
+            newBase[CLASS_SLOT(type)] = price;
+        }
+        else if (strncmp(p, "promo ", 6) == 0) {
+            char code[PROMO_CODE_MAX * 2];
+            if (codeCount >= MAX_PROMO_CODES || sscanf(p + 6, "%31s", code) != 1 ||
+                strlen(code) >= PROMO_CODE_MAX) { valid = 0; break; }
+            upperCopy(newCodes[codeCount], code, PROMO_CODE_MAX);
+            if (findCode(newCodes, codeCount, newCodes[codeCount]) >= 0) { valid = 0; break; }
+            codeCount++;
+        }
+        else if (strncmp(p, "rule ", 5) == 0) {
+            if (ruleCount >= MAX_PRICE_RULES ||
+                !parseRule(p + 5, &newRules[ruleCount], newCodes, codeCount)) { valid = 0; break; }
+            ruleCount++;
+        }
+        else {
+            valid = 0; // Unknown directive
+        }
+    }
+    fclose(f);
+
+    if (valid) {
+        memcpy(basePrices, newBase, sizeof(basePrices));
+        memcpy(promoCodes, newCodes, sizeof(newCodes[0]) * codeCount);
+        numPromoCodes = codeCount;
+        memcpy(rules, newRules, sizeof(PriceRule) * ruleCount);
+        numRules = ruleCount;
+    }
+    compilePricing();
+    return valid;
+}
+
+// Function: reloadPricingIfChanged
+// Purpose: One stat() per purchase; the file is parsed only after an edit
+// (a broken edit is reported once, not re-read at every purchase).
+int reloadPricingIfChanged() {
+    struct stat info;
+    if (rulesPath[0] == '\0' || stat(rulesPath, &info) != 0) return 0;
+    if (info.st_mtime == rulesModified && (long long)info.st_size == rulesSize) return 0;
+    return loadPricing(rulesPath);
+}
+
+// ---------------------------------------------------------
+// PUBLIC API
+// ---------------------------------------------------------
+
+int findPromoCode(const char* code) {
+    char upper[PROMO_CODE_MAX];
+    if (strlen(code) >= PROMO_CODE_MAX) return -1;
+    upperCopy(upper, code, sizeof(upper));
+    return findCode(promoCodes, numPromoCodes, upper);
+}
+
+int getNumPromoCodes() {
+    return numPromoCodes;
+}
+
+// Function: getOccupancyBand
+// Purpose: Sold share of all real seats, rounded down to 10%.
+int getOccupancyBand(int showtimeIndex) {
+    int capacity = getClassCapacity(showtimeIndex, TYPE_VIP) + getClassCapacity(showtimeIndex, TYPE_REG);
+    if (capacity <= 0) return 0;
+    return countSoldInShowtime(showtimeIndex) * (PRICE_BANDS - 1) / capacity;
+}
+
+// Function: lookupSeatPrice
+// Purpose: The hot path. Without a table for this showtime (a schedule
+// installed without compilePricing, e.g. by the benchmark) the base price is used.
+Money lookupSeatPrice(int showtimeIndex, int type, int band, int customer) {
+    const PriceTable* table = __atomic_load_n(&activeTable, __ATOMIC_ACQUIRE);
+    if (table == NULL || showtimeIndex >= table->showtimes || customer >= table->customers) {
+        return basePrices[CLASS_SLOT(type)];
+    }
+    return table->prices[((showtimeIndex * 2 + CLASS_SLOT(type)) * PRICE_BANDS + band) * table->customers + customer];
+}
+
+Money currentSeatPrice(int showtimeIndex, int type, int customer) {
+    return lookupSeatPrice(showtimeIndex, type, getOccupancyBand(showtimeIndex), customer);
+}
+
+Money getBasePrice(int type) {
+    return basePrices[CLASS_SLOT(type)];
+}
+
+void priceSeats(int qty, SeatSelection* seats, int showtimeIndex, int customer) {
+    int band = getOccupancyBand(showtimeIndex);
+    int i;
+    for(i = 0; i < qty; i++) {
+        seats[i].price = lookupSeatPrice(showtimeIndex, seats[i].type, band, customer);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef PRICING_H
+#define PRICING_H
+
+#include "money.h"
+#include "tickets.h"
+
+// ---------------------------------------------------------
+// DYNAMIC PRICING
+// ---------------------------------------------------------
+// Ticket prices come from a small rules file (see pricing.txt) instead of
+// the two fixed class prices:
+//
+//   base  <VIP|REG> <pesos>
+//   promo <CODE>
+//   rule  <conditions> : <adjustment>
+//
+// Conditions (all must hold; none = every seat):
+//   class VIP|REG     before HH:MM    from HH:MM     (start of the screening)
+//   occupancy <N>     (N% of the hall or more is sold, in steps of 10%)
+//   film <id>         show <id>       (catalog ids, see catalog.h)
+//   promo <CODE>      guest           (with that code / without any code)
+// Adjustments: "+10%", "-15%", "+50", "-25.50" (pesos) or "=800" (set).
+// The rules are applied in file order, each one to the price so far;
+// a price never goes below zero.
+//
+// The rules are NOT evaluated while selling. Whenever they (or the
+// schedule) change, they are compiled into one flat table with a price for
+// every (showtime, class, occupancy band, customer) combination, so the
+// booking path prices a seat with a single array lookup.
+#define PRICING_FILE "pricing.txt"
+
+#define PRICE_BANDS 11           // Occupancy 0-9%, 10-19%, ... 90-99%, 100%
+#define MAX_PROMO_CODES 15
+#define MAX_PRICE_RULES 64
+#define PROMO_CODE_MAX 16        // Longest promo code (with the '\0')
+
+#define CUSTOMER_GUEST 0         // No promo code; code N is customer N
+
+// Reads the rules file and compiles the price table for the current
+// schedule. A missing or invalid file keeps the rules already loaded
+// (at startup: PRICE_VIP / PRICE_REG for every seat).
+// Returns: 1 if the file was loaded, 0 if not.
+int loadPricing(const char* path);
+
+// Recompiles the price table after the schedule changed (same rules).
+void compilePricing();
+
+// Loads the rules file again if it was edited since it was last read.
+// Cheap enough to call at the start of every purchase.
+// Returns: 1 if new rules are now in use.
+int reloadPricingIfChanged();
+
+// Customer number of a promo code (any case), or -1 if the code is unknown.
+int findPromoCode(const char* code);
+
+// Number of promo codes in the rules (0 = don't ask for one).
+int getNumPromoCodes();
+
+// Occupancy band of a showtime right now (sold seats, in steps of 10%).
+int getOccupancyBand(int showtimeIndex);
+
+// Price of one seat of class 'type' (TYPE_VIP / TYPE_REG): one table lookup.
+Money lookupSeatPrice(int showtimeIndex, int type, int band, int customer);
+
+// Price of a class for a customer with the showtime as full as it is now
+// (the menus; the band is read once per call).
+Money currentSeatPrice(int showtimeIndex, int type, int customer);
+
+// Base price of a class, before any rule.
+Money getBasePrice(int type);
+
+// Prices every selected seat for this customer (the band is read once).
+void priceSeats(int qty, SeatSelection* seats, int showtimeIndex, int customer);
+
+#endif
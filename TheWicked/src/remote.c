@@ -0,0 +1,372 @@
+// Request POSIX declarations (sockets) in strict C99 mode.
+// Must come before the first system header.
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "remote.h"
+#include "server.h"
+#include "tickets.h"
+#include "hall.h"
+#include "inventory.h"
+#include "feed.h"
+#include "concessions.h"
+#include "ticketid.h"
+#include "utilities.h"
+
+#ifdef _WIN32
+    // No socket layer on Windows builds yet: --connect reports failure.
+    #define send(fd, data, length, flags) (-1)
+    #define recv(fd, data, length, flags) (-1)
+    #define close(fd) ((void)(fd))
+    #define MSG_NOSIGNAL 0
+#else
+    #include <errno.h>
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+#endif
+
+static int serverFd = -1;
+static int remoteMode = 0;                // Sticky: set by connectBookingServer
+static char serverAddress[256];           // For reconnecting
+
+// Key of the sale being saved: "<kiosk>-<session>-<number>". It stays the
+// same while a SAVE's outcome is unknown, so the retry cannot log it twice.
+static long long saleSession = 0;         // Epoch microseconds of the first SAVE
+static unsigned long saleNumber = 0;
+static int saleKeyOpen = 0;               // Last SAVE got no answer: retry with its key
+static char requestLine[SERVER_LINE_MAX];
+static char replyLine[SERVER_LINE_MAX];
+static char received[SERVER_LINE_MAX];   // Bytes read past the last reply
+static int receivedLen = 0;
+
+// Feed position of each mirrored showtime (valid when haveMap is set)
+static unsigned long long mirrorSeq[MAX_SHOWTIMES];
+static char haveMap[MAX_SHOWTIMES];
+
+static int openConnection();
+
+// ---------------------------------------------------------
+// REQUEST / REPLY
+// ---------------------------------------------------------
+
+// Function: dropConnection
+// Purpose: Closes a broken or silent connection. The kiosk stays a thin
+// client: the next request reconnects, or fails if the server is still gone.
+static void dropConnection() {
+    if (serverFd >= 0) close(serverFd);
+    serverFd = -1;
+    receivedLen = 0;
+    memset(haveMap, 0, sizeof(haveMap));
+}
+
+// Function: sendAll
+static int sendAll(const char* data, int length) {
+    while (length > 0) {
+        int n = (int)send(serverFd, data, length, MSG_NOSIGNAL);
+        if (n <= 0) return 0;
+        data += n;
+        length -= n;
+    }
+    return 1;
+}
+
+// Function: readLine
+// Purpose: Next line from the server into 'replyLine'.
+// Returns: 1 on success, 0 if the connection was lost or timed out.
+static int readLine() {
+    while (1) {
+        char* newline = memchr(received, '\n', receivedLen);
+        if (newline != NULL) {
+            int lineLen = (int)(newline - received);
+            memcpy(replyLine, received, lineLen);
+            replyLine[lineLen] = '\0';
+            receivedLen -= lineLen + 1;
+            memmove(received, newline + 1, receivedLen);
+            return 1;
+        }
+        if (receivedLen == SERVER_LINE_MAX) { dropConnection(); return 0; }
+
+        int n = (int)recv(serverFd, received + receivedLen, SERVER_LINE_MAX - receivedLen, 0);
+        if (n <= 0) {
+            #ifndef _WIN32
+                if (n < 0 && errno == EINTR) continue;
+            #endif
+            dropConnection(); // Closed, or no answer within REMOTE_TIMEOUT_MS
+            return 0;
+        }
+        receivedLen += n;
+    }
+}
+
+// Function: sendRequest
+// Purpose: Sends one request (with room for the '\n' after its '\0') and
+// reads the reply line into 'replyLine'.
+// Returns: 1 if the server answered "OK", 0 for "ERR" or a lost connection.
+static int sendRequest(char* line) {
+    int length = (int)strlen(line);
+    line[length] = '\n';
+    int sent = sendAll(line, length + 1);
+    line[length] = '\0';
+    if (!sent) { dropConnection(); return 0; }
+    return readLine() && strncmp(replyLine, "OK", 2) == 0;
+}
+
+// Function: exchange
+// Purpose: Sends 'requestLine' and reads one reply line into 'replyLine'.
+// Reconnects first if the connection was lost (holds of the old connection
+// are gone by then, so their commits fail).
+// Returns: 1 if the server answered "OK", 0 for "ERR" or a lost connection.
+static int exchange() {
+    if (serverFd < 0 && (!remoteMode || !openConnection())) return 0;
+    return sendRequest(requestLine);
+}
+
+// Function: seatRequest
+// Purpose: Builds "<prefix> A1,B2" into 'requestLine'.
+static int seatRequest(const char* prefix, int qty, const SeatSelection* seats) {
+    int used = snprintf(requestLine, sizeof(requestLine), "%s ", prefix);
+    if (used <= 0 || used >= (int)sizeof(requestLine)) return 0;
+    return formatSeatCodes(qty, seats, requestLine + used, (int)sizeof(requestLine) - used - 1);
+}
+
+// ---------------------------------------------------------
+// CONNECTION
+// ---------------------------------------------------------
+
+// Function: openConnection
+// Purpose: Connects to 'serverAddress' and checks the halls with "HELLO".
+// Returns: 1 if connected, 0 if not (the socket is closed again).
+static int openConnection() {
+    dropConnection();
+    serverFd = openBookingSocket(serverAddress, 0);
+    if (serverFd < 0) return 0;
+
+    #ifndef _WIN32
+        struct timeval timeout;
+        timeout.tv_sec = REMOTE_TIMEOUT_MS / 1000;
+        timeout.tv_usec = (REMOTE_TIMEOUT_MS % 1000) * 1000;
+        setsockopt(serverFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    #endif
+
+    // Seat words are only meaningful if both sides use the same halls
+    // and the same schedule (see getLayoutFingerprint)
+    int showtimes, words;
+    unsigned long long fingerprint;
+    char hello[8] = "HELLO"; // Not in 'requestLine': that may hold the request to retry
+    if (!sendRequest(hello) ||
+        sscanf(replyLine, "OK %d %d %llx", &showtimes, &words, &fingerprint) != 3 ||
+        showtimes != getNumShowtimes() || words != getInventoryWordCount() ||
+        fingerprint != (unsigned long long)getLayoutFingerprint()) {
+        dropConnection();
+        return 0;
+    }
+    return 1;
+}
+
+// Function: connectBookingServer
+int connectBookingServer(const char* address) {
+    disconnectBookingServer();
+    snprintf(serverAddress, sizeof(serverAddress), "%s", address);
+    remoteMode = openConnection();
+    return remoteMode;
+}
+
+// Function: disconnectBookingServer
+void disconnectBookingServer() {
+    dropConnection();
+    remoteMode = 0;
+}
+
+// Function: isRemoteKiosk
+// Purpose: Stays 1 while the server is unreachable, so the kiosk never
+// falls back to its local mirror (seats the server may have sold since).
+int isRemoteKiosk() {
+    return remoteMode;
+}
+
+// ---------------------------------------------------------
+// SEATS
+// ---------------------------------------------------------
+
+// Function: applyMap
+// Purpose: "<seq> <rows> <taken> <sold> ..." -> the whole showtime.
+static int applyMap(int showtimeIndex, char* cursor) {
+    SeatWord taken[MAX_ROWS], sold[MAX_ROWS];
+    unsigned long long seq = strtoull(cursor, &cursor, 10);
+    int rows = (int)strtol(cursor, &cursor, 10), r;
+    if (showtimeIndex < 0 || showtimeIndex >= getNumShowtimes() ||
+        rows != getHall(showtimeIndex)->rows) return 0;
+    for(r = 0; r < rows; r++) {
+        taken[r] = (SeatWord)strtoull(cursor, &cursor, 16);
+        sold[r] = (SeatWord)strtoull(cursor, &cursor, 16);
+    }
+    loadShowtimeWords(showtimeIndex, taken, sold);
+    mirrorSeq[showtimeIndex] = seq;
+    haveMap[showtimeIndex] = 1;
+    return 1;
+}
+
+// Function: applyRow
+// Purpose: "<row> <taken> <sold>" -> one row. Returns the rest of the text.
+static char* applyRow(int showtimeIndex, char* cursor) {
+    int r = (int)strtol(cursor, &cursor, 10);
+    SeatWord taken = (SeatWord)strtoull(cursor, &cursor, 16);
+    SeatWord sold = (SeatWord)strtoull(cursor, &cursor, 16);
+    loadRowWords(showtimeIndex, r, taken, sold);
+    return cursor;
+}
+
+// Function: syncRemoteShowtime
+// Purpose: Asks only for the rows changed since the last sync ("FEED");
+// the whole map ("MAP") is fetched the first time or after a resync.
+int syncRemoteShowtime(int showtimeIndex) {
+    if (haveMap[showtimeIndex]) {
+        snprintf(requestLine, sizeof(requestLine), "FEED %d %llu", showtimeIndex, mirrorSeq[showtimeIndex]);
+        if (exchange()) {
+            char* cursor = replyLine + 2;
+            mirrorSeq[showtimeIndex] = strtoull(cursor, &cursor, 10);
+            while (*cursor == ' ') cursor = applyRow(showtimeIndex, cursor);
+            return 1;
+        }
+        if (serverFd < 0) return 0; // Connection lost (otherwise: ERR resync)
+    }
+
+    snprintf(requestLine, sizeof(requestLine), "MAP %d", showtimeIndex);
+    return exchange() && applyMap(showtimeIndex, replyLine + 2);
+}
+
+// Function: remoteHoldSeats
+int remoteHoldSeats(int qty, SeatSelection* seats, int showtimeIndex) {
+    char prefix[32];
+    snprintf(prefix, sizeof(prefix), "HOLD %d", showtimeIndex);
+    if (!seatRequest(prefix, qty, seats) || !exchange()) return -1;
+    return atoi(replyLine + 3);
+}
+
+// Function: remoteCommitSeats
+int remoteCommitSeats(int holdId, int qty, SeatSelection* seats, int showtimeIndex) {
+    char prefix[48];
+    snprintf(prefix, sizeof(prefix), "COMMIT %d %d", holdId, showtimeIndex);
+    return seatRequest(prefix, qty, seats) && exchange();
+}
+
+// Function: remoteReleaseSeats
+void remoteReleaseSeats(int holdId) {
+    snprintf(requestLine, sizeof(requestLine), "RELEASE %d", holdId);
+    exchange();
+}
+
+// ---------------------------------------------------------
+// CHANGE FEED (Lobby Displays)
+// ---------------------------------------------------------
+
+// Function: subscribeSeatFeed
+int subscribeSeatFeed(int showtimeIndex) {
+    if (showtimeIndex < 0) strcpy(requestLine, "SUB *");
+    else snprintf(requestLine, sizeof(requestLine), "SUB %d", showtimeIndex);
+    if (!exchange()) return 0;
+
+    // Pushes only come when seats change: wait for them as long as it takes
+    #ifndef _WIN32
+        struct timeval forever;
+        forever.tv_sec = 0;
+        forever.tv_usec = 0;
+        setsockopt(serverFd, SOL_SOCKET, SO_RCVTIMEO, &forever, sizeof(forever));
+    #endif
+    return 1;
+}
+
+// Function: readSeatPush
+// Purpose: Applies one pushed "M" (whole map) or "D" (one row) line.
+int readSeatPush() {
+    if (serverFd < 0 || !readLine()) return -2;
+    char* cursor = replyLine + 1;
+    int show = (int)strtol(cursor, &cursor, 10);
+    if (show < 0 || show >= getNumShowtimes()) return -1;
+
+    if (replyLine[0] == 'M') return applyMap(show, cursor) ? show : -1;
+    if (replyLine[0] == 'D') {
+        mirrorSeq[show] = strtoull(cursor, &cursor, 10);
+        applyRow(show, cursor);
+        return show;
+    }
+    return -1;
+}
+
+// ---------------------------------------------------------
+// SALES
+// ---------------------------------------------------------
+
+// Function: remoteSaveTransaction
+// Purpose: "SAVE <show> <tickets> <extras> <seats> <items>".
+int remoteSaveTransaction(int showtimeIndex, int count, SeatSelection* seats,
+                          long long ticketCentavos, long long extrasCentavos,
+                          int itemCount, const PackedItem* items) {
+    char prefix[96];
+    snprintf(prefix, sizeof(prefix), "SAVE %d %lld %lld", showtimeIndex, ticketCentavos, extrasCentavos);
+    if (!seatRequest(prefix, count, seats)) return 0;
+
+    int used = (int)strlen(requestLine);
+    if (used + 1 >= (int)sizeof(requestLine)) return 0;
+    requestLine[used++] = ' ';
+    if (!formatPackedItems(items, itemCount, requestLine + used, (int)sizeof(requestLine) - used - 1)) return 0;
+
+    if (saleSession == 0) saleSession = getEpochMicros();
+    if (!saleKeyOpen) saleNumber++;
+    used = (int)strlen(requestLine);
+    int keyLength = snprintf(requestLine + used, sizeof(requestLine) - used, " %d-%llx-%lu",
+                             getKioskShard(), (unsigned long long)saleSession, saleNumber);
+    if (keyLength <= 0 || used + keyLength >= (int)sizeof(requestLine) - 1) return 0;
+
+    int saved = exchange();
+    saleKeyOpen = !saved && serverFd < 0; // No reply: the server may have logged it
+    return saved;
+}
+
+// Function: remoteAbandonSale
+void remoteAbandonSale() {
+    saleKeyOpen = 0;
+}
+
+// ---------------------------------------------------------
+// CONCESSION STOCK
+// ---------------------------------------------------------
+
+// Function: remoteTakeStock
+int remoteTakeStock(int sku, int qty) {
+    snprintf(requestLine, sizeof(requestLine), "TAKE %d %d", sku, qty);
+    return exchange();
+}
+
+// Function: remoteReturnStock
+void remoteReturnStock(int sku, int qty) {
+    snprintf(requestLine, sizeof(requestLine), "GIVE %d %d", sku, qty);
+    exchange();
+}
+
+// Function: remoteRefreshStock
+// Purpose: "OK <sku>:<left> ..." -> the local counters (SKUs the kiosk
+// does not sell are skipped).
+int remoteRefreshStock() {
+    strcpy(requestLine, "STOCK");
+    if (!exchange()) return 0;
+
+    char* cursor = replyLine + 2;
+    while (*cursor == ' ') {
+        int sku, left, length;
+        if (sscanf(cursor, " %d:%d%n", &sku, &left, &length) != 2) break;
+        int item = findConcession(sku);
+        if (item >= 0) setStockLeft(item, left);
+        cursor += length;
+    }
+    return 1;
+}
+
+// Function: remoteSalesTotals
+int remoteSalesTotals(int* sales, long long* totalCentavos) {
+    strcpy(requestLine, "SALES");
+    return exchange() && sscanf(replyLine, "OK %d %lld", sales, totalCentavos) == 2;
+}
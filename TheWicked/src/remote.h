@@ -0,0 +1,82 @@
+#ifndef REMOTE_H
+#define REMOTE_H
+
+#include "tickets.h"
+
+// ---------------------------------------------------------
+// THIN-CLIENT KIOSK
+// ---------------------------------------------------------
+// "TheWicked --connect [address]" runs the normal kiosk screens, but the
+// seats and the sales log live in the booking server (see server.h).
+// The local inventory is only a mirror: it is refreshed from the server
+// before a seat map is drawn or seats are picked, and every hold, commit
+// and sale is decided by the server. tickets.c routes those calls here
+// whenever isRemoteKiosk() is true.
+//
+// Requests are blocking (a kiosk has one customer at a time) and give up
+// after REMOTE_TIMEOUT_MS; a lost server shows up as a failed hold/sale.
+// The kiosk stays a thin client until disconnectBookingServer(): the next
+// request tries to reconnect, and never runs against the local mirror.
+#define REMOTE_TIMEOUT_MS 5000
+
+// Connects and checks that both sides loaded the same halls and schedule.
+// Returns: 1 if connected, 0 if the server is unreachable or its halls differ.
+int connectBookingServer(const char* address);
+
+// Closes the connection (the server releases any open holds) and leaves
+// thin-client mode (call at shutdown).
+void disconnectBookingServer();
+
+// Returns 1 if this kiosk is a thin client of a booking server (also
+// while the connection is lost).
+int isRemoteKiosk();
+
+// Brings one showtime of the local mirror up to date: only the rows that
+// changed since the last call are sent (the whole map the first time).
+// Returns: 1 on success, 0 if the server did not answer.
+int syncRemoteShowtime(int showtimeIndex);
+
+// Lobby display: asks the server to push every change of one showtime
+// (-1 = all showtimes) on this connection. Send no other requests after it.
+// Returns: 1 if the server accepted the subscription.
+int subscribeSeatFeed(int showtimeIndex);
+
+// Waits (without a time limit) for the next push and applies it to the mirror.
+// Returns: The showtime that changed, -1 if nothing usable arrived, -2 if disconnected.
+int readSeatPush();
+
+// Server side holdSeats(). Returns: The hold ID, or -1 if a seat was taken.
+int remoteHoldSeats(int qty, SeatSelection* seats, int showtimeIndex);
+
+// Server side commitHeldSeats(). Returns: 1 if the seats are sold to us.
+int remoteCommitSeats(int holdId, int qty, SeatSelection* seats, int showtimeIndex);
+
+// Server side releaseHeldSeats().
+void remoteReleaseSeats(int holdId);
+
+// Server side saveTransaction(). Every sale is sent with a key; after a
+// lost reply the next call re-sends the same key (the same sale), and the
+// server answers OK if it had logged it already.
+// Returns: 1 once the sale is durable on the server.
+int remoteSaveTransaction(int showtimeIndex, int count, SeatSelection* seats,
+                          long long ticketCentavos, long long extrasCentavos,
+                          int itemCount, const PackedItem* items);
+
+// The sale whose SAVE got no reply will not be retried: the next call of
+// remoteSaveTransaction() is a new sale.
+void remoteAbandonSale();
+
+// Server side takeStock() / returnStock() for one SKU (concessions.h).
+// Returns: 1 if the units were taken.
+int remoteTakeStock(int sku, int qty);
+void remoteReturnStock(int sku, int qty);
+
+// Copies the server's stock counters into the local stand (for the menu).
+// Returns: 1 on success, 0 if the server did not answer.
+int remoteRefreshStock();
+
+// Sales of the current shift, as counted by the server.
+// Returns: 1 on success, 0 if the server did not answer.
+int remoteSalesTotals(int* sales, long long* totalCentavos);
+
+#endif
@@ -0,0 +1,558 @@
+// Request POSIX declarations (ftruncate, fsync) in strict C99 mode.
+// Must come before the first system header.
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include "salesrec.h"
+#include "utilities.h"
+
+// ---------------------------------------------------------
+// OS-SPECIFIC FILE I/O
+// ---------------------------------------------------------
+#ifdef _WIN32
+    #include <io.h>
+    #define open _open
+    #define close _close
+    #define fileno _fileno
+    #define ftruncate(fd, size) _chsize_s(fd, size)
+    #define fsync(fd) _commit(fd)
+    #define TRUNC_OPEN_FLAGS (O_WRONLY | O_BINARY)
+#else
+    #include <unistd.h>
+    #define TRUNC_OPEN_FLAGS O_WRONLY
+#endif
+
+// Every piece of the file must be exactly one record wide.
+typedef char SalesRecordSizeCheck[(sizeof(SalesRecord) == SALES_RECORD_SIZE) ? 1 : -1];
+typedef char SalesHeaderSizeCheck[(sizeof(SalesFileHeader) == SALES_RECORD_SIZE) ? 1 : -1];
+
+// ---------------------------------------------------------
+// HELPERS
+// ---------------------------------------------------------
+
+// Function: isValidHeader
+// Purpose: Version 1 files (no ITEMS records yet) are read as they are.
+static int isValidHeader(const SalesFileHeader* header) {
+    return memcmp(header->magic, SALES_FILE_MAGIC, 8) == 0
+        && (header->version == 1 || header->version == SALES_FILE_VERSION)
+        && header->recordSize == SALES_RECORD_SIZE;
+}
+
+// Function: writeHeader
+// Purpose: Starts a new, empty sales file.
+static int writeHeader(const char* path) {
+    SalesFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SALES_FILE_MAGIC, 8);
+    header.version = SALES_FILE_VERSION;
+    header.recordSize = SALES_RECORD_SIZE;
+    header.createdUs = getEpochMicros();
+
+    FILE* f = fopen(path, "wb");
+    if (f == NULL) return 0;
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1 && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    fclose(f);
+    return ok;
+}
+
+// Function: upgradeHeader
+// Purpose: Stamps a version 1 file as the current version before anything
+// new is appended, so an older program never meets an ITEMS record.
+static int upgradeHeader(const char* path) {
+    FILE* f = fopen(path, "r+b");
+    if (f == NULL) return 0;
+    uint32_t version = SALES_FILE_VERSION;
+    int ok = fseek(f, (long)offsetof(SalesFileHeader, version), SEEK_SET) == 0 &&
+             fwrite(&version, sizeof(version), 1, f) == 1 && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    fclose(f);
+    return ok;
+}
+
+// Function: truncateFile
+// Purpose: Cuts a torn record off the end of the file.
+static int truncateFile(const char* path, long long length) {
+    int fd = open(path, TRUNC_OPEN_FLAGS);
+    if (fd < 0) return 0;
+    int ok = ftruncate(fd, length) == 0 && fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+// Function: appendSeatLabel
+// Purpose: Appends "B12" style seat names, comma separated.
+static size_t appendSeatLabel(char* buffer, size_t used, size_t size, PackedSeat seat, int first) {
+    if (used >= size) return used;
+    int n = snprintf(buffer + used, size - used, "%s%c%d", first ? "" : ",", 'A' + seat.row, seat.col + 1);
+    return (n > 0) ? used + (size_t)n : used;
+}
+
+// Function: formatTime
+// Purpose: "Sat Oct 17 10:30:00 2026" (local time), same as the old ctime() text.
+static void formatTime(long long timeUs, char* buffer, size_t size) {
+    time_t seconds = (time_t)(timeUs / 1000000);
+    struct tm* local = localtime(&seconds);
+    if (local == NULL || strftime(buffer, size, "%a %b %d %H:%M:%S %Y", local) == 0) {
+        snprintf(buffer, size, "?");
+    }
+}
+
+// ---------------------------------------------------------
+// FILE ACCESS
+// ---------------------------------------------------------
+
+// Function: prepareSalesFile
+// Purpose: Makes sure the file starts with our header and ends on a whole
+// sale. A crash can leave half a record (or a sale without all of its
+// followers) at the end; that sale was never confirmed, so it is cut off
+// before anything new is appended behind it.
+int prepareSalesFile(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) return writeHeader(path);
+
+    SalesFileHeader header;
+    size_t got = fread(&header, 1, sizeof(header), f);
+    fclose(f);
+    if (got < sizeof(header)) return writeHeader(path); // Empty, or torn while being created
+    if (!isValidHeader(&header)) return 0;               // Someone else's file: leave it alone
+    if (header.version != SALES_FILE_VERSION && !upgradeHeader(path)) return 0;
+
+    SalesView view;
+    if (!mapSalesFile(path, &view)) return 0;
+    long long i = 0;
+    while (i < view.count && isSalesRecordComplete(&view, i)) i = nextSalesRecord(&view, i);
+    long long validLength = salesRecordOffset(i);
+    long long fileLength = (long long)view.size;
+    unmapSalesFile(&view);
+
+    if (fileLength > validLength) return truncateFile(path, validLength);
+    return 1;
+}
+
+// Function: mapSalesFile
+// Purpose: Maps the file and points 'records' just past the header.
+int mapSalesFile(const char* path, SalesView* view) {
+    memset(view, 0, sizeof(*view));
+    view->base = mapFileReadOnly(path, &view->size);
+    if (view->base == NULL || view->size < sizeof(SalesFileHeader)) return 1; // Nothing sold yet
+
+    if (!isValidHeader((const SalesFileHeader*)view->base)) {
+        unmapSalesFile(view);
+        return 0;
+    }
+    view->records = (const SalesRecord*)((const char*)view->base + sizeof(SalesFileHeader));
+    view->count = (long long)((view->size - sizeof(SalesFileHeader)) / SALES_RECORD_SIZE);
+    return 1;
+}
+
+// Function: unmapSalesFile
+void unmapSalesFile(SalesView* view) {
+    unmapFile(view->base, view->size);
+    memset(view, 0, sizeof(*view));
+}
+
+// Function: salesRecordOffset
+long long salesRecordOffset(long long index) {
+    return (long long)sizeof(SalesFileHeader) + index * SALES_RECORD_SIZE;
+}
+
+// ---------------------------------------------------------
+// RECORDS
+// ---------------------------------------------------------
+
+// Function: seatFollowers
+// Purpose: SEATS records needed for the seats that do not fit the SALE record.
+static int seatFollowers(int seatCount) {
+    if (seatCount <= SALE_INLINE_SEATS) return 0;
+    return (seatCount - SALE_INLINE_SEATS + SEATS_PER_FOLLOWER - 1) / SEATS_PER_FOLLOWER;
+}
+
+// Function: salesRecordsNeeded
+int salesRecordsNeeded(int seatCount, int itemCount) {
+    return 1 + seatFollowers(seatCount) + (itemCount + ITEMS_PER_FOLLOWER - 1) / ITEMS_PER_FOLLOWER;
+}
+
+// Function: encodeSale
+// Purpose: Packs a sale into its SALE record, SEATS followers and ITEMS followers.
+void encodeSale(SalesRecord* out, int showtimeIndex, int seatCount, const PackedSeat* seats,
+                int itemCount, const PackedItem* items,
+                long long timeUs, long long ticketCentavos, long long extrasCentavos) {
+    int records = salesRecordsNeeded(seatCount, itemCount);
+    int seatRecords = 1 + seatFollowers(seatCount);
+    int i, used = 0;
+    memset(out, 0, sizeof(SalesRecord) * records);
+
+    out[0].kind = REC_SALE;
+    out[0].showtime = (uint8_t)showtimeIndex;
+    out[0].count = (uint16_t)seatCount;
+    out[0].seatCount = (uint16_t)seatCount;
+    out[0].followers = (uint16_t)(records - 1);
+    out[0].body.sale.timeUs = timeUs;
+    out[0].body.sale.ticketCentavos = ticketCentavos;
+    out[0].body.sale.extrasCentavos = extrasCentavos;
+    out[0].body.sale.totalCentavos = ticketCentavos + extrasCentavos;
+    for(i = 0; i < SALE_INLINE_SEATS && used < seatCount; i++) out[0].body.sale.seats[i] = seats[used++];
+
+    int r;
+    for(r = 1; r < seatRecords; r++) {
+        out[r].kind = REC_SEATS;
+        out[r].showtime = (uint8_t)showtimeIndex;
+        for(i = 0; i < SEATS_PER_FOLLOWER && used < seatCount; i++) out[r].body.seats.seats[i] = seats[used++];
+        out[r].count = (uint16_t)i;
+    }
+    for(used = 0; r < records; r++) {
+        out[r].kind = REC_ITEMS;
+        out[r].showtime = (uint8_t)showtimeIndex;
+        for(i = 0; i < ITEMS_PER_FOLLOWER && used < itemCount; i++) out[r].body.items.items[i] = items[used++];
+        out[r].count = (uint16_t)i;
+    }
+}
+
+// Function: nextSalesRecord
+long long nextSalesRecord(const SalesView* view, long long index) {
+    const SalesRecord* rec = &view->records[index];
+    return index + 1 + ((rec->kind == REC_SALE) ? rec->followers : 0);
+}
+
+// Function: isSalesRecordComplete
+int isSalesRecordComplete(const SalesView* view, long long index) {
+    return index < view->count && nextSalesRecord(view, index) <= view->count;
+}
+
+// Function: countCompleteRecords
+// Purpose: Records are appended whole sales at a time, so only the last
+// sale can be short of followers. Step back over the SEATS / ITEMS records
+// at the end (at most one sale's worth) to its SALE record and check it.
+long long countCompleteRecords(const SalesView* view) {
+    long long head = view->count - 1;
+    while (head >= 0 && (view->records[head].kind == REC_SEATS || view->records[head].kind == REC_ITEMS)) head--;
+    if (head < 0) return 0;
+    return isSalesRecordComplete(view, head) ? view->count : head;
+}
+
+// Function: sumSaleRecords
+// Purpose: isSale is 0 or 1, so '-isSale' is a mask of all zeros or all
+// ones: non-sale records add nothing without a branch. Four lanes of
+// partial sums keep the additions independent of each other.
+Money sumSaleRecords(const SalesRecord* records, long long count, long long* sales) {
+    Money lane[4] = { 0, 0, 0, 0 };
+    long long found[4] = { 0, 0, 0, 0 };
+    long long i;
+    int k;
+    for(i = 0; i + 4 <= count; i += 4) {
+        for(k = 0; k < 4; k++) {
+            long long isSale = (records[i + k].kind == REC_SALE);
+            lane[k] += records[i + k].body.sale.totalCentavos & -isSale;
+            found[k] += isSale;
+        }
+    }
+    for(; i < count; i++) {
+        long long isSale = (records[i].kind == REC_SALE);
+        lane[0] += records[i].body.sale.totalCentavos & -isSale;
+        found[0] += isSale;
+    }
+    *sales = found[0] + found[1] + found[2] + found[3];
+    return lane[0] + lane[1] + lane[2] + lane[3];
+}
+
+// Function: getSaleSeats
+// Purpose: Gathers the seats from the SALE record and its followers.
+int getSaleSeats(const SalesView* view, long long index, PackedSeat* out, int max) {
+    const SalesRecord* rec = &view->records[index];
+    if (rec->kind != REC_SALE || !isSalesRecordComplete(view, index)) return 0;
+
+    int total = 0, i, f;
+    for(i = 0; i < rec->seatCount && i < SALE_INLINE_SEATS && total < max; i++) out[total++] = rec->body.sale.seats[i];
+    for(f = 1; f <= rec->followers; f++) {
+        const SalesRecord* more = &view->records[index + f];
+        if (more->kind != REC_SEATS) break; // The ITEMS records come last
+        for(i = 0; i < more->count && i < SEATS_PER_FOLLOWER && total < max; i++) {
+            out[total++] = more->body.seats.seats[i];
+        }
+    }
+    return total;
+}
+
+// Function: getSaleItems
+// Purpose: Gathers the line items from the ITEMS followers.
+int getSaleItems(const SalesView* view, long long index, PackedItem* out, int max) {
+    const SalesRecord* rec = &view->records[index];
+    if (rec->kind != REC_SALE || !isSalesRecordComplete(view, index)) return 0;
+
+    int total = 0, i, f;
+    for(f = 1; f <= rec->followers; f++) {
+        const SalesRecord* more = &view->records[index + f];
+        if (more->kind != REC_ITEMS) continue;
+        for(i = 0; i < more->count && i < ITEMS_PER_FOLLOWER && total < max; i++) {
+            out[total++] = more->body.items.items[i];
+        }
+    }
+    return total;
+}
+
+// Function: formatRecordText
+// Purpose: The text form used by the admin viewer and the export.
+// Sales keep the old "[date] Sold: N tickets | Total: PHP x" start.
+int formatRecordText(const SalesView* view, long long index, char* buffer, size_t size) {
+    const SalesRecord* rec = &view->records[index];
+    char timeStr[32], total[32];
+
+    if (rec->kind == REC_SHIFT) {
+        formatTime(rec->body.shift.timeUs, timeStr, sizeof(timeStr));
+        formatMoney(rec->body.shift.totalCentavos, total, sizeof(total));
+        snprintf(buffer, size, "=== SHIFT CLOSED [%s] | CASHOUT: PHP %s | %lld sales ===",
+                 timeStr, total, (long long)rec->body.shift.sales);
+        return 1;
+    }
+    if (rec->kind != REC_SALE) return 0;
+
+    char tickets[32], extras[32], show[8];
+    formatTime(rec->body.sale.timeUs, timeStr, sizeof(timeStr));
+    formatMoney(rec->body.sale.totalCentavos, total, sizeof(total));
+    formatMoney(rec->body.sale.ticketCentavos, tickets, sizeof(tickets));
+    formatMoney(rec->body.sale.extrasCentavos, extras, sizeof(extras));
+    if (rec->showtime == NO_SHOWTIME) snprintf(show, sizeof(show), "-");
+    else snprintf(show, sizeof(show), "%d", rec->showtime);
+
+    int n = snprintf(buffer, size, "[%s] Sold: %d tickets | Total: PHP %s | Show: %s | Seats: ",
+                     timeStr, rec->count, total, show);
+    size_t used = (n > 0) ? (size_t)n : 0;
+
+    PackedSeat seats[SALE_INLINE_SEATS + SEATS_PER_FOLLOWER];
+    int got, i, first = 1;
+    // Walk the seats in small batches so no big buffer is needed
+    const SalesRecord* part = rec;
+    int parts = 1 + (isSalesRecordComplete(view, index) ? rec->followers : 0);
+    int p;
+    for(p = 0; p < parts && (p == 0 || part->kind == REC_SEATS); p++, part++) {
+        got = 0;
+        if (p == 0) {
+            for(i = 0; i < rec->seatCount && i < SALE_INLINE_SEATS; i++) seats[got++] = rec->body.sale.seats[i];
+        } else {
+            for(i = 0; i < part->count && i < SEATS_PER_FOLLOWER; i++) seats[got++] = part->body.seats.seats[i];
+        }
+        for(i = 0; i < got; i++) {
+            used = appendSeatLabel(buffer, used, size, seats[i], first);
+            first = 0;
+        }
+    }
+    if (first && used < size) used += (size_t)snprintf(buffer + used, size - used, "-");
+    if (used < size) used += (size_t)snprintf(buffer + used, size - used, " | Tickets: %s | Extras: %s", tickets, extras);
+
+    // Line items as "Items: 2xSKU1,1xSKU3"
+    PackedItem items[MAX_SALE_ITEMS];
+    int itemCount = getSaleItems(view, index, items, MAX_SALE_ITEMS);
+    for(i = 0; i < itemCount && used < size; i++) {
+        int n = snprintf(buffer + used, size - used, "%s%uxSKU%u", (i == 0) ? " | Items: " : ",",
+                         (unsigned)items[i].qty, (unsigned)items[i].sku);
+        if (n > 0) used += (size_t)n;
+    }
+    return 1;
+}
+
+// ---------------------------------------------------------
+// TEXT
+// ---------------------------------------------------------
+
+// Function: exportSalesText
+// Purpose: On-demand human-readable copy (the binary file is the real record).
+int exportSalesText(const char* salesPath, const char* textPath) {
+    SalesView view;
+    if (!mapSalesFile(salesPath, &view)) return -1;
+
+    FILE* out = fopen(textPath, "w");
+    char* line = malloc(SALES_TEXT_MAX);
+    if (out == NULL || line == NULL) {
+        if (out != NULL) fclose(out);
+        free(line);
+        unmapSalesFile(&view);
+        return -1;
+    }
+
+    int exported = 0;
+    long long i;
+    for(i = 0; i < view.count && isSalesRecordComplete(&view, i); i = nextSalesRecord(&view, i)) {
+        if (!formatRecordText(&view, i, line, SALES_TEXT_MAX)) continue;
+        if (view.records[i].kind == REC_SHIFT) fputc('\n', out);
+        fprintf(out, "%s\n", line);
+        if (view.records[i].kind == REC_SALE) exported++;
+    }
+
+    int ok = (fclose(out) == 0);
+    free(line);
+    unmapSalesFile(&view);
+    return ok ? exported : -1;
+}
+
+// ---------------------------------------------------------
+// LEGACY TEXT IMPORT
+// ---------------------------------------------------------
+// Old files look like:
+//   === SHIFT CLOSED [Sun Dec 07 00:38:15 2025] | CASHOUT: $262.50 ===
+//   [Sun Dec 07 00:02:14 2025] Sold: 5 tickets | Total: $62.50
+//   [Sat Oct 17 10:30:00 2026] Sold: 2 tickets | Total: PHP 900.00 | Show: 0 | Seats: B1,B2 | ...
+// This is the only place left that has to guess the currency token.
+
+// Function: parseLegacyTime
+// Purpose: "[Sun Dec 07 00:02:14 2025]" -> microseconds (0 if unreadable).
+static long long parseLegacyTime(const char* text) {
+    static const char* months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    char month[4];
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+
+    const char* open = strchr(text, '[');
+    if (open == NULL) return 0;
+    if (sscanf(open + 1, "%*3s %3s %d %d:%d:%d %d", month, &tm.tm_mday,
+               &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &tm.tm_year) != 6) return 0;
+
+    const char* found = strstr(months, month);
+    if (found == NULL) return 0;
+    tm.tm_mon = (int)(found - months) / 3;
+    tm.tm_year -= 1900;
+    tm.tm_isdst = -1;
+    time_t seconds = mktime(&tm);
+    return (seconds == (time_t)-1) ? 0 : (long long)seconds * 1000000;
+}
+
+// Function: parseLegacyAmount
+// Purpose: Reads the amount after a label, accepting "PHP 1.00", "PHP1.00" or "$1.00".
+static long long parseLegacyAmount(const char* line, const char* label) {
+    const char* p = strstr(line, label);
+    if (p == NULL) return 0;
+    p += strlen(label);
+    while (*p == ' ') p++;
+    if (strncmp(p, "PHP", 3) == 0) p += 3;
+    else if (*p == '$') p++;
+    Money amount;
+    parseMoney(p, &amount);
+    return amount;
+}
+
+// Function: parseLegacySeats
+// Purpose: "| Seats: A1,B12 |" -> packed seats.
+static int parseLegacySeats(const char* line, PackedSeat* out, int max) {
+    const char* p = strstr(line, "| Seats: ");
+    int count = 0;
+    if (p == NULL) return 0;
+    p += 9;
+    while (*p >= 'A' && *p <= 'Z' && count < max) {
+        int col = atoi(p + 1) - 1;
+        if (col >= 0 && col < 64) {
+            out[count].row = (uint8_t)(*p - 'A');
+            out[count].col = (uint8_t)col;
+            count++;
+        }
+        p++;
+        while (*p >= '0' && *p <= '9') p++;
+        if (*p == ',') p++;
+    }
+    return count;
+}
+
+// A growable list of records for the shift being imported.
+typedef struct {
+    SalesRecord* items;
+    long long count;
+    long long capacity;
+} RecordList;
+
+// Function: listAppend
+static int listAppend(RecordList* list, const SalesRecord* records, int n) {
+    if (list->count + n > list->capacity) {
+        long long newCap = (list->capacity == 0) ? 256 : list->capacity * 2;
+        while (newCap < list->count + n) newCap *= 2;
+        SalesRecord* grown = realloc(list->items, sizeof(SalesRecord) * (size_t)newCap);
+        if (grown == NULL) return 0;
+        list->items = grown;
+        list->capacity = newCap;
+    }
+    memcpy(list->items + list->count, records, sizeof(SalesRecord) * n);
+    list->count += n;
+    return 1;
+}
+
+// Function: flushShift
+// Purpose: Writes [SHIFT record] + its sales. The SHIFT record needs the
+// sale count, which is only known once the next shift (or EOF) is reached.
+static int flushShift(FILE* out, SalesRecord* shift, RecordList* list) {
+    int ok = 1;
+    if (shift->kind == REC_SHIFT) {
+        shift->body.shift.records = list->count;
+        ok = fwrite(shift, sizeof(*shift), 1, out) == 1;
+    }
+    if (ok && list->count > 0) ok = fwrite(list->items, sizeof(SalesRecord), (size_t)list->count, out) == (size_t)list->count;
+    memset(shift, 0, sizeof(*shift));
+    list->count = 0;
+    return ok;
+}
+
+// Function: importLegacySalesText
+// Purpose: Converts the old text file once, then moves it out of the way.
+int importLegacySalesText(const char* textPath, const char* salesPath) {
+    FILE* in = fopen(textPath, "r");
+    if (in == NULL) return 0;
+    if (!prepareSalesFile(salesPath)) { fclose(in); return 0; }
+
+    FILE* out = fopen(salesPath, "ab");
+    char* line = malloc(SALES_TEXT_MAX);
+    PackedSeat* seats = malloc(sizeof(PackedSeat) * 26 * 64);
+    SalesRecord* sale = malloc(sizeof(SalesRecord) * salesRecordsNeeded(26 * 64, 0));
+    if (out == NULL || line == NULL || seats == NULL || sale == NULL) {
+        if (out != NULL) fclose(out);
+        free(line); free(seats); free(sale);
+        fclose(in);
+        return 0;
+    }
+
+    RecordList list = { NULL, 0, 0 };
+    SalesRecord shift;
+    memset(&shift, 0, sizeof(shift));
+    int imported = 0, ok = 1;
+
+    while (ok && fgets(line, SALES_TEXT_MAX, in)) {
+        if (strstr(line, "SHIFT CLOSED") != NULL) {
+            ok = flushShift(out, &shift, &list);
+            shift.kind = REC_SHIFT;
+            shift.body.shift.timeUs = parseLegacyTime(line);
+            shift.body.shift.totalCentavos = parseLegacyAmount(line, "CASHOUT:");
+        } else if (strstr(line, "Sold:") != NULL) {
+            int tickets = 0;
+            const char* sold = strstr(line, "Sold:");
+            sscanf(sold + 5, "%d", &tickets);
+
+            long long total = parseLegacyAmount(line, "Total:");
+            long long extras = parseLegacyAmount(line, "| Extras:");
+            int seatCount = parseLegacySeats(line, seats, 26 * 64);
+            const char* show = strstr(line, "| Show: ");
+            int showtime = (show != NULL) ? atoi(show + 8) : NO_SHOWTIME;
+            if (showtime < 0 || showtime > 0xFF) showtime = NO_SHOWTIME;
+
+            int n = salesRecordsNeeded(seatCount, 0);
+            encodeSale(sale, showtime, seatCount, seats, 0, NULL, parseLegacyTime(line), total - extras, extras);
+            sale[0].count = (uint16_t)tickets; // Old lines have a count but no seat list
+            ok = listAppend(&list, sale, n);
+            if (shift.kind == REC_SHIFT) shift.body.shift.sales++;
+            imported++;
+        }
+    }
+    if (ok) ok = flushShift(out, &shift, &list);
+    ok = ok && fflush(out) == 0 && fsync(fileno(out)) == 0;
+
+    fclose(out);
+    fclose(in);
+    free(list.items);
+    free(line); free(seats); free(sale);
+
+    if (!ok) return 0;
+
+    // Keep the original next to the new file, but never import it twice
+    char oldPath[300];
+    snprintf(oldPath, sizeof(oldPath), "%s.old", textPath);
+    remove(oldPath);
+    rename(textPath, oldPath);
+    return imported;
+}
@@ -0,0 +1,173 @@
+#ifndef SALESREC_H
+#define SALESREC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "money.h"
+
+// ---------------------------------------------------------
+// BINARY SALES RECORDS
+// ---------------------------------------------------------
+// The sales log and the history archive share one file format:
+//   [SalesFileHeader][SalesRecord][SalesRecord]...
+// Every piece is exactly 64 bytes, so record 'i' sits at byte
+// 64 + 64 * i and a reader can jump anywhere without parsing.
+// Times are microseconds since 1970 (UTC); money is whole centavos
+// (PHP 450.00 = 45000), so totals never pick up float rounding.
+//
+// A sale takes one SALE record plus, for parties larger than 12, one
+// SEATS record per extra 28 seats, then one ITEMS record per 7 concession
+// line items ("followers").
+// The archive also has a SHIFT record in front of every closed shift.
+// Version 1 files are the same minus ITEMS records, and are still read.
+#define SALES_FILE_MAGIC "WKSALES\n"
+#define SALES_FILE_VERSION 2
+#define SALES_RECORD_SIZE 64
+
+#define REC_SALE  1
+#define REC_SEATS 2
+#define REC_SHIFT 3
+#define REC_ITEMS 4
+
+#define SALE_INLINE_SEATS 12   // Seats stored in the SALE record itself
+#define SEATS_PER_FOLLOWER 28  // Seats stored in each SEATS record
+#define ITEMS_PER_FOLLOWER 7   // Line items stored in each ITEMS record
+#define MAX_SALE_ITEMS 16      // Line items one sale may list
+#define NO_SHOWTIME 0xFF       // Imported text records that had no showtime
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    int64_t createdUs;
+    uint8_t reserved[40];
+} SalesFileHeader;
+
+// One seat: row index (0 = A) and seat index (0 = seat 1).
+typedef struct {
+    uint8_t row;
+    uint8_t col;
+} PackedSeat;
+
+// One concession line item: SKU, units and the unit price charged.
+typedef struct {
+    uint16_t sku;
+    uint16_t qty;
+    int32_t unitCentavos;
+} PackedItem;
+
+typedef struct {
+    uint8_t kind;          // REC_SALE / REC_SEATS / REC_SHIFT
+    uint8_t showtime;      // SALE / SEATS: showtime index
+    uint16_t count;        // SALE: tickets in the sale; SEATS / ITEMS: entries in this record
+    uint16_t followers;    // SALE: SEATS + ITEMS records that follow it
+    uint16_t seatCount;    // SALE: seats listed (imported text sales may list none)
+    union {
+        struct {
+            int64_t timeUs;
+            int64_t totalCentavos;
+            int64_t ticketCentavos;
+            int64_t extrasCentavos;
+            PackedSeat seats[SALE_INLINE_SEATS];
+        } sale;
+        struct {
+            PackedSeat seats[SEATS_PER_FOLLOWER];
+        } seats;
+        struct {
+            PackedItem items[ITEMS_PER_FOLLOWER];
+        } items;
+        struct {
+            int64_t timeUs;          // When the shift was closed
+            int64_t totalCentavos;   // Cash handed over
+            int64_t sales;           // SALE records in the shift
+            int64_t records;         // Records after this one that belong to the shift
+            uint8_t reserved[24];
+        } shift;
+    } body;
+} SalesRecord;
+
+// A mapped sales file. 'records' points just past the header.
+typedef struct {
+    void* base;
+    size_t size;
+    const SalesRecord* records;
+    long long count;          // Whole records in the file (a torn tail is ignored)
+} SalesView;
+
+// ---------------------------------------------------------
+// FILE ACCESS
+// ---------------------------------------------------------
+
+// Creates the file with a header if it is missing or empty.
+// Returns: 1 if the file is ready for appending, 0 on error or foreign format.
+int prepareSalesFile(const char* path);
+
+// Maps a sales file for reading. A missing or empty file gives an empty view.
+// Returns: 1 on success, 0 if the file is not a sales file.
+int mapSalesFile(const char* path, SalesView* view);
+
+// Releases a view from mapSalesFile().
+void unmapSalesFile(SalesView* view);
+
+// Byte offset of record 'index' inside the file.
+long long salesRecordOffset(long long index);
+
+// ---------------------------------------------------------
+// RECORDS
+// ---------------------------------------------------------
+
+// Number of records needed to store a sale of 'seatCount' seats and
+// 'itemCount' concession line items.
+int salesRecordsNeeded(int seatCount, int itemCount);
+
+// Fills 'out' (salesRecordsNeeded() entries) with one sale.
+void encodeSale(SalesRecord* out, int showtimeIndex, int seatCount, const PackedSeat* seats,
+                int itemCount, const PackedItem* items,
+                long long timeUs, long long ticketCentavos, long long extrasCentavos);
+
+// Index of the record after 'index' and its followers.
+long long nextSalesRecord(const SalesView* view, long long index);
+
+// Returns 1 if the record and all of its followers are in the file.
+int isSalesRecordComplete(const SalesView* view, long long index);
+
+// Copies the seats of the sale at 'index' into 'out' (at most 'max').
+// Returns: Number of seats copied.
+int getSaleSeats(const SalesView* view, long long index, PackedSeat* out, int max);
+
+// Copies the concession line items of the sale at 'index' (at most 'max').
+// Returns: Number of items copied.
+int getSaleItems(const SalesView* view, long long index, PackedItem* out, int max);
+
+// Number of records at the front of the view that form whole sales:
+// view->count, or less if the last sale is still missing followers.
+long long countCompleteRecords(const SalesView* view);
+
+// Adds up the totals of the SALE records among 'count' records (the
+// SEATS followers in between count as zero) and counts those sales.
+// Branch-free and split over independent sums, so the compiler can
+// vectorise it; a day's log is summed at memory speed.
+Money sumSaleRecords(const SalesRecord* records, long long count, long long* sales);
+
+// Writes a SALE or SHIFT record as one text line (no newline), e.g.
+// "[Sat Oct 17 10:30:00 2026] Sold: 2 tickets | Total: PHP 900.00 | Show: 0 | Seats: B1,B2 | ..."
+// Returns: 1 if something was written, 0 for other record kinds.
+int formatRecordText(const SalesView* view, long long index, char* buffer, size_t size);
+
+// Longest line formatRecordText() can produce (a sale of every seat in the hall).
+#define SALES_TEXT_MAX (256 + 26 * 64 * 5 + MAX_SALE_ITEMS * 24)
+
+// ---------------------------------------------------------
+// TEXT
+// ---------------------------------------------------------
+
+// Writes every sale (and shift) of a sales file as readable text.
+// Returns: Number of sales exported, or -1 on error.
+int exportSalesText(const char* salesPath, const char* textPath);
+
+// One-time upgrade: converts an old text log/archive into binary records,
+// appends them to 'salesPath' and renames the text file to "<name>.old".
+// Returns: Number of sales imported (0 if there was nothing to import).
+int importLegacySalesText(const char* textPath, const char* salesPath);
+
+#endif
@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "screen.h"
+#include "metrics.h"
+#include "utilities.h"
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+// One character cell. 'color' is 0 for the default color or 1-8 for
+// ANSI colors 30-37 (COLOR_RED = 31 is stored as 2).
+typedef struct {
+    char ch;
+    unsigned char color;
+} Cell;
+
+#define COLOR_UNKNOWN 0xFF   // Front cell we cannot vouch for (always redrawn)
+
+// 'frame' is what the program drew; 'shown' is what the terminal shows.
+static Cell frame[SCREEN_ROWS][SCREEN_COLS];
+static Cell shown[SCREEN_ROWS][SCREEN_COLS];
+static int started = 0;
+static int penRow = 0, penCol = 0;
+static unsigned char penColor = 0;
+static int parkedRow = -1, parkedCol = -1, parkedColor = -1;   // Cursor after the last frame
+
+// Output assembled for one presentScreen() (grows as needed)
+static char* out = NULL;
+static size_t outLength = 0, outCapacity = 0;
+
+// ---------------------------------------------------------
+// HELPERS
+// ---------------------------------------------------------
+
+// Function: startScreen
+// Purpose: First use: wipe the real terminal once with an escape code,
+// so 'shown' (all blanks) matches it from then on.
+static void startScreen() {
+    int r, c;
+    for(r = 0; r < SCREEN_ROWS; r++) {
+        for(c = 0; c < SCREEN_COLS; c++) {
+            frame[r][c].ch = ' ';  frame[r][c].color = 0;
+            shown[r][c].ch = ' ';  shown[r][c].color = 0;
+        }
+    }
+    fputs("\033[0m\033[2J\033[H", stdout);
+    fflush(stdout);
+    started = 1;
+}
+
+// Function: emit
+// Purpose: Appends bytes to the output of the current frame.
+static void emit(const char* data, size_t length) {
+    if (outLength + length > outCapacity) {
+        size_t newCap = (outCapacity == 0) ? 4096 : outCapacity * 2;
+        while (newCap < outLength + length) newCap *= 2;
+        char* grown = realloc(out, newCap);
+        if (grown == NULL) return;
+        out = grown;
+        outCapacity = newCap;
+    }
+    memcpy(out + outLength, data, length);
+    outLength += length;
+}
+
+// Function: emitColor
+// Purpose: Switches the terminal to one of our color numbers.
+static void emitColor(unsigned char color) {
+    char code[16];
+    int n = (color == 0) ? snprintf(code, sizeof(code), "\033[0m")
+                         : snprintf(code, sizeof(code), "\033[0;%dm", 29 + color);
+    emit(code, (size_t)n);
+}
+
+// Function: emitMove
+static void emitMove(int row, int col) {
+    char code[24];
+    int n = snprintf(code, sizeof(code), "\033[%d;%dH", row + 1, col + 1);
+    emit(code, (size_t)n);
+}
+
+// Function: writeAll
+// Purpose: Hands the whole frame to the terminal in one write() call
+// (repeated only if the terminal accepts part of it).
+static void writeAll(const char* data, size_t length) {
+    fflush(stdout); // Anything printed outside the frame goes first
+    while (length > 0) {
+        #ifdef _WIN32
+            int n = _write(1, data, (unsigned)length);
+        #else
+            ssize_t n = write(STDOUT_FILENO, data, length);
+        #endif
+        if (n <= 0) return;
+        data += n;
+        length -= (size_t)n;
+    }
+}
+
+// Function: applyEscape
+// Purpose: Handles an escape sequence inside printed text: colors
+// ("ESC[31m", "ESC[0m"), cursor moves ("ESC[y;xH") and "ESC[2J".
+// Returns: Number of characters consumed.
+static int applyEscape(const char* text) {
+    int params[4] = { 0, 0, 0, 0 };
+    int count = 0, i = 2;
+    if (text[1] != '[') return 1;
+
+    while (text[i] != '\0' && ((text[i] >= '0' && text[i] <= '9') || text[i] == ';')) {
+        if (text[i] == ';') { if (count < 3) count++; }
+        else params[count] = params[count] * 10 + (text[i] - '0');
+        i++;
+    }
+    if (text[i] == '\0') return i;
+    count++;
+
+    if (text[i] == 'm') {
+        int p;
+        for(p = 0; p < count; p++) {
+            if (params[p] == 0) penColor = 0;
+            else if (params[p] >= 30 && params[p] <= 37) penColor = (unsigned char)(params[p] - 29);
+        }
+    } else if (text[i] == 'H') {
+        gotoxy(params[1], params[0]);
+    } else if (text[i] == 'J' && params[0] == 2) {
+        clearScreen();
+    }
+    return i + 1;
+}
+
+// ---------------------------------------------------------
+// PUBLIC API
+// ---------------------------------------------------------
+
+// Function: clearScreen
+// Purpose: Wipes the frame clean. Used between menus.
+void clearScreen() {
+    if (!started) startScreen();
+    int r, c;
+    for(r = 0; r < SCREEN_ROWS; r++) {
+        for(c = 0; c < SCREEN_COLS; c++) {
+            frame[r][c].ch = ' ';
+            frame[r][c].color = 0;
+        }
+    }
+    penRow = 0;
+    penCol = 0;
+}
+
+// Function: gotoxy
+// Purpose: Moves the pen to a specific coordinate (X, Y).
+// Essential for drawing the UI in specific places (centering, tables, etc).
+void gotoxy(int x, int y) {
+    penCol = (x > 0) ? x - 1 : 0;
+    penRow = (y > 0) ? y - 1 : 0;
+}
+
+// Function: screenPrintf
+// Purpose: Formats the text, then writes it cell by cell at the pen.
+void screenPrintf(const char* format, ...) {
+    char local[512];
+    char* text = local;
+    va_list args;
+
+    if (!started) startScreen();
+
+    va_start(args, format);
+    int length = vsnprintf(local, sizeof(local), format, args);
+    va_end(args);
+    if (length < 0) return;
+    if ((size_t)length >= sizeof(local)) {
+        // Long text (rare): format again into a buffer of the right size
+        text = malloc((size_t)length + 1);
+        if (text == NULL) return;
+        va_start(args, format);
+        vsnprintf(text, (size_t)length + 1, format, args);
+        va_end(args);
+    }
+
+    const char* p = text;
+    while (*p != '\0') {
+        if (*p == '\033') { p += applyEscape(p); continue; }
+
+        if (*p == '\n') { penRow++; penCol = 0; }
+        else if (*p == '\r') { penCol = 0; }
+        else if (*p == '\t') { penCol = (penCol / 8 + 1) * 8; }
+        else {
+            if (penRow < SCREEN_ROWS && penCol < SCREEN_COLS) {
+                frame[penRow][penCol].ch = *p;
+                frame[penRow][penCol].color = penColor;
+            }
+            penCol++;
+        }
+        p++;
+    }
+    if (text != local) free(text);
+}
+
+// Function: presentScreen
+// Purpose: Diffs the frame against the terminal and sends only the cells
+// that changed. Cursor moves and color changes are emitted only when the
+// next changed cell is not right after the previous one / has a new color.
+void presentScreen() {
+    if (!started) startScreen();
+    long long startUs = getMonotonicMicros();
+
+    int r, c;
+    int atRow = -1, atCol = -1;      // Where the terminal cursor is after our last cell
+    int atColor = -1;                // Color the terminal is using (unknown at first)
+    outLength = 0;
+
+    for(r = 0; r < SCREEN_ROWS; r++) {
+        for(c = 0; c < SCREEN_COLS; c++) {
+            Cell* want = &frame[r][c];
+            Cell* have = &shown[r][c];
+            if (want->ch == have->ch && want->color == have->color) continue;
+
+            if (r != atRow || c != atCol) emitMove(r, c);
+            if (want->color != atColor) { emitColor(want->color); atColor = want->color; }
+            emit(&want->ch, 1);
+            *have = *want;
+            atRow = r;
+            atCol = c + 1;
+        }
+    }
+
+    // Leave the cursor (and color) where the program's pen is, for input echo
+    int row = (penRow < SCREEN_ROWS) ? penRow : SCREEN_ROWS - 1;
+    int col = (penCol < SCREEN_COLS) ? penCol : SCREEN_COLS - 1;
+    if (outLength == 0 && row == parkedRow && col == parkedCol && penColor == parkedColor) {
+        recordLatency(METRIC_RENDER, getMonotonicMicros() - startUs);
+        return;
+    }
+    if (row != atRow || col != atCol) emitMove(row, col);
+    if (penColor != atColor) emitColor(penColor);
+    parkedRow = row;
+    parkedCol = col;
+    parkedColor = penColor;
+
+    writeAll(out, outLength);
+    recordLatency(METRIC_RENDER, getMonotonicMicros() - startUs);
+}
+
+// Function: presentScreenForInput
+// Purpose: Same as presentScreen(), then forgets what the terminal shows
+// from the cursor to the end of the row (the user's typing lands there).
+void presentScreenForInput() {
+    presentScreen();
+    parkedRow = -1; // The typing moves the cursor
+    if (penRow >= SCREEN_ROWS) return;
+    int c;
+    for(c = penCol; c < SCREEN_COLS; c++) shown[penRow][c].color = COLOR_UNKNOWN;
+}
@@ -0,0 +1,41 @@
+#ifndef SCREEN_H
+#define SCREEN_H
+
+// ---------------------------------------------------------
+// FRAME-BUFFERED SCREEN
+// ---------------------------------------------------------
+// All kiosk drawing goes into an in-memory grid of character cells
+// (character + color) instead of straight to the terminal:
+//   - clearScreen() just blanks the grid (no "cls"/"clear" process),
+//   - gotoxy() / screenPrintf() move the pen and write cells,
+//   - presentScreen() compares the grid with what the terminal already
+//     shows and sends only the changed cells, in one write().
+// The screen is presented automatically before every pause, and the
+// input helpers present it before waiting for the keyboard.
+//
+// Coordinates follow the ANSI cursor convention the UI was laid out with:
+// gotoxy(x, y) is column x, row y, counting from 1 (0 is treated as 1).
+#define SCREEN_COLS 100   // Same as SCREEN_WIDTH; anything further right is clipped
+#define SCREEN_ROWS 50    // Enough for the tallest seat map (26 rows) plus menus
+
+// Blanks the frame (the terminal changes on the next presentScreen()).
+void clearScreen();
+
+// Moves the pen to a specific coordinate.
+// @param x: Horizontal position (Column).
+// @param y: Vertical position (Row).
+void gotoxy(int x, int y);
+
+// printf() into the frame at the pen position. Understands the COLOR_*
+// codes, '\n' (next row, column 1) and '\t'.
+void screenPrintf(const char* format, ...);
+
+// Sends the changed cells to the terminal and parks the cursor at the pen.
+void presentScreen();
+
+// presentScreen() before reading the keyboard. Whatever the user types is
+// echoed by the terminal behind our back, so the rest of the cursor row
+// is redrawn on the next frame.
+void presentScreenForInput();
+
+#endif
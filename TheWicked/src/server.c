@@ -0,0 +1,782 @@
+// Request POSIX declarations (sockets, sigaction) in strict C99 mode.
+// Must come before the first system header.
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+#include "server.h"
+#include "tickets.h"
+#include "hall.h"
+#include "inventory.h"
+#include "pricing.h"
+#include "feed.h"
+#include "concessions.h"
+#include "holds.h"
+#include "wal.h"
+#include "archive.h"
+#include "salesrec.h"
+#include "utilities.h"
+
+// ---------------------------------------------------------
+// SEAT CODES (shared with remote.c)
+// ---------------------------------------------------------
+
+// Function: formatSeatCodes
+int formatSeatCodes(int qty, const SeatSelection* seats, char* buffer, int size) {
+    int used = 0, i;
+    if (size < 1) return 0;
+    buffer[0] = '\0';
+    for(i = 0; i < qty; i++) {
+        int n = snprintf(buffer + used, size - used, "%s%c%d",
+                         (i > 0) ? "," : "", 'A' + seats[i].r, seats[i].c + 1);
+        if (n < 0 || n >= size - used) return 0;
+        used += n;
+    }
+    return 1;
+}
+
+// Function: parseSeatCodes
+// Purpose: The inverse of formatSeatCodes(). Class and price come from
+// the row, like manualSeatSelect() does.
+int parseSeatCodes(char* list, int showtimeIndex, SeatSelection* seats, int max) {
+    int band = getOccupancyBand(showtimeIndex);
+    SeatWord picked[MAX_ROWS];
+    memset(picked, 0, sizeof(picked));
+
+    int count = 0;
+    char* code = list;
+    while (*code != '\0') {
+        if (count == max) return -1;
+        int rowIdx = toupper((unsigned char)code[0]) - 'A';
+        if (!isdigit((unsigned char)code[1])) return -1;
+        int colIdx = atoi(&code[1]) - 1;
+        if (!seatExists(showtimeIndex, rowIdx, colIdx)) return -1;
+
+        SeatWord bit = (SeatWord)1 << colIdx;
+        if (picked[rowIdx] & bit) return -1;
+        picked[rowIdx] |= bit;
+
+        seats[count].r = rowIdx;
+        seats[count].c = colIdx;
+        seats[count].rowChar = 'A' + rowIdx;
+        seats[count].type = getRowClass(showtimeIndex, rowIdx);
+        seats[count].price = lookupSeatPrice(showtimeIndex, seats[count].type, band, CUSTOMER_GUEST);
+        count++;
+
+        char* comma = strchr(code, ',');
+        if (comma == NULL) break;
+        code = comma + 1;
+    }
+    return count;
+}
+
+#ifdef _WIN32
+
+// ---------------------------------------------------------
+// WINDOWS
+// ---------------------------------------------------------
+// The event loop is built on epoll, which only Linux has.
+
+// Function: runBookingServer
+int runBookingServer(const char* address) {
+    (void)address;
+    fprintf(stderr, "The booking server needs Linux (epoll).\n");
+    return 1;
+}
+
+// Function: openBookingSocket
+int openBookingSocket(const char* address, int listening) {
+    (void)address;
+    (void)listening;
+    return -1;
+}
+
+#else
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define SERVER_OUT_MAX   65536   // Reply bytes buffered per kiosk
+#define SERVER_REPLY_MAX 2048    // Longest reply (a 26-row MAP) + margin
+#define SERVER_MAX_HOLDS 16      // Open holds per connection
+#define SERVER_MAX_EVENTS 64     // Sockets handled per epoll_wait
+#define SERVER_TICK_MS 1000      // Idle wake-up, to expire holds
+#define SAVED_KEY_SLOTS 4096     // Power of two; sale keys remembered for retried SAVEs
+
+// One connected kiosk.
+typedef struct Client {
+    int fd;
+    int owner;                       // Hold owner ID of this connection
+    unsigned int events;             // Current epoll interest
+    int inLen;                       // Unprocessed request bytes
+    int outLen, outSent;             // Reply bytes buffered / already sent
+    int holds[SERVER_MAX_HOLDS];     // Holds to cancel if the kiosk goes away
+    int holdCount;
+    int stockTaken[MAX_CONCESSIONS]; // Concession units taken (TAKE) and not yet sold
+    int waitingForLog;               // SAVE in the current batch, reply pending
+    char saleKey[SALE_KEY_MAX];      // Key of that SAVE ("" = none sent)
+    int closed;                      // Socket gone; freed once the batch is done
+    struct Client* nextWaiting;      // Next client in the SAVE batch
+    int subscribed;                  // SUB received (linked in the subscriber list)
+    unsigned char watching[MAX_SHOWTIMES];             // SUB: 1 = push changes of that showtime
+    unsigned long long cursors[MAX_SHOWTIMES];         // Last feed sequence sent
+    struct Client* prevSubscriber;   // Links of the subscriber list
+    struct Client* nextSubscriber;
+    char in[SERVER_LINE_MAX];
+    char out[SERVER_OUT_MAX];
+} Client;
+
+static int epollFd = -1;
+static volatile sig_atomic_t stopRequested = 0;
+static int nextOwner = 1;
+
+// SAVE batch: records of every SAVE read in this round, written together
+static SalesRecord* batchRecords = NULL;
+static int batchCount = 0, batchCapacity = 0;
+static Client* batchClients = NULL;
+
+// Keys of the sales written lately, one per slot of their hash: a newer
+// key that lands on the same slot pushes the old one out (retries come
+// within seconds, long before that matters)
+static char savedKeys[SAVED_KEY_SLOTS][SALE_KEY_MAX];
+
+// Connections that subscribed to the seat change feed
+static Client* subscribers = NULL;
+
+// Scratch space for one request (the server is single-threaded)
+static SeatSelection requestSeats[MAX_ROWS * MAX_COLS];
+static PackedSeat requestPacked[MAX_ROWS * MAX_COLS];
+static PackedItem requestItems[MAX_SALE_ITEMS];
+
+// Function: handleStopSignal
+static void handleStopSignal(int sig) {
+    (void)sig;
+    stopRequested = 1;
+}
+
+// ---------------------------------------------------------
+// SOCKETS
+// ---------------------------------------------------------
+
+// Function: parseTcpAddress
+// Purpose: "PORT", ":PORT" or "HOST:PORT" -> IPv4 address.
+// Returns: 1 for a TCP address, 0 if 'address' is a socket path.
+static int parseTcpAddress(const char* address, struct sockaddr_in* out) {
+    const char* colon = strrchr(address, ':');
+    const char* port = (colon != NULL) ? colon + 1 : address;
+    const char* p;
+    if (*port == '\0' || strchr(address, '/') != NULL) return 0;
+    for(p = port; *p != '\0'; p++) {
+        if (!isdigit((unsigned char)*p)) return 0;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->sin_family = AF_INET;
+    out->sin_port = htons((unsigned short)atoi(port));
+    out->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (colon != NULL && colon != address) {
+        char host[64];
+        int length = (int)(colon - address);
+        if (length >= (int)sizeof(host)) return 0;
+        memcpy(host, address, length);
+        host[length] = '\0';
+        if (inet_pton(AF_INET, host, &out->sin_addr) != 1) return 0;
+    }
+    return 1;
+}
+
+// Function: openBookingSocket
+// Purpose: Listening socket for the server, or a connected one for a kiosk.
+// Returns: The socket, or -1 on error.
+int openBookingSocket(const char* address, int listening) {
+    struct sockaddr_in tcp;
+    int fd;
+
+    if (parseTcpAddress(address, &tcp)) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Replies are tiny
+        if (listening) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (bind(fd, (struct sockaddr*)&tcp, sizeof(tcp)) != 0) { close(fd); return -1; }
+        } else if (connect(fd, (struct sockaddr*)&tcp, sizeof(tcp)) != 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        struct sockaddr_un local;
+        memset(&local, 0, sizeof(local));
+        local.sun_family = AF_UNIX;
+        if (strlen(address) >= sizeof(local.sun_path)) return -1;
+        strcpy(local.sun_path, address);
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        if (listening) {
+            // A socket file left behind by a server that crashed
+            struct stat info;
+            if (stat(address, &info) == 0 && S_ISSOCK(info.st_mode)) unlink(address);
+            if (bind(fd, (struct sockaddr*)&local, sizeof(local)) != 0) { close(fd); return -1; }
+        } else if (connect(fd, (struct sockaddr*)&local, sizeof(local)) != 0) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    if (listening && listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Function: setNonBlocking
+static int setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return (flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0);
+}
+
+// ---------------------------------------------------------
+// CONNECTIONS
+// ---------------------------------------------------------
+
+// Function: updateInterest
+// Purpose: Reads only while the kiosk's replies fit and no SAVE is pending
+// (backpressure); waits for EPOLLOUT only while replies are queued.
+static void updateInterest(Client* client) {
+    if (client->closed) return;
+    unsigned int wanted = 0;
+    if (!client->waitingForLog && client->outLen <= SERVER_OUT_MAX - SERVER_REPLY_MAX &&
+        client->inLen < SERVER_LINE_MAX) wanted |= EPOLLIN;
+    if (client->outSent < client->outLen) wanted |= EPOLLOUT;
+    if (wanted == client->events) return;
+
+    struct epoll_event event;
+    event.events = wanted;
+    event.data.ptr = client;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, client->fd, &event);
+    client->events = wanted;
+}
+
+// Function: closeClient
+// Purpose: Drops the connection and gives its open holds (and the
+// concessions of its unfinished order) back.
+// A client with a SAVE in the batch is freed after the batch is written.
+static void closeClient(Client* client) {
+    int i;
+    if (client->closed) return;
+    for(i = 0; i < client->holdCount; i++) cancelHold(client->holds[i], client->owner);
+    client->holdCount = 0;
+    for(i = 0; i < getNumConcessions(); i++) {
+        if (client->stockTaken[i] > 0) returnStock(i, client->stockTaken[i]);
+        client->stockTaken[i] = 0;
+    }
+    if (client->subscribed != 0) {
+        if (client->prevSubscriber != NULL) client->prevSubscriber->nextSubscriber = client->nextSubscriber;
+        else subscribers = client->nextSubscriber;
+        if (client->nextSubscriber != NULL) client->nextSubscriber->prevSubscriber = client->prevSubscriber;
+        client->subscribed = 0;
+    }
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    client->closed = 1;
+    if (!client->waitingForLog) free(client);
+}
+
+// Function: flushReplies
+// Purpose: Sends queued replies until the socket would block.
+// Returns: 1 if the client is still connected.
+static int flushReplies(Client* client) {
+    while (client->outSent < client->outLen) {
+        ssize_t n = send(client->fd, client->out + client->outSent,
+                         client->outLen - client->outSent, MSG_NOSIGNAL);
+        if (n > 0) { client->outSent += (int)n; continue; }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        closeClient(client);
+        return 0;
+    }
+    if (client->outSent == client->outLen) client->outLen = client->outSent = 0;
+    updateInterest(client);
+    return 1;
+}
+
+// Function: reply
+// Purpose: Queues one reply line (the caller keeps SERVER_REPLY_MAX free).
+static void reply(Client* client, const char* format, ...) {
+    // Move the unsent part to the front if the tail is getting short
+    if (client->outSent > 0 && client->outLen > SERVER_OUT_MAX - SERVER_REPLY_MAX) {
+        memmove(client->out, client->out + client->outSent, client->outLen - client->outSent);
+        client->outLen -= client->outSent;
+        client->outSent = 0;
+    }
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(client->out + client->outLen, SERVER_OUT_MAX - client->outLen - 1, format, args);
+    va_end(args);
+    if (n < 0 || n >= SERVER_OUT_MAX - client->outLen - 1) n = SERVER_OUT_MAX - client->outLen - 2;
+    client->outLen += n;
+    client->out[client->outLen++] = '\n';
+}
+
+// Function: trackHold
+// Purpose: Remembers an open hold (the caller checked there is room).
+static void trackHold(Client* client, int holdId) {
+    client->holds[client->holdCount++] = holdId;
+}
+
+// Function: forgetHold
+// Purpose: The hold was committed or released; nothing to cancel later.
+static void forgetHold(Client* client, int holdId) {
+    int i;
+    for(i = 0; i < client->holdCount; i++) {
+        if (client->holds[i] == holdId) {
+            client->holds[i] = client->holds[--client->holdCount];
+            return;
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// REQUESTS
+// ---------------------------------------------------------
+
+// Function: nextToken
+// Purpose: Cuts the next space-separated token out of the request.
+static char* nextToken(char** cursor) {
+    char* p = *cursor;
+    while (*p == ' ') p++;
+    if (*p == '\0') { *cursor = p; return NULL; }
+    char* start = p;
+    while (*p != '\0' && *p != ' ') p++;
+    if (*p != '\0') *p++ = '\0';
+    *cursor = p;
+    return start;
+}
+
+// Function: parseShowtime
+// Returns: The showtime index, or -1 if the token is missing or out of range.
+static int parseShowtime(const char* token) {
+    if (token == NULL || !isdigit((unsigned char)token[0])) return -1;
+    int show = atoi(token);
+    return (show < getNumShowtimes()) ? show : -1;
+}
+
+// Function: formatMap
+// Purpose: "<prefix> <seq> <rows> <taken> <sold> ..." for one showtime.
+// The sequence is read before the words, so deltas after it fix up
+// anything that changed while the words were being copied.
+static unsigned long long formatMap(char* text, int size, const char* prefix, int show) {
+    SeatWord taken[MAX_ROWS], sold[MAX_ROWS];
+    int rows = getHall(show)->rows, r;
+    unsigned long long seq = getFeedSequence(show);
+    int used = snprintf(text, size, "%s %llu %d", prefix, seq, rows);
+
+    copyShowtimeWords(show, taken, sold);
+    for(r = 0; r < rows; r++) {
+        used += snprintf(text + used, size - used, " %llx %llx",
+                         (unsigned long long)taken[r], (unsigned long long)sold[r]);
+    }
+    return seq;
+}
+
+// Function: pushFeeds
+// Purpose: After each round of events, sends every subscriber the rows
+// that changed since its cursor ("D" lines), or a whole map ("M") if it
+// is too far behind. A subscriber with a full reply buffer is skipped;
+// if it stays behind long enough it simply gets a fresh map later.
+static void pushFeeds() {
+    Client* client = subscribers;
+    while (client != NULL) {
+        Client* next = client->nextSubscriber;
+        int show, i;
+        for(show = 0; show < getNumShowtimes(); show++) {
+            if (!client->watching[show]) continue;
+            if (getFeedSequence(show) == client->cursors[show]) continue;
+            if (client->outLen > SERVER_OUT_MAX - 2 * SERVER_REPLY_MAX) break;
+
+            SeatDelta deltas[MAX_ROWS];
+            int count = readSeatFeed(show, client->cursors[show], deltas, getHall(show)->rows);
+            if (count == FEED_RESYNC) {
+                char text[SERVER_REPLY_MAX], prefix[16];
+                snprintf(prefix, sizeof(prefix), "M %d", show);
+                client->cursors[show] = formatMap(text, sizeof(text), prefix, show);
+                reply(client, "%s", text);
+                continue;
+            }
+            for(i = 0; i < count; i++) {
+                reply(client, "D %d %llu %d %llx %llx", show, deltas[i].seq, deltas[i].row,
+                      (unsigned long long)deltas[i].taken, (unsigned long long)deltas[i].sold);
+            }
+            if (count > 0) client->cursors[show] = deltas[count - 1].seq;
+        }
+        flushReplies(client); // May close (and unlink) the client
+        client = next;
+    }
+}
+
+// Function: saleKeySlot
+// Purpose: FNV-1a of the key -> its slot in 'savedKeys'.
+static char* saleKeySlot(const char* key) {
+    unsigned int hash = 2166136261u;
+    while (*key != '\0') {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+    return savedKeys[hash & (SAVED_KEY_SLOTS - 1)];
+}
+
+// Function: queueSave
+// Purpose: Encodes the sale into the batch; the reply comes after the flush.
+static int queueSave(Client* client, int show, int qty, int itemCount,
+                     long long ticketCentavos, long long extrasCentavos) {
+    int needed = salesRecordsNeeded(qty, itemCount), i;
+    if (batchCount + needed > batchCapacity) {
+        int capacity = (batchCapacity == 0) ? 64 : batchCapacity * 2;
+        while (capacity < batchCount + needed) capacity *= 2;
+        SalesRecord* grown = realloc(batchRecords, sizeof(SalesRecord) * capacity);
+        if (grown == NULL) return 0;
+        batchRecords = grown;
+        batchCapacity = capacity;
+    }
+
+    for(i = 0; i < qty; i++) {
+        requestPacked[i].row = (uint8_t)requestSeats[i].r;
+        requestPacked[i].col = (uint8_t)requestSeats[i].c;
+    }
+    encodeSale(batchRecords + batchCount, show, qty, requestPacked, itemCount, requestItems,
+               getEpochMicros(), ticketCentavos, extrasCentavos);
+
+    // The items are sold now: no longer returned if the kiosk disconnects
+    for(i = 0; i < itemCount; i++) {
+        int item = findConcession(requestItems[i].sku);
+        int sold = requestItems[i].qty;
+        client->stockTaken[item] = (client->stockTaken[item] > sold) ? client->stockTaken[item] - sold : 0;
+    }
+    batchCount += needed;
+
+    client->waitingForLog = 1;
+    client->nextWaiting = batchClients;
+    batchClients = client;
+    return 1;
+}
+
+// Function: handleRequest
+// Purpose: Runs one request line against the local inventory.
+static void handleRequest(Client* client, char* line) {
+    char* cursor = line;
+    char* verb = nextToken(&cursor);
+    if (verb == NULL) { reply(client, "ERR empty"); return; }
+
+    if (strcmp(verb, "PING") == 0) {
+        reply(client, "OK");
+    }
+    else if (strcmp(verb, "HELLO") == 0) {
+        reply(client, "OK %d %d %llx", getNumShowtimes(), getInventoryWordCount(),
+              (unsigned long long)getLayoutFingerprint());
+    }
+    else if (strcmp(verb, "MAP") == 0) {
+        int show = parseShowtime(nextToken(&cursor));
+        if (show < 0) { reply(client, "ERR showtime"); return; }
+        char text[SERVER_REPLY_MAX];
+        advanceHolds(); // Expired holds show as free
+        formatMap(text, sizeof(text), "OK", show);
+        reply(client, "%s", text);
+    }
+    else if (strcmp(verb, "FEED") == 0) {
+        int show = parseShowtime(nextToken(&cursor));
+        char* after = nextToken(&cursor);
+        if (show < 0 || after == NULL) { reply(client, "ERR showtime"); return; }
+
+        SeatDelta deltas[MAX_ROWS];
+        char text[SERVER_REPLY_MAX];
+        unsigned long long from = strtoull(after, NULL, 10);
+        advanceHolds();
+        int count = readSeatFeed(show, from, deltas, getHall(show)->rows), i;
+        if (count == FEED_RESYNC) { reply(client, "ERR resync"); return; }
+
+        int used = snprintf(text, sizeof(text), "OK %llu", (count > 0) ? deltas[count - 1].seq : from);
+        for(i = 0; i < count; i++) {
+            used += snprintf(text + used, sizeof(text) - used, " %d %llx %llx", deltas[i].row,
+                             (unsigned long long)deltas[i].taken, (unsigned long long)deltas[i].sold);
+        }
+        reply(client, "%s", text);
+    }
+    else if (strcmp(verb, "SUB") == 0) {
+        char* which = nextToken(&cursor);
+        int show = (which != NULL && strcmp(which, "*") == 0) ? -2 : parseShowtime(which);
+        if (show == -1) { reply(client, "ERR showtime"); return; }
+        if (client->subscribed == 0) {
+            client->prevSubscriber = NULL;
+            client->nextSubscriber = subscribers;
+            if (subscribers != NULL) subscribers->prevSubscriber = client;
+            subscribers = client;
+        }
+        // Cursor 'behind everything': the first push is a whole map ("M")
+        int t;
+        for(t = 0; t < getNumShowtimes(); t++) {
+            if ((show == -2 || show == t) && !client->watching[t]) {
+                client->watching[t] = 1;
+                client->cursors[t] = ~0ULL;
+            }
+        }
+        client->subscribed = 1;
+        reply(client, "OK");
+    }
+    else if (strcmp(verb, "HOLD") == 0) {
+        int show = parseShowtime(nextToken(&cursor));
+        char* list = nextToken(&cursor);
+        int qty = (show < 0 || list == NULL) ? -1 : parseSeatCodes(list, show, requestSeats, MAX_ROWS * MAX_COLS);
+        if (qty <= 0) { reply(client, "ERR seats"); return; }
+        if (client->holdCount == SERVER_MAX_HOLDS) { reply(client, "ERR busy"); return; }
+
+        int holdId = holdSeats(qty, requestSeats, show, client->owner);
+        if (holdId < 0) { reply(client, "ERR taken"); return; }
+        trackHold(client, holdId);
+        reply(client, "OK %d", holdId);
+    }
+    else if (strcmp(verb, "COMMIT") == 0) {
+        char* id = nextToken(&cursor);
+        int show = parseShowtime(nextToken(&cursor));
+        char* list = nextToken(&cursor);
+        int qty = (id == NULL || show < 0 || list == NULL) ? -1 : parseSeatCodes(list, show, requestSeats, MAX_ROWS * MAX_COLS);
+        if (qty <= 0) { reply(client, "ERR seats"); return; }
+
+        int holdId = atoi(id);
+        forgetHold(client, holdId);
+        if (commitHeldSeats(holdId, client->owner, qty, requestSeats, show)) reply(client, "OK");
+        else reply(client, "ERR lost");
+    }
+    else if (strcmp(verb, "RELEASE") == 0) {
+        char* id = nextToken(&cursor);
+        if (id == NULL) { reply(client, "ERR hold"); return; }
+        forgetHold(client, atoi(id));
+        releaseHeldSeats(atoi(id), client->owner);
+        reply(client, "OK");
+    }
+    else if (strcmp(verb, "SAVE") == 0) {
+        int show = parseShowtime(nextToken(&cursor));
+        char* tickets = nextToken(&cursor);
+        char* extras = nextToken(&cursor);
+        char* list = nextToken(&cursor);
+        char* itemList = nextToken(&cursor); // Optional (older kiosks send none)
+        char* key = nextToken(&cursor);      // Optional as well
+        if (key != NULL && strlen(key) >= SALE_KEY_MAX) { reply(client, "ERR key"); return; }
+        if (key != NULL && strcmp(saleKeySlot(key), key) == 0) { reply(client, "OK"); return; } // Already logged
+        int qty = (show < 0 || extras == NULL || list == NULL) ? -1 : parseSeatCodes(list, show, requestSeats, MAX_ROWS * MAX_COLS);
+        if (qty <= 0) { reply(client, "ERR seats"); return; }
+        int itemCount = (itemList == NULL) ? 0 : parsePackedItems(itemList, requestItems, MAX_SALE_ITEMS);
+        if (itemCount < 0) { reply(client, "ERR items"); return; }
+        if (!queueSave(client, show, qty, itemCount, atoll(tickets), atoll(extras))) { reply(client, "ERR io"); return; }
+        snprintf(client->saleKey, sizeof(client->saleKey), "%s", (key != NULL) ? key : "");
+    }
+    else if (strcmp(verb, "TAKE") == 0 || strcmp(verb, "GIVE") == 0) {
+        char* sku = nextToken(&cursor);
+        char* count = nextToken(&cursor);
+        int item = (sku == NULL) ? -1 : findConcession(atoi(sku));
+        int qty = (count == NULL) ? 0 : atoi(count);
+        if (item < 0 || qty < 1) { reply(client, "ERR item"); return; }
+
+        if (verb[0] == 'T') {
+            if (!takeStock(item, qty)) { reply(client, "ERR stock"); return; }
+            client->stockTaken[item] += qty;
+        } else {
+            // Only what this kiosk took can come back through it
+            if (qty > client->stockTaken[item]) qty = client->stockTaken[item];
+            if (qty > 0) returnStock(item, qty);
+            client->stockTaken[item] -= qty;
+        }
+        reply(client, "OK");
+    }
+    else if (strcmp(verb, "STOCK") == 0) {
+        char text[SERVER_REPLY_MAX];
+        int used = snprintf(text, sizeof(text), "OK"), i;
+        for(i = 0; i < getNumConcessions() && used < (int)sizeof(text) - 24; i++) {
+            used += snprintf(text + used, sizeof(text) - used, " %d:%d", getConcessionItem(i)->sku, getStockLeft(i));
+        }
+        reply(client, "%s", text);
+    }
+    else if (strcmp(verb, "SALES") == 0) {
+        // The log is the source of truth (a cashout may have emptied it)
+        SalesTotals totals;
+        if (!scanSalesLog(SALES_LOG_FILE, &totals)) { reply(client, "ERR io"); return; }
+        reply(client, "OK %d %lld", totals.sales, totals.totalCentavos);
+    }
+    else {
+        reply(client, "ERR unknown");
+    }
+}
+
+// Function: processRequests
+// Purpose: Answers every complete line in the input buffer, stopping
+// early while a SAVE is pending or the reply buffer is nearly full.
+// Returns: 1 if the client is still connected.
+static int processRequests(Client* client) {
+    int start = 0;
+    while (!client->waitingForLog && client->outLen <= SERVER_OUT_MAX - SERVER_REPLY_MAX) {
+        char* newline = memchr(client->in + start, '\n', client->inLen - start);
+        if (newline == NULL) break;
+        *newline = '\0';
+        if (newline > client->in + start && newline[-1] == '\r') newline[-1] = '\0';
+        handleRequest(client, client->in + start);
+        start = (int)(newline - client->in) + 1;
+    }
+    if (start > 0) {
+        memmove(client->in, client->in + start, client->inLen - start);
+        client->inLen -= start;
+    }
+    if (client->inLen == SERVER_LINE_MAX) {
+        closeClient(client); // A request longer than any valid one
+        return 0;
+    }
+    return flushReplies(client);
+}
+
+// Function: readRequests
+// Purpose: EPOLLIN: pulls in what fits, then answers complete lines.
+static void readRequests(Client* client) {
+    ssize_t n = recv(client->fd, client->in + client->inLen, SERVER_LINE_MAX - client->inLen, 0);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        closeClient(client);
+        return;
+    }
+    if (n > 0) client->inLen += (int)n;
+    processRequests(client);
+}
+
+// Function: flushSaveBatch
+// Purpose: Writes every SAVE of this round with one appendSalesRecord()
+// (one write + one fdatasync), then answers those kiosks and lets them
+// continue with their next requests, which may start another batch.
+static void flushSaveBatch() {
+    while (batchClients != NULL) {
+        int saved = appendSalesRecord(batchRecords, sizeof(SalesRecord) * batchCount);
+        Client* client = batchClients;
+        batchClients = NULL;
+        batchCount = 0;
+
+        while (client != NULL) {
+            Client* next = client->nextWaiting;
+            client->waitingForLog = 0;
+            client->nextWaiting = NULL;
+            // Even if the kiosk is gone: it will retry this sale with its key
+            if (saved && client->saleKey[0] != '\0') strcpy(saleKeySlot(client->saleKey), client->saleKey);
+            if (client->closed) {
+                free(client);
+            } else {
+                reply(client, saved ? "OK" : "ERR io");
+                processRequests(client);
+            }
+            client = next;
+        }
+    }
+}
+
+// Function: acceptClients
+// Purpose: Takes every pending connection off the listening socket.
+static void acceptClients(int listenFd) {
+    while (1) {
+        int fd = accept(listenFd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return; // EAGAIN: no more pending (or out of descriptors)
+        }
+        Client* client = calloc(1, sizeof(Client));
+        if (client == NULL || !setNonBlocking(fd)) {
+            free(client);
+            close(fd);
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Fails harmlessly on Unix sockets
+        client->fd = fd;
+        client->owner = nextOwner++;
+        client->events = EPOLLIN;
+
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = client;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            free(client);
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// EVENT LOOP
+// ---------------------------------------------------------
+
+// Function: runBookingServer
+int runBookingServer(const char* address) {
+    int listenFd = openBookingSocket(address, 1);
+    if (listenFd < 0 || !setNonBlocking(listenFd)) {
+        fprintf(stderr, "Cannot listen on '%s'.\n", address);
+        return 1;
+    }
+    epollFd = epoll_create1(0);
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = NULL; // NULL = the listening socket
+    if (epollFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) != 0) {
+        fprintf(stderr, "Cannot start the event loop.\n");
+        close(listenFd);
+        return 1;
+    }
+
+    // Stop cleanly on Ctrl+C / kill (no SA_RESTART, so epoll_wait returns)
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handleStopSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Batching is done here, per round of events; the WAL need not wait
+    setGroupCommitWindow(0);
+    printf("THE WICKED GOOD booking server on '%s' (Ctrl+C to stop)\n", address);
+    fflush(stdout);
+
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    while (!stopRequested) {
+        int ready = epoll_wait(epollFd, events, SERVER_MAX_EVENTS, SERVER_TICK_MS);
+        int i;
+        for(i = 0; i < ready; i++) {
+            Client* client = events[i].data.ptr;
+            if (client == NULL) { acceptClients(listenFd); continue; }
+            if (client->closed) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                if (!(events[i].events & EPOLLIN)) { closeClient(client); continue; }
+            }
+            if ((events[i].events & EPOLLOUT) && !flushReplies(client)) continue;
+            if (events[i].events & EPOLLIN) readRequests(client);
+        }
+        flushSaveBatch();
+        advanceHolds();
+        if (subscribers != NULL) pushFeeds();
+    }
+
+    struct sockaddr_in tcp;
+    close(listenFd);
+    close(epollFd);
+    if (!parseTcpAddress(address, &tcp)) unlink(address); // Remove the socket file
+    printf("Booking server stopped.\n");
+    return 0;
+}
+
+#endif
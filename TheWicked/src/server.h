@@ -0,0 +1,87 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "tickets.h"
+
+// ---------------------------------------------------------
+// BOOKING SERVER
+// ---------------------------------------------------------
+// "TheWicked --server [address]" keeps the one authoritative seat
+// inventory, hold wheel and sales log, and the kiosks become thin
+// clients ("TheWicked --connect [address]", see remote.h) that ask it
+// for seat maps, holds, commits and sales.
+//
+// The server is a single thread around one epoll set: every socket is
+// non-blocking, a kiosk that is slow to read only fills its own output
+// buffer, and nothing ever waits on a lock. SAVE requests that arrive in
+// the same round of events are written to the sales log together (one
+// write, one fdatasync), then all of them are answered.
+//
+// Address: a path = Unix domain socket (default), "PORT" or "HOST:PORT"
+// = TCP (HOST defaults to 127.0.0.1; IPv4 only).
+#define BOOKING_SOCKET "wicked.sock"
+
+// Longest request or reply line (a whole hall listed seat by seat).
+#define SERVER_LINE_MAX 8192
+
+// Longest SAVE sale key, with the '\0'.
+#define SALE_KEY_MAX 48
+
+// ---------------------------------------------------------
+// PROTOCOL
+// ---------------------------------------------------------
+// One request per line, one reply line per request, in order.
+// Replies start with "OK" or "ERR <reason>". Seats are listed as
+// "A1,B12" (row letter + seat number), showtimes by index.
+//
+//   HELLO                               -> OK <showtimes> <rowWords> <layoutFingerprint>
+//   MAP <show>                          -> OK <seq> <rows> <taken> <sold> ... (hex words per row)
+//   FEED <show> <seq>                   -> OK <newSeq> [<row> <taken> <sold>] ... | ERR resync
+//   HOLD <show> <seats>                 -> OK <holdId>      | ERR taken
+//   COMMIT <holdId> <show> <seats>      -> OK               | ERR lost
+//   RELEASE <holdId>                    -> OK
+//   SAVE <show> <ticketCentavos> <extrasCentavos> <seats> [<items> [<saleKey>]]  -> OK | ERR io
+//   TAKE <sku> <qty>                    -> OK               | ERR stock
+//   GIVE <sku> <qty>                    -> OK
+//   STOCK                               -> OK <sku>:<left> ... (-1 = not counted)
+//   SALES                               -> OK <sales> <totalCentavos>
+//   PING                                -> OK
+//   SUB <show | *>                      -> OK, then pushed lines (see below)
+//
+// <seq> numbers the seat change feed of a showtime (see feed.h). FEED
+// returns the rows changed after <seq>; "ERR resync" means MAP instead.
+// After SUB the server pushes, at the end of every round of events,
+//   M <show> <seq> <rows> <taken> <sold> ...   whole map (first push, or fell behind)
+//   D <show> <seq> <row> <taken> <sold>       one changed row
+// between the replies to any further requests on that connection.
+//
+// <items> lists the concession line items as "sku:qty:unitCentavos,..."
+// or "-" (see concessions.h).
+//
+// <saleKey> (up to SALE_KEY_MAX - 1 characters) names one sale of one
+// kiosk. A kiosk that lost the reply to a SAVE sends it again with the
+// same key; if the server already wrote that sale it answers OK without
+// logging it twice. The server remembers the keys of its recent sales.
+//
+// Holds and concessions taken (TAKE) belong to the connection: a kiosk
+// that disconnects loses them.
+
+// Runs the server until SIGINT / SIGTERM.
+// Call after the inventory is restored and the sales log is open.
+// Returns: 0 after a clean shutdown, 1 if the address could not be used.
+int runBookingServer(const char* address);
+
+// Opens the socket for an address: listening (server) or connected (kiosk).
+// Returns: The socket descriptor, or -1 on error.
+int openBookingSocket(const char* address, int listening);
+
+// Writes "A1,B12,..." for a list of seats.
+// Returns: 1 on success, 0 if the buffer is too small.
+int formatSeatCodes(int qty, const SeatSelection* seats, char* buffer, int size);
+
+// Reads "A1,B12,..." (seats that exist in the hall, none listed twice).
+// Fills r / c / rowChar / type / price of up to 'max' seats.
+// Returns: Number of seats, or -1 if the list is invalid or too long.
+int parseSeatCodes(char* list, int showtimeIndex, SeatSelection* seats, int max);
+
+#endif
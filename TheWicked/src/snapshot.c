@@ -0,0 +1,334 @@
+// Request POSIX declarations (fsync, pthreads) in strict C99 mode.
+// Must come before the first system header.
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include "snapshot.h"
+#include "hall.h"
+#include "catalog.h"
+#include "inventory.h"
+#include "wal.h"
+#include "salesrec.h"
+#include "utilities.h"
+
+// ---------------------------------------------------------
+// OS-SPECIFIC FILE I/O
+// ---------------------------------------------------------
+#ifdef _WIN32
+    #include <io.h>
+    #define write _write
+    #define close _close
+    #define fsync(fd) _commit(fd)
+    #define SNAP_WRITE_FLAGS (O_WRONLY | O_CREAT | O_TRUNC | O_BINARY)
+#else
+    #include <unistd.h>
+    #define SNAP_WRITE_FLAGS (O_WRONLY | O_CREAT | O_TRUNC)
+#endif
+
+// ---------------------------------------------------------
+// FILE FORMAT
+// ---------------------------------------------------------
+// [SnapshotHeader][wordCount x SeatWord]
+// The words are the sold bits in arena order (showtime-major), exactly
+// as copySoldWords() hands them out. The header is 56 bytes, so the
+// words that follow stay 8-byte aligned inside the mapping.
+#define SNAPSHOT_MAGIC "WKSNAP\r\n"  // The CR/LF catches text-mode mangling
+#define SNAPSHOT_VERSION 2           // 2: 'rows' became 'scheduleDate'
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t showtimes;
+    uint32_t scheduleDate;   // getScheduleDate() of the showtimes the words belong to
+    uint32_t wordCount;
+    uint64_t layoutHash;     // getLayoutFingerprint() of the halls the words belong to
+    int64_t logOffset;       // Sales log bytes already reflected in the words
+    int64_t createdAt;       // Wall clock (seconds since epoch), informational
+    uint64_t checksum;       // FNV-1a over the words
+} SnapshotHeader;
+
+// ---------------------------------------------------------
+// WRITER STATE
+// ---------------------------------------------------------
+static pthread_mutex_t snapMutex = PTHREAD_MUTEX_INITIALIZER;   // One writer at a time
+static pthread_mutex_t writerMutex = PTHREAD_MUTEX_INITIALIZER; // Guards the fields below
+static pthread_cond_t writerWake = PTHREAD_COND_INITIALIZER;
+static pthread_t writerThread;
+static int writerRunning = 0;
+static int writerStop = 0;
+static int writerRequested = 0;
+static int writerIntervalMs = SNAPSHOT_INTERVAL_MS;
+static char writerPath[256] = SNAPSHOT_FILE;
+static unsigned long long savedVersion = 0; // Inventory version in the last snapshot
+static int haveSaved = 0;
+
+// ---------------------------------------------------------
+// HELPERS
+// ---------------------------------------------------------
+
+// Function: fnv1a
+// Purpose: Small, fast 64-bit hash used for the checksum of the words.
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t length) {
+    const unsigned char* p = data;
+    size_t i;
+    for(i = 0; i < length; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Function: writeAll
+// Purpose: write() may write less than asked; loop until everything is out.
+static int writeAll(int fd, const void* data, size_t length) {
+    const char* p = data;
+    while (length > 0) {
+        long n = (long)write(fd, p, (unsigned)length);
+        if (n <= 0) return 0;
+        p += n;
+        length -= (size_t)n;
+    }
+    return 1;
+}
+
+// Function: loadSnapshot
+// Purpose: Validates the snapshot and copies its sold bits into the inventory.
+// Returns: The log offset it covers, or 0 if there is no usable snapshot.
+static long long loadSnapshot(const char* path) {
+    size_t size = 0;
+    void* data = mapFileReadOnly(path, &size);
+    if (data == NULL) return 0;
+
+    const SnapshotHeader* header = data;
+    const SeatWord* words = (const SeatWord*)(header + 1);
+    long long offset = 0;
+
+    int valid = size >= sizeof(SnapshotHeader)
+             && memcmp(header->magic, SNAPSHOT_MAGIC, 8) == 0
+             && header->version == SNAPSHOT_VERSION
+             && header->showtimes == (uint32_t)getNumShowtimes()
+             && header->scheduleDate == (uint32_t)getScheduleDate()
+             && header->wordCount == (uint32_t)getInventoryWordCount()
+             && header->layoutHash == getLayoutFingerprint()
+             && size >= sizeof(SnapshotHeader) + sizeof(SeatWord) * header->wordCount;
+    if (valid) {
+        size_t bytes = sizeof(SeatWord) * header->wordCount;
+        valid = fnv1a(14695981039346656037ULL, words, bytes) == header->checksum;
+    }
+
+    if (valid) {
+        restoreSoldWords(words, (int)header->wordCount);
+        offset = header->logOffset;
+    }
+    unmapFile(data, size);
+    return offset;
+}
+
+// Function: getScheduleDayUs
+// Purpose: The local day of the loaded schedule, as [from, to) in
+// microseconds since 1970 (the time unit of the sales records).
+static void getScheduleDayUs(long long* fromUs, long long* toUs) {
+    int date = getScheduleDate();
+    struct tm day;
+    memset(&day, 0, sizeof(day));
+    day.tm_year = date / 10000 - 1900;
+    day.tm_mon = date / 100 % 100 - 1;
+    day.tm_mday = date % 100;
+    day.tm_isdst = -1;
+    *fromUs = (long long)mktime(&day) * 1000000LL;
+    day.tm_mday++; // mktime normalizes the 32nd and finds DST changes
+    day.tm_isdst = -1;
+    *toUs = (long long)mktime(&day) * 1000000LL;
+}
+
+// Function: replaySale
+// Purpose: Re-applies the seats of one SALE record (and its followers)
+// if it was sold on the schedule's day [fromUs, toUs).
+static int replaySale(const SalesView* view, long long index, long long fromUs, long long toUs) {
+    const SalesRecord* rec = &view->records[index];
+    if (rec->kind != REC_SALE || rec->showtime >= getNumShowtimes()) return 0;
+    if (rec->body.sale.timeUs < fromUs || rec->body.sale.timeUs >= toUs) return 0; // Another day's show
+
+    PackedSeat seats[MAX_ROWS * MAX_COLS];
+    int count = getSaleSeats(view, index, seats, MAX_ROWS * MAX_COLS);
+
+    SeatWord masks[MAX_ROWS];
+    memset(masks, 0, sizeof(masks));
+    int i;
+    for(i = 0; i < count; i++) {
+        if (seatExists(rec->showtime, seats[i].row, seats[i].col)) {
+            masks[seats[i].row] |= (SeatWord)1 << seats[i].col;
+        }
+    }
+    sellRowMasks(rec->showtime, masks);
+    return 1;
+}
+
+// Function: replayLog
+// Purpose: Replays every complete sale of the log from byte 'offset' on.
+// A sale missing part of its records was cut off by a crash and was never
+// reported as saved, so it is skipped. Sales of other days (a log not yet
+// cashed out) are skipped too: their showtimes are not today's.
+static int replayLog(const char* path, long long offset) {
+    long long fromUs, toUs;
+    getScheduleDayUs(&fromUs, &toUs);
+
+    SalesView view;
+    if (!mapSalesFile(path, &view)) return 0;
+
+    // If the log is shorter than the snapshot thinks, it was trimmed by a
+    // cashout after the snapshot: everything in it is new.
+    long long first = (offset - salesRecordOffset(0)) / SALES_RECORD_SIZE;
+    if (first < 0 || offset > (long long)view.size) first = 0;
+
+    int replayed = 0;
+    long long i;
+    for(i = first; i < view.count && isSalesRecordComplete(&view, i); i = nextSalesRecord(&view, i)) {
+        replayed += replaySale(&view, i, fromUs, toUs);
+    }
+    unmapSalesFile(&view);
+    return replayed;
+}
+
+// Function: snapshotIsStale
+// Purpose: 1 if seats were sold since the last snapshot on disk.
+static int snapshotIsStale() {
+    pthread_mutex_lock(&snapMutex);
+    int stale = !haveSaved || getInventoryVersion() != savedVersion;
+    pthread_mutex_unlock(&snapMutex);
+    return stale;
+}
+
+// Function: writerMain
+// Purpose: Background loop. Sleeps for the interval (or until woken),
+// then writes a snapshot if anything was sold since the last one.
+static void* writerMain(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&writerMutex);
+    while (!writerStop) {
+        if (!writerRequested) {
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_sec += writerIntervalMs / 1000;
+            until.tv_nsec += (long)(writerIntervalMs % 1000) * 1000000L;
+            if (until.tv_nsec >= 1000000000L) { until.tv_sec++; until.tv_nsec -= 1000000000L; }
+            pthread_cond_timedwait(&writerWake, &writerMutex, &until);
+        }
+        if (writerStop) break;
+        writerRequested = 0;
+
+        // Write without holding writerMutex so requestSnapshot() never blocks
+        pthread_mutex_unlock(&writerMutex);
+        if (snapshotIsStale()) writeSnapshot(writerPath);
+        pthread_mutex_lock(&writerMutex);
+    }
+    pthread_mutex_unlock(&writerMutex);
+    return NULL;
+}
+
+// ---------------------------------------------------------
+// PUBLIC API
+// ---------------------------------------------------------
+
+// Function: restoreInventory
+// Purpose: Startup recovery: snapshot first (a single memcpy-sized job),
+// then only the sales logged after it.
+int restoreInventory(const char* snapshotPath, const char* logPath) {
+    long long offset = loadSnapshot(snapshotPath);
+    return replayLog(logPath, offset);
+}
+
+// Function: writeSnapshot
+// Purpose: tmp file -> write -> fsync -> rename.
+// The log offset is read BEFORE the words are copied. Seats are marked sold
+// before their log record is appended, so every record below that offset is
+// already in the words; records after it are replayed on restart.
+int writeSnapshot(const char* path) {
+    if (!isSalesLogOpen()) return 0;
+
+    pthread_mutex_lock(&snapMutex);
+    int count = getInventoryWordCount();
+    SeatWord* words = malloc(sizeof(SeatWord) * (count > 0 ? count : 1));
+    if (words == NULL) { pthread_mutex_unlock(&snapMutex); return 0; }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+    header.version = SNAPSHOT_VERSION;
+    header.showtimes = (uint32_t)getNumShowtimes();
+    header.scheduleDate = (uint32_t)getScheduleDate();
+    header.wordCount = (uint32_t)count;
+    header.layoutHash = getLayoutFingerprint();
+    header.createdAt = (int64_t)time(NULL);
+
+    header.logOffset = getSalesLogDurableSize();
+    unsigned long long version = getInventoryVersion();
+    copySoldWords(words);
+    header.checksum = fnv1a(14695981039346656037ULL, words, sizeof(SeatWord) * count);
+
+    char tmpPath[300];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    int ok = 0;
+    int fd = open(tmpPath, SNAP_WRITE_FLAGS, 0644);
+    if (fd >= 0) {
+        ok = writeAll(fd, &header, sizeof(header))
+          && writeAll(fd, words, sizeof(SeatWord) * count)
+          && fsync(fd) == 0;
+        close(fd);
+        ok = ok && replaceFileAtomically(tmpPath, path);
+        if (!ok) remove(tmpPath);
+    }
+    free(words);
+
+    if (ok) {
+        savedVersion = version;
+        haveSaved = 1;
+    }
+    pthread_mutex_unlock(&snapMutex);
+    return ok;
+}
+
+// Function: startSnapshotWriter
+// Purpose: Launches the background thread (kiosks never wait on snapshot I/O).
+void startSnapshotWriter(const char* path, int intervalMs) {
+    pthread_mutex_lock(&writerMutex);
+    if (!writerRunning) {
+        snprintf(writerPath, sizeof(writerPath), "%s", path);
+        writerIntervalMs = (intervalMs > 0) ? intervalMs : SNAPSHOT_INTERVAL_MS;
+        writerStop = 0;
+        writerRequested = 0;
+        writerRunning = (pthread_create(&writerThread, NULL, writerMain, NULL) == 0);
+    }
+    pthread_mutex_unlock(&writerMutex);
+}
+
+// Function: requestSnapshot
+// Purpose: Wakes the writer early (e.g. right after a big group sale).
+void requestSnapshot() {
+    pthread_mutex_lock(&writerMutex);
+    writerRequested = 1;
+    pthread_cond_signal(&writerWake);
+    pthread_mutex_unlock(&writerMutex);
+}
+
+// Function: stopSnapshotWriter
+// Purpose: Clean shutdown: stop the thread, then save the final state.
+void stopSnapshotWriter() {
+    pthread_mutex_lock(&writerMutex);
+    int wasRunning = writerRunning;
+    writerStop = 1;
+    pthread_cond_signal(&writerWake);
+    pthread_mutex_unlock(&writerMutex);
+
+    if (wasRunning) {
+        pthread_join(writerThread, NULL);
+        writerRunning = 0;
+        writeSnapshot(writerPath);
+    }
+}
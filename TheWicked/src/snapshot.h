@@ -0,0 +1,43 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+// ---------------------------------------------------------
+// CRASH-SAFE INVENTORY SNAPSHOTS
+// ---------------------------------------------------------
+// Every few seconds a background thread copies the sold-seat words to
+// 'inventory.snap'. The file is written under a temporary name, synced,
+// then renamed over the old one, so a crash mid-write never leaves a
+// half-written snapshot behind.
+//
+// The snapshot also records how far the sales log had been synced at
+// that moment. On startup we map the snapshot straight into memory,
+// copy the words into the inventory, and replay only the log records
+// written after it. Replaying a sale twice is harmless (it just sets
+// bits that are already set).
+//
+// Seats belong to one day's schedule: the snapshot records the schedule
+// date (see getScheduleDate) and is ignored on any other day, and only the
+// log's sales made on that day are replayed. So a new day (or a new dated
+// catalog with the same halls) always opens with every seat free.
+#define SNAPSHOT_FILE "inventory.snap"
+#define SNAPSHOT_INTERVAL_MS 10000   // How often the writer checks for new sales
+
+// Restores sold seats from the snapshot, then replays the log tail.
+// Call after initSeats() and before the first sale.
+// Returns: Number of log records replayed (0 if the snapshot was current).
+int restoreInventory(const char* snapshotPath, const char* logPath);
+
+// Writes a snapshot right now (blocks until it is on disk).
+// Returns: 1 on success, 0 on I/O error or if the sales log is not open.
+int writeSnapshot(const char* path);
+
+// Starts the background writer (one snapshot per interval, only if something sold).
+void startSnapshotWriter(const char* path, int intervalMs);
+
+// Asks the writer to take a snapshot soon without waiting for it.
+void requestSnapshot();
+
+// Stops the writer after one final snapshot.
+void stopSnapshotWriter();
+
+#endif
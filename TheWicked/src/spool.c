@@ -0,0 +1,207 @@
+// Request POSIX declarations (pthreads) in strict C99 mode.
+// Must come before the first system header.
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "spool.h"
+#include "money.h"
+#include "utilities.h"
+
+// ---------------------------------------------------------
+// OS-SPECIFIC DIRECTORIES
+// ---------------------------------------------------------
+#ifdef _WIN32
+    #include <direct.h>
+    #define makeDirectory(path) _mkdir(path)
+#else
+    #include <sys/stat.h>
+    #define makeDirectory(path) mkdir(path, 0755)
+#endif
+
+// ---------------------------------------------------------
+// DATA STRUCTURE: The Spool Ring
+// ---------------------------------------------------------
+// 'head' is the next job to print, 'count' the jobs waiting after it.
+// The kiosk only ever waits on notFull and the renderer on notEmpty.
+static TicketJob ring[TICKET_SPOOL_SLOTS];
+static int ringHead = 0;
+static int ringCount = 0;
+static int rendering = 0;            // The renderer is writing a job it took off the ring
+
+static pthread_mutex_t spoolMutex = PTHREAD_MUTEX_INITIALIZER; // Guards everything above and below
+static pthread_cond_t notFull = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t notEmpty = PTHREAD_COND_INITIALIZER;
+static pthread_t spoolThread;
+static int spoolRunning = 0;
+static int spoolStop = 0;
+static char spoolDir[256] = TICKET_SPOOL_DIR;
+static int unrecordedTickets = 0;    // Printed although their id could not be recorded
+
+#define RECORD_ATTEMPTS 3            // Tries to record a ticket id before printing it anyway
+
+// ---------------------------------------------------------
+// RENDERING
+// ---------------------------------------------------------
+
+// Function: renderTicket
+// Purpose: Records the ticket id (see ticketid.h), then writes the ticket
+// as a plain-text document (the same box the kiosk used to draw on screen,
+// without the colours). The customer has paid, so a ticket whose id could
+// not be recorded (ticket index full, id file not writable) is printed
+// anyway, marked for the usher, and counted (getUnrecordedTicketCount).
+// Returns: 1 if the ticket file is complete, 0 if it could not be written.
+static int renderTicket(const char* dir, const TicketJob* job) {
+    char idText[TICKET_ID_TEXT], path[320], tmpPath[330];
+    formatTicketId(job->ticketId, idText);
+    snprintf(path, sizeof(path), "%s/ticket-%s.txt", dir, idText);
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+
+    int recorded = 0, attempt;
+    for(attempt = 0; attempt < RECORD_ATTEMPTS && !recorded; attempt++) recorded = saveTicketId(job->ticketId);
+    if (!recorded) {
+        pthread_mutex_lock(&spoolMutex);
+        unrecordedTickets++;
+        pthread_mutex_unlock(&spoolMutex);
+    }
+
+    FILE* file = fopen(tmpPath, "w");
+    if (file == NULL) return 0;
+
+    char price[MONEY_TEXT_MAX];
+    formatMoney(job->seat.price, price, sizeof(price));
+    const char* tag = (job->seat.type == TYPE_VIP) ? "[ VIP ACCESS ]" : "[ STD ADMIT  ]";
+
+    fprintf(file, "+--------------------------------------------+\n");
+    fprintf(file, "|               THE WICKED GOOD              |\n");
+    fprintf(file, "|           TICKET #%s            |\n", idText);
+    fprintf(file, "|--------------------------------------------|\n");
+    fprintf(file, "|     Seat: %c-%02d           Price: PHP%-6s  |\n", job->seat.rowChar, job->seat.c + 1, price);
+    fprintf(file, "|          %16s                  |\n", job->time);
+    fprintf(file, "|               %s               |\n", tag);
+    fprintf(file, "|                Ticket %2d of %-2d             |\n", job->index, job->count);
+    if (!recorded) fprintf(file, "|       NOT RECORDED: SHOW RECEIPT AT DOOR   |\n");
+    fprintf(file, "+--------------------------------------------+\n");
+
+    int ok = (fclose(file) == 0);
+    if (!ok || !replaceFileAtomically(tmpPath, path)) {
+        remove(tmpPath);
+        return 0;
+    }
+    return 1;
+}
+
+// Function: spoolMain
+// Purpose: Background loop. Takes one job at a time off the ring and
+// renders it without holding the lock, so the kiosk can keep queueing.
+// On stop it finishes whatever is still queued before returning.
+static void* spoolMain(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&spoolMutex);
+    for (;;) {
+        while (ringCount == 0 && !spoolStop) pthread_cond_wait(&notEmpty, &spoolMutex);
+        if (ringCount == 0) break; // Stopped and drained
+
+        TicketJob job = ring[ringHead];
+        ringHead = (ringHead + 1) % TICKET_SPOOL_SLOTS;
+        ringCount--;
+        rendering = 1;
+        pthread_cond_signal(&notFull);
+        pthread_mutex_unlock(&spoolMutex);
+
+        renderTicket(spoolDir, &job);
+
+        pthread_mutex_lock(&spoolMutex);
+        rendering = 0;
+    }
+    pthread_mutex_unlock(&spoolMutex);
+    return NULL;
+}
+
+// ---------------------------------------------------------
+// PUBLIC API
+// ---------------------------------------------------------
+
+// Function: startTicketSpooler
+int startTicketSpooler(const char* dir) {
+    pthread_mutex_lock(&spoolMutex);
+    if (!spoolRunning) {
+        snprintf(spoolDir, sizeof(spoolDir), "%s", dir);
+        makeDirectory(spoolDir); // Fails harmlessly if it already exists
+        ringHead = 0;
+        ringCount = 0;
+        spoolStop = 0;
+        spoolRunning = (pthread_create(&spoolThread, NULL, spoolMain, NULL) == 0);
+    }
+    int running = spoolRunning;
+    pthread_mutex_unlock(&spoolMutex);
+    return running;
+}
+
+// Function: spoolTickets
+// Purpose: Fills in one job per seat (with a fresh ticket id) and puts it
+// on the ring, waiting for a free slot whenever the renderer is behind.
+int spoolTickets(int showtimeIndex, int qty, const SeatSelection* seats, const char* timeStr) {
+    int handed = 0, i;
+
+    for(i = 0; i < qty; i++) {
+        TicketJob job;
+        job.seat = seats[i];
+        job.ticketId = issueTicketId(showtimeIndex, &seats[i]);
+        job.showtimeIndex = showtimeIndex;
+        job.index = i + 1;
+        job.count = qty;
+        snprintf(job.time, sizeof(job.time), "%s", timeStr);
+
+        pthread_mutex_lock(&spoolMutex);
+        if (!spoolRunning) {
+            // No renderer thread: print it here (slower, but nothing is lost)
+            pthread_mutex_unlock(&spoolMutex);
+            makeDirectory(spoolDir);
+            handed += renderTicket(spoolDir, &job);
+            continue;
+        }
+        while (ringCount == TICKET_SPOOL_SLOTS) pthread_cond_wait(&notFull, &spoolMutex);
+        ring[(ringHead + ringCount) % TICKET_SPOOL_SLOTS] = job;
+        ringCount++;
+        pthread_cond_signal(&notEmpty);
+        pthread_mutex_unlock(&spoolMutex);
+        handed++;
+    }
+    return handed;
+}
+
+// Function: getPendingTicketCount
+int getPendingTicketCount() {
+    pthread_mutex_lock(&spoolMutex);
+    int pending = ringCount + rendering;
+    pthread_mutex_unlock(&spoolMutex);
+    return pending;
+}
+
+// Function: getUnrecordedTicketCount
+int getUnrecordedTicketCount() {
+    pthread_mutex_lock(&spoolMutex);
+    int count = unrecordedTickets;
+    pthread_mutex_unlock(&spoolMutex);
+    return count;
+}
+
+// Function: stopTicketSpooler
+// Purpose: Clean shutdown: the renderer drains the ring, then exits.
+void stopTicketSpooler() {
+    pthread_mutex_lock(&spoolMutex);
+    int wasRunning = spoolRunning;
+    spoolStop = 1;
+    pthread_cond_signal(&notEmpty);
+    pthread_mutex_unlock(&spoolMutex);
+
+    if (wasRunning) {
+        pthread_join(spoolThread, NULL);
+        pthread_mutex_lock(&spoolMutex);
+        spoolRunning = 0;
+        pthread_mutex_unlock(&spoolMutex);
+    }
+}
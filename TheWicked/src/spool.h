@@ -0,0 +1,61 @@
+#ifndef SPOOL_H
+#define SPOOL_H
+
+#include "tickets.h"
+#include "ticketid.h"
+
+// ---------------------------------------------------------
+// TICKET SPOOLER
+// ---------------------------------------------------------
+// The kiosk used to draw every ticket on screen and then wait 3 seconds
+// per ticket to "print" it, so a party of 24 blocked the kiosk for over a
+// minute. Now the tickets of a sale are handed to a spooler and the kiosk
+// moves on to the receipt (and the next customer) at once:
+//
+//   kiosk --> [ ring of TICKET_SPOOL_SLOTS jobs ] --> renderer thread --> ticket_spool/
+//
+// The ring is a bounded producer/consumer queue (one mutex, two condition
+// variables). When it is full the kiosk waits for a free slot, so a
+// jammed printer slows sales down instead of eating memory.
+// The renderer records each job's ticket id (see ticketid.h), turns the job
+// into a plain-text ticket and writes it into the spool directory, one
+// file per ticket ("ticket-<ticket id>.txt"). A ticket whose id could not
+// be recorded is still printed, marked for the usher, and counted.
+// The file is written under a temporary name and renamed when complete, so
+// the counter's print daemon (or an operator) never picks up half a ticket.
+#define TICKET_SPOOL_DIR "ticket_spool"
+#define TICKET_SPOOL_SLOTS 64
+
+// One ticket to print.
+typedef struct {
+    SeatSelection seat;
+    TicketId ticketId;       // Issued when the job is queued
+    int showtimeIndex;
+    int index;               // 1-based position in the sale ("Ticket 2 of 5")
+    int count;
+    char time[20];           // Showtime printed on the ticket, e.g. "10:30 AM"
+} TicketJob;
+
+// Creates the spool directory and starts the renderer thread.
+// Returns: 1 if the spooler is running, 0 if not (tickets are then
+// written by the kiosk itself, see spoolTickets).
+int startTicketSpooler(const char* dir);
+
+// Issues a ticket id for every seat of a sale and queues one ticket per
+// seat. Returns once every job is in the
+// ring (it only waits while the ring is full), not when they are printed.
+// Without a running spooler the tickets are written right away instead.
+// Returns: Number of tickets handed over (the others could not be written).
+int spoolTickets(int showtimeIndex, int qty, const SeatSelection* seats, const char* timeStr);
+
+// Tickets queued but not written yet.
+int getPendingTicketCount();
+
+// Tickets printed this session whose id could not be recorded, so the
+// Ticket Check will not know them (they are marked on the ticket).
+int getUnrecordedTicketCount();
+
+// Prints everything still queued, then stops the renderer thread.
+void stopTicketSpooler();
+
+#endif
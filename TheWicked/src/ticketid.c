@@ -0,0 +1,402 @@
+// Request POSIX declarations (pthreads) in strict C99 mode.
+// Must come before the first system header.
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include "ticketid.h"
+#include "utilities.h"
+
+// ---------------------------------------------------------
+// OS-SPECIFIC FILE LOCKS
+// ---------------------------------------------------------
+// A shard is taken by locking byte <shard> of "<id file>.lock". The lock
+// belongs to the process, so it goes away by itself if the kiosk crashes.
+// Byte ADMIT_LOCK_BYTE, just past the shards, is held by the kiosk that is
+// admitting a ticket, so two doors cannot both admit it.
+#ifdef _WIN32
+    #include <io.h>
+    #include <windows.h>
+    #define close _close
+    #define LOCK_OPEN_FLAGS (O_RDWR | O_CREAT | O_BINARY)
+#else
+    #include <unistd.h>
+    #define LOCK_OPEN_FLAGS (O_RDWR | O_CREAT)
+#endif
+
+// ---------------------------------------------------------
+// DATA STRUCTURE: Shard Clocks & The Index
+// ---------------------------------------------------------
+// A shard clock holds the last (ms << TICKET_SEQ_BITS | sequence) it
+// issued, i.e. the id without its shard bits. One cache line per shard so
+// kiosk threads issuing on different shards never share a line.
+typedef struct {
+    uint64_t clock;
+    char pad[56];
+} ShardClock;
+
+#define SEQ_MASK ((1ULL << TICKET_SEQ_BITS) - 1)
+#define SHARD_MASK ((1ULL << TICKET_SHARD_BITS) - 1)
+#define INDEX_MASK (TICKET_INDEX_SLOTS - 1)
+#define ADMIT_LOCK_BYTE MAX_TICKET_SHARDS
+
+static ShardClock shardClocks[MAX_TICKET_SHARDS];
+static int kioskShard = 0;
+static int lockFd = -1;             // Holds the lock on our shard
+
+// An entry is claimed by a CAS on 'id' (0 = empty) and published by the
+// release store of 'status' (0 = still being filled in, not visible yet).
+static TicketRecord ticketIndex[TICKET_INDEX_SLOTS];
+
+// The file: appends, and reading the other kiosks' appends, one at a time.
+static pthread_mutex_t fileMutex = PTHREAD_MUTEX_INITIALIZER;
+static FILE* ticketFile = NULL;     // Appends
+static FILE* readFile = NULL;       // Reads (kept open: a check costs one read at the end)
+static char ticketPath[256] = "";
+static long readOffset = 0;          // Bytes of the file already in the index
+static long long dayStartMs = 0;     // Older tickets are not loaded
+
+static const char BASE32[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ"; // Crockford
+
+// ---------------------------------------------------------
+// HELPERS
+// ---------------------------------------------------------
+
+// Function: mixId
+// Purpose: Spreads the id bits over the table (ids of one kiosk differ
+// mostly in their low bits). Finalizer of splitmix64.
+static uint64_t mixId(uint64_t id) {
+    id ^= id >> 30; id *= 0xBF58476D1CE4E5B9ULL;
+    id ^= id >> 27; id *= 0x94D049BB133111EBULL;
+    return id ^ (id >> 31);
+}
+
+// Function: findSlot
+// Purpose: Linear probing from the id's home slot. With 'claim', an empty
+// slot on the way is taken for the id.
+// Returns: The slot holding (or now reserved for) the id, NULL if absent
+// (or, with 'claim', if the table is full).
+static TicketRecord* findSlot(uint64_t id, int claim) {
+    uint64_t i = mixId(id) & INDEX_MASK;
+    int probes;
+    for(probes = 0; probes < TICKET_INDEX_SLOTS; probes++) {
+        TicketRecord* slot = &ticketIndex[i];
+        uint64_t key = __atomic_load_n(&slot->id, __ATOMIC_ACQUIRE);
+        if (key == id) return slot;
+        if (key == 0) {
+            if (!claim) return NULL;
+            uint64_t expected = 0;
+            if (__atomic_compare_exchange_n(&slot->id, &expected, id, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ||
+                expected == id) {
+                return slot;
+            }
+        }
+        i = (i + 1) & INDEX_MASK;
+    }
+    return NULL;
+}
+
+// Function: raiseStatus
+// Purpose: Moves a slot's status forward (never back: an admitted ticket
+// stays admitted whatever order the records arrive in).
+// Returns: 1 if the status changed.
+static int raiseStatus(TicketRecord* slot, uint8_t status) {
+    uint8_t current = __atomic_load_n(&slot->status, __ATOMIC_ACQUIRE);
+    while (current < status) {
+        if (__atomic_compare_exchange_n(&slot->status, &current, status, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Function: clockOf
+// Purpose: The shard clock value an id was issued at (the id without its shard).
+static uint64_t clockOf(uint64_t id) {
+    return ((id >> (TICKET_SHARD_BITS + TICKET_SEQ_BITS)) << TICKET_SEQ_BITS) | (id & SEQ_MASK);
+}
+
+// Function: raiseClock
+// Purpose: Makes a shard clock at least 'value' (ids loaded from the file
+// after a restart, so a clock that stepped back cannot reissue them).
+static void raiseClock(int shard, uint64_t value) {
+    uint64_t current = __atomic_load_n(&shardClocks[shard].clock, __ATOMIC_RELAXED);
+    while (current < value &&
+           !__atomic_compare_exchange_n(&shardClocks[shard].clock, &current, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// Function: addRecord
+// Purpose: Puts a record into the index, or raises the status of the
+// entry already there.
+// Returns: 1 if the ticket is new to the index.
+static int addRecord(const TicketRecord* record) {
+    TicketRecord* slot = findSlot(record->id, 1);
+    if (slot == NULL) return 0;
+
+    // Only the thread that claimed the slot sees status 0 and fills it in
+    // (records of one id always carry the same seat)
+    if (__atomic_load_n(&slot->status, __ATOMIC_ACQUIRE) == 0) {
+        slot->showtimeIndex = record->showtimeIndex;
+        slot->row = record->row;
+        slot->col = record->col;
+        return raiseStatus(slot, record->status);
+    }
+    raiseStatus(slot, record->status);
+    return 0;
+}
+
+// Function: lockShard
+// Purpose: Tries to take the lock byte of one shard (without waiting).
+// Returns: 1 if this kiosk now owns the shard, 0 if another kiosk does.
+static int lockShard(int fd, int shard) {
+    #ifdef _WIN32
+        HANDLE handle = (HANDLE)_get_osfhandle(fd);
+        return LockFile(handle, (DWORD)shard, 0, 1, 0) != 0;
+    #else
+        struct flock lock;
+        memset(&lock, 0, sizeof(lock));
+        lock.l_type = F_WRLCK;
+        lock.l_whence = SEEK_SET;
+        lock.l_start = shard;
+        lock.l_len = 1;
+        return fcntl(fd, F_SETLK, &lock) == 0;
+    #endif
+}
+
+// Function: lockAdmits
+// Purpose: Takes (waiting for other kiosks) or gives back the admit byte
+// of the lock file. Caller holds fileMutex (the lock is per process).
+static void lockAdmits(int take) {
+    if (lockFd < 0) return; // No lock file: only this process checks tickets
+    #ifdef _WIN32
+        HANDLE handle = (HANDLE)_get_osfhandle(lockFd);
+        OVERLAPPED at;
+        memset(&at, 0, sizeof(at));
+        at.Offset = ADMIT_LOCK_BYTE;
+        if (take) LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &at);
+        else UnlockFileEx(handle, 0, 1, 0, &at);
+    #else
+        struct flock lock;
+        memset(&lock, 0, sizeof(lock));
+        lock.l_type = take ? F_WRLCK : F_UNLCK;
+        lock.l_whence = SEEK_SET;
+        lock.l_start = ADMIT_LOCK_BYTE;
+        lock.l_len = 1;
+        while (fcntl(lockFd, F_SETLKW, &lock) != 0 && errno == EINTR) { }
+    #endif
+}
+
+// Function: claimShard
+// Purpose: Takes 'shard' (or, with -1, the lowest shard no other kiosk
+// using the same id file holds) for this kiosk.
+// Returns: The shard, or -1 if it is (they are all) in use.
+static int claimShard(const char* path, int shard) {
+    char lockPath[270];
+    snprintf(lockPath, sizeof(lockPath), "%s.lock", path);
+    if (lockFd >= 0) close(lockFd); // Closing drops our old lock
+    lockFd = open(lockPath, LOCK_OPEN_FLAGS, 0644);
+    if (lockFd < 0) return -1;
+
+    int first = (shard >= 0) ? shard : 0;
+    int last = (shard >= 0) ? shard : MAX_TICKET_SHARDS - 1;
+    for(shard = first; shard <= last; shard++) {
+        if (lockShard(lockFd, shard)) return shard;
+    }
+    close(lockFd);
+    lockFd = -1;
+    return -1;
+}
+
+// Function: catchUpFile
+// Purpose: Adds the records appended to the file since the last call
+// (by this kiosk or by others). Caller holds fileMutex.
+// Returns: Number of tickets new to the index.
+static int catchUpFile() {
+    if (readFile == NULL && (ticketPath[0] == '\0' || (readFile = fopen(ticketPath, "rb")) == NULL)) return 0;
+
+    int added = 0;
+    TicketRecord record;
+    // The seek drops what stdio buffered, so records appended since are seen
+    if (fseek(readFile, readOffset, SEEK_SET) == 0) {
+        while (fread(&record, sizeof(record), 1, readFile) == 1) {
+            readOffset += (long)sizeof(record);
+            if (record.id == 0 || record.status == TICKET_UNKNOWN) continue;
+            raiseClock(getTicketShard(record.id), clockOf(record.id));
+            if (getTicketIssuedMs(record.id) < dayStartMs) continue; // Yesterday's show
+            added += addRecord(&record);
+        }
+    }
+    return added;
+}
+
+// Function: appendRecord
+// Purpose: Writes a copy of an index entry to the file. Caller holds fileMutex.
+static int appendRecord(const TicketRecord* slot) {
+    if (ticketFile == NULL) return 0;
+    TicketRecord record;
+    memset(&record, 0, sizeof(record));
+    record.id = slot->id;
+    record.showtimeIndex = slot->showtimeIndex;
+    record.row = slot->row;
+    record.col = slot->col;
+    record.status = __atomic_load_n(&slot->status, __ATOMIC_ACQUIRE);
+    return fwrite(&record, sizeof(record), 1, ticketFile) == 1 && fflush(ticketFile) == 0;
+}
+
+// ---------------------------------------------------------
+// PUBLIC API
+// ---------------------------------------------------------
+
+// Function: openTicketIds
+int openTicketIds(const char* path, int shard) {
+    if (shard >= MAX_TICKET_SHARDS) return -1;
+    shard = claimShard(path, shard);
+    if (shard < 0) return -1;
+    kioskShard = shard;
+
+    // Local midnight: tickets sold before today are for shows already over
+    time_t now = time(NULL);
+    struct tm midnight = *localtime(&now);
+    midnight.tm_hour = 0;
+    midnight.tm_min = 0;
+    midnight.tm_sec = 0;
+    dayStartMs = (long long)mktime(&midnight) * 1000;
+
+    pthread_mutex_lock(&fileMutex);
+    snprintf(ticketPath, sizeof(ticketPath), "%s", path);
+    if (ticketFile == NULL) ticketFile = fopen(ticketPath, "ab"); // Creates it for the reader
+    if (readFile != NULL) fclose(readFile);
+    readFile = NULL;
+    readOffset = 0;
+    int loaded = catchUpFile();
+    pthread_mutex_unlock(&fileMutex);
+    return loaded;
+}
+
+// Function: closeTicketIds
+void closeTicketIds() {
+    pthread_mutex_lock(&fileMutex);
+    if (ticketFile != NULL) fclose(ticketFile);
+    if (readFile != NULL) fclose(readFile);
+    ticketFile = NULL;
+    readFile = NULL;
+    if (lockFd >= 0) close(lockFd);
+    lockFd = -1;
+    pthread_mutex_unlock(&fileMutex);
+}
+
+// Function: issueTicketId
+// Purpose: Advances the kiosk's shard clock to max(now, last + 1) with a
+// CAS, then adds the id to the index.
+TicketId issueTicketId(int showtimeIndex, const SeatSelection* seat) {
+    ShardClock* shard = &shardClocks[kioskShard];
+    uint64_t now = (uint64_t)(getEpochMicros() / 1000 - TICKET_EPOCH_MS) << TICKET_SEQ_BITS;
+    uint64_t last = __atomic_load_n(&shard->clock, __ATOMIC_RELAXED);
+    uint64_t next;
+    do {
+        next = (now > last) ? now : last + 1;
+    } while (!__atomic_compare_exchange_n(&shard->clock, &last, next, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    TicketId id = ((next & ~SEQ_MASK) << TICKET_SHARD_BITS) |
+                  ((uint64_t)kioskShard << TICKET_SEQ_BITS) | (next & SEQ_MASK);
+
+    TicketRecord record;
+    memset(&record, 0, sizeof(record));
+    record.id = id;
+    record.showtimeIndex = (int16_t)showtimeIndex;
+    record.row = (uint8_t)seat->r;
+    record.col = (uint8_t)seat->c;
+    record.status = TICKET_ISSUED;
+    addRecord(&record); // A full table only costs the ticket its check
+    return id;
+}
+
+// Function: saveTicketId
+int saveTicketId(TicketId id) {
+    TicketRecord* slot = findSlot(id, 0);
+    if (slot == NULL || __atomic_load_n(&slot->status, __ATOMIC_ACQUIRE) == 0) return 0;
+    pthread_mutex_lock(&fileMutex);
+    int ok = appendRecord(slot);
+    pthread_mutex_unlock(&fileMutex);
+    return ok;
+}
+
+// Function: validateTicket
+// Purpose: Reads the other kiosks' new tickets, looks the id up, and with
+// 'admit' turns ISSUED into ADMITTED and records the change in the file.
+// An admit holds the admit lock from the catch-up to the append, so a
+// door in another kiosk sees the ADMITTED record before it looks; inside
+// this kiosk the CAS decides between two threads.
+int validateTicket(TicketId id, int admit, TicketRecord* out) {
+    if (id == 0) return TICKET_UNKNOWN;
+    pthread_mutex_lock(&fileMutex);
+    if (admit) lockAdmits(1);
+    catchUpFile();
+
+    uint8_t status = TICKET_UNKNOWN;
+    TicketRecord* slot = findSlot(id, 0);
+    if (slot != NULL) status = __atomic_load_n(&slot->status, __ATOMIC_ACQUIRE);
+
+    if (status != TICKET_UNKNOWN && out != NULL) {
+        *out = *slot;
+        out->status = status;
+    }
+    if (admit && status == TICKET_ISSUED && raiseStatus(slot, TICKET_ADMITTED)) appendRecord(slot);
+    if (admit) lockAdmits(0);
+    pthread_mutex_unlock(&fileMutex);
+    return status;
+}
+
+// Function: formatTicketId
+// Purpose: 64 bits as 13 base-32 digits, most significant first
+// (the first digit holds only the top 4 bits).
+void formatTicketId(TicketId id, char* out) {
+    int i;
+    for(i = TICKET_ID_TEXT - 2; i >= 0; i--) {
+        out[i] = BASE32[id & 31];
+        id >>= 5;
+    }
+    out[TICKET_ID_TEXT - 1] = '\0';
+}
+
+// Function: parseTicketId
+TicketId parseTicketId(const char* text) {
+    uint64_t id = 0;
+    int digits = 0;
+    const char* p;
+    for(p = text; *p != '\0'; p++) {
+        char ch = *p;
+        if (ch == ' ' || ch == '-' || ch == '#') continue;
+        if (ch >= 'a' && ch <= 'z') ch = (char)(ch - 'a' + 'A');
+        if (ch == 'O') ch = '0';
+        if (ch == 'I' || ch == 'L') ch = '1';
+
+        const char* digit = (ch != '\0') ? strchr(BASE32, ch) : NULL;
+        if (digit == NULL) return 0;
+        if (digits == 0 && digit - BASE32 > 15) return 0; // More than 64 bits
+        if (++digits > TICKET_ID_TEXT - 1) return 0;
+        id = (id << 5) | (uint64_t)(digit - BASE32);
+    }
+    return (digits == TICKET_ID_TEXT - 1) ? id : 0;
+}
+
+// Function: getKioskShard
+int getKioskShard() {
+    return kioskShard;
+}
+
+// Function: getTicketShard
+int getTicketShard(TicketId id) {
+    return (int)((id >> TICKET_SEQ_BITS) & SHARD_MASK);
+}
+
+// Function: getTicketIssuedMs
+long long getTicketIssuedMs(TicketId id) {
+    return (long long)(id >> (TICKET_SHARD_BITS + TICKET_SEQ_BITS)) + TICKET_EPOCH_MS;
+}
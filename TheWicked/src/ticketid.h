@@ -0,0 +1,102 @@
+#ifndef TICKETID_H
+#define TICKETID_H
+
+#include <stdint.h>
+#include "tickets.h"
+
+// ---------------------------------------------------------
+// TICKET IDS & VALIDATION
+// ---------------------------------------------------------
+// Every printed ticket gets a unique, time-ordered 64-bit id:
+//
+//   [ 42 bits: ms since 2024-01-01 UTC ][ 8 bits: kiosk shard ][ 14 bits: sequence ]
+//
+// Each kiosk issues from its own shard, so two kiosks can never hand out
+// the same id and never have to talk to each other. Kiosks sharing a
+// folder (and so TICKET_ID_FILE) each lock their shard in "<file>.lock":
+// "--kiosk <n>" asks for shard n and a kiosk started without it takes the
+// first free one. Thin clients of a booking server run on several
+// machines, so they must be given distinct numbers with "--kiosk". Inside
+// a shard the (ms, sequence) pair is one 64-bit word advanced with a
+// compare-and-swap: no lock, and ids keep increasing even when more than
+// 16384 tickets are issued in one millisecond (the sequence carries into
+// the next millisecond) or the clock steps back.
+// On the ticket the id is printed as 13 Crockford base-32 characters
+// ("TICKET #0DQ4M7K2X0G0A"); the text sorts in issue order too.
+//
+// Every issued id goes into an open-addressing hash table (linear probing,
+// TICKET_INDEX_SLOTS entries) that maps it to the showtime, seat and
+// status, so an usher checks a ticket with one or two probes.
+// The entries are also appended to TICKET_ID_FILE by the ticket spooler
+// (see spool.h), off the sale path. At startup the kiosk loads today's
+// entries from it, and before every check it reads what other kiosks
+// sharing the folder appended since, so any kiosk can check any ticket.
+#define TICKET_ID_FILE "ticket_ids.bin"
+
+#define MAX_TICKET_SHARDS 256
+#define TICKET_INDEX_SLOTS (1 << 17)  // Power of two; a day's tickets stay under 70%
+#define TICKET_ID_TEXT 14             // 13 characters + '\0'
+
+#define TICKET_EPOCH_MS 1704067200000LL // 2024-01-01 00:00 UTC
+#define TICKET_SHARD_BITS 8
+#define TICKET_SEQ_BITS 14
+
+// Status of a ticket
+#define TICKET_UNKNOWN  0            // Never issued (or not today)
+#define TICKET_ISSUED   1
+#define TICKET_ADMITTED 2            // Already scanned at the door
+
+typedef uint64_t TicketId;           // 0 is never issued
+
+// One entry of the index, and one 16-byte record of TICKET_ID_FILE.
+typedef struct {
+    uint64_t id;
+    int16_t showtimeIndex;
+    uint8_t row;
+    uint8_t col;
+    uint8_t status;
+    uint8_t reserved[3];
+} TicketRecord;
+
+// Takes the kiosk's shard ('shard', or -1 = the first one free) and loads
+// today's tickets from the file.
+// Returns: Number of tickets loaded, or -1 if the shard is held by another
+// kiosk (or, with -1, every shard is).
+int openTicketIds(const char* path, int shard);
+
+// Stops recording tickets in the file and gives the shard back (the
+// index stays usable).
+void closeTicketIds();
+
+// Issues a new id for one seat and adds it to the index as TICKET_ISSUED.
+// Safe to call from several threads; takes no lock.
+TicketId issueTicketId(int showtimeIndex, const SeatSelection* seat);
+
+// Appends the ticket's index entry to the file (the spooler thread does
+// this before printing the ticket).
+// Returns: 1 if recorded, 0 if not.
+int saveTicketId(TicketId id);
+
+// Looks a ticket up; with 'admit' an issued ticket becomes TICKET_ADMITTED
+// (under the admit lock, so only one of the kiosks sharing the file does).
+// 'out' (may be NULL) receives the entry as it was before the check.
+// Returns: The status before the check (TICKET_UNKNOWN if not found).
+int validateTicket(TicketId id, int admit, TicketRecord* out);
+
+// Writes the 13-character text of an id into 'out' (TICKET_ID_TEXT bytes).
+void formatTicketId(TicketId id, char* out);
+
+// Reads an id typed by an usher (any case; spaces, '-' and '#' ignored,
+// I/L read as 1 and O as 0). Returns: The id, or 0 if the text is not one.
+TicketId parseTicketId(const char* text);
+
+// Shard this kiosk issues from (after openTicketIds).
+int getKioskShard();
+
+// Kiosk shard that issued an id.
+int getTicketShard(TicketId id);
+
+// When an id was issued (epoch milliseconds).
+long long getTicketIssuedMs(TicketId id);
+
+#endif
@@ -3,36 +3,60 @@
 #include <string.h>
 #include <time.h>
 #include "tickets.h"
+#include "hall.h"
+#include "catalog.h"
+#include "pricing.h"
+#include "groups.h"
+#include "payments.h"
+#include "spool.h"
+#include "inventory.h"
+#include "holds.h"
+#include "wal.h"
+#include "snapshot.h"
+#include "archive.h"
+#include "salesrec.h"
+#include "logindex.h"
+#include "remote.h"
 #include "ui.h"
 #include "utilities.h"
 
 // ---------------------------------------------------------
 // DATA STRUCTURE: The Seating Chart
 // ---------------------------------------------------------
-// This is a 3D Matrix: [TimeSlot][Row][Col]
-// It allows us to track seat availability separately for each showtime.
-// Example: seatMatrix[0][0][0] is Row A, Seat 1 for the 10:30 AM show.
-static int seatMatrix[NUM_SHOWTIMES][ROWS][COLS]; 
+// Seat state lives in the bit-packed inventory (see inventory.c) and the
+// shape of the auditorium comes from the hall layout (see hall.c).
+// Each [TimeSlot][Row] is a single 64-bit word, one bit per seat,
+// so the functions below work on whole rows instead of single cells.
 
 // Function: initSeats
-// Purpose: Resets the entire cinema to empty (0) when the program starts.
+// Purpose: Loads today's films and screenings (or, without a catalog, the
+// single hall layout) and resets the entire cinema to empty (0)
+// when the program starts.
 void initSeats() {
-    int t, i, j;
-    // Loop through all showtimes (t), rows (i), and columns (j)
-    for(t=0; t<NUM_SHOWTIMES; t++) {
-        for(i=0; i<ROWS; i++) {
-            for(j=0; j<COLS; j++) {
-                seatMatrix[t][i][j] = 0; // 0 = Available, 1 = Sold
-            }
+    if (!loadCatalog(CATALOG_FILE, NULL)) {
+        if (!loadHallLayout(HALL_LAYOUT_FILE)) {
+            useDefaultHallLayout();
         }
+        useDefaultCatalog();
     }
+    buildInventory();
+    loadPricing(PRICING_FILE); // Compiled for the showtimes just loaded
 }
 
 // Function: isSeatBooked
 // Purpose: Checks if a specific seat is taken for a specific time.
 // Returns: 1 (True) if booked, 0 (False) if available.
 int isSeatBooked(int r, int c, int showtimeIndex) {
-    return seatMatrix[showtimeIndex][r][c];
+    if (!seatExists(showtimeIndex, r, c)) return 1; // Aisle: never bookable
+    return isInventorySeatTaken(showtimeIndex, r, c); // Sold, or claimed by another kiosk
+}
+
+// Function: getSeatStatus
+// Purpose: Three-way seat state for the seat map (Available / Sold / Held).
+int getSeatStatus(int r, int c, int showtimeIndex) {
+    if (!isSeatBooked(r, c, showtimeIndex)) return SEAT_AVAILABLE;
+    if (!seatExists(showtimeIndex, r, c) || isInventorySeatSold(showtimeIndex, r, c)) return SEAT_SOLD;
+    return SEAT_HELD;
 }
 
 // Function: countSoldSeats
@@ -40,64 +64,83 @@ int isSeatBooked(int r, int c, int showtimeIndex) {
 // Used by the Admin "View Sales" feature to show overall activity.
 int countSoldSeats() {
     int count = 0;
-    int t, i, j;
-    for(t=0; t<NUM_SHOWTIMES; t++) {
-        for(i=0; i<ROWS; i++) {
-            for(j=0; j<COLS; j++) {
-                if(seatMatrix[t][i][j] == 1) {
-                    count++;
-                }
-            }
-        }
+    int t;
+    for(t=0; t<getNumShowtimes(); t++) {
+        if (isRemoteKiosk()) syncRemoteShowtime(t); // Thin client: ask the server
+        count += countSoldInShowtime(t);
     }
     return count;
 }
 
 // Function: checkAvailability
-// Purpose: Verifies if there are enough contiguous empty seats in a specific class.
+// Purpose: Verifies if there are enough empty seats in a specific class.
 // Used before booking to prevent "sold out" errors during seat selection.
+// (Whether the party can sit together is decided later by reserveSeats.)
 int checkAvailability(int qty, int type, int showtimeIndex) {
-    int freeCount = 0;
-    int startRow, endRow;
-
-    // Define row ranges for VIP (Row A) vs Regular (Rows B-D)
-    if (type == TYPE_VIP) { startRow = 0; endRow = 1; } 
-    else { startRow = 1; endRow = ROWS; }
-
-    int i, j;
-    for(i = startRow; i < endRow; i++) {
-        for(j = 0; j < COLS; j++) {
-            // Only count seats for the SELECTED showtime
-            if(seatMatrix[showtimeIndex][i][j] == 0) freeCount++;
-        }
-    }
+    if (isRemoteKiosk()) syncRemoteShowtime(showtimeIndex); // Thin client: fresh copy
+    else advanceHolds(); // Expired holds go back to the pool first
+    // Every row carries its own class tag, so just count the rows of that class.
     // Return True if we have at least 'qty' seats free
-    return (freeCount >= qty);
+    return (countFreeInClass(showtimeIndex, type) >= qty);
+}
+
+// Function: fillSeat
+// Purpose: Writes one chosen seat into a SeatSelection slot.
+static void fillSeat(SeatSelection* seat, int r, int c, int type, Money price) {
+    seat->r = r;
+    seat->c = c;
+    seat->type = type;
+    seat->rowChar = 'A' + r;
+    seat->price = price;
 }
 
 // Function: reserveSeats
-// Purpose: Automatically assigns the first available seats found.
+// Purpose: Automatically assigns the BEST seats, keeping the party together.
+// 1. Asks the best-seat index for the best free seat with 'qty' adjacent
+//    free seats around it (seat quality: see rankSeats() in hall.c).
+// 2. If the party is larger than any free run, takes the 'qty' best free
+//    seats of the class (wheelchair bays only once every other seat is gone).
+// 3. Should the index be a step behind another kiosk, the first available
+//    seats found are used instead.
 // Note: This modifies the 'outputSeats' array with the chosen seat details.
 void reserveSeats(int qty, int type, int showtimeIndex, SeatSelection* outputSeats) {
+    const HallLayout* hall = getHall(showtimeIndex);
     int count = 0;
-    int startRow, endRow;
+    int pass, i;
+
+    if (isRemoteKiosk()) syncRemoteShowtime(showtimeIndex);
+    else advanceHolds();
+
+    // Every seat of the order is the same class: one price lookup (pricing.h)
+    Money price = currentSeatPrice(showtimeIndex, type, CUSTOMER_GUEST);
+
+    int runRow, runCol;
+    if (findBestContiguousSeats(showtimeIndex, type, qty, &runRow, &runCol)) {
+        for(i = 0; i < qty; i++) fillSeat(&outputSeats[i], runRow, runCol + i, type, price);
+        return;
+    }
+
+    unsigned short best[MAX_ROWS * MAX_COLS];
+    if (qty <= MAX_ROWS * MAX_COLS && findBestFreeSeats(showtimeIndex, type, qty, best) == qty) {
+        for(i = 0; i < qty; i++) fillSeat(&outputSeats[i], best[i] / MAX_COLS, best[i] % MAX_COLS, type, price);
+        return;
+    }
+
+    for(pass = 0; pass < 2; pass++) {
+        for(i = 0; i < hall->rows; i++) {
+            if (hall->rowClass[i] != type) continue;
+
+            // Free real seats of the row; pass 0 skips wheelchair bays, pass 1 uses only them.
+            // Then walk the set bits lowest-first (count-trailing-zeros).
+            SeatWord freeBits = getRowFreeMask(showtimeIndex, i);
+            freeBits &= (pass == 0) ? ~hall->wheelMask[i] : hall->wheelMask[i];
+
+            while (freeBits != 0) {
+                int j = lowestBitIndex(freeBits);
+                freeBits &= freeBits - 1; // Clear the bit we just used
 
-    if (type == TYPE_VIP) { startRow = 0; endRow = 1; } 
-    else { startRow = 1; endRow = ROWS; }
-    
-    int i, j;
-    for(i = startRow; i < endRow; i++) {
-        for(j = 0; j < COLS; j++) {
-            // Find an empty seat
-            if (seatMatrix[showtimeIndex][i][j] == 0) {
                 // Save seat coordinates and price
-                outputSeats[count].r = i;
-                outputSeats[count].c = j;
-                outputSeats[count].rowChar = 'A' + i;
-                
-                if (type == TYPE_VIP) outputSeats[count].price = PRICE_VIP;
-                else                  outputSeats[count].price = PRICE_REG;
-                
+                fillSeat(&outputSeats[count], i, j, type, price);
                 count++;
                 if (count >= qty) return; // Stop once we have enough seats
             }
@@ -105,171 +148,337 @@ void reserveSeats(int qty, int type, int showtimeIndex, SeatSelection* outputSea
     }
 }
 
-// Function: markSeatsSold
-// Purpose: The "Commit" function. Permanently changes seat status to 1 (Sold).
-// This happens ONLY after payment is successful.
-void markSeatsSold(int qty, SeatSelection* seats, int showtimeIndex) {
+// Function: buildRowMasks
+// Purpose: Groups a list of seats into one bit mask per row,
+// the format the inventory uses for claims and sales.
+static void buildRowMasks(int qty, const SeatSelection* seats, SeatWord* rowMasks) {
     int i;
+    memset(rowMasks, 0, sizeof(SeatWord) * MAX_ROWS);
     for(i=0; i<qty; i++) {
-        int r = seats[i].r;
-        int c = seats[i].c;
-        // Mark specific showtime matrix
-        seatMatrix[showtimeIndex][r][c] = 1; 
+        rowMasks[seats[i].r] |= (SeatWord)1 << seats[i].c;
     }
 }
 
-// Function: generateTicket
-// Purpose: Prints the ASCII ticket animation.
-// Updated to use the specific 'timeStr' (e.g. "10:30 AM") instead of current clock.
-void generateTicket(SeatSelection seat, int current, int total, char* timeStr) {
-    clearScreen(); 
-    
-    // Choose border colors (Gold for VIP, Magenta for Regular)
-    char* borderColor = (seat.rowChar == 'A') ? COLOR_YELLOW : COLOR_MAGENTA;
-    char* titleColor  = (seat.rowChar == 'A') ? COLOR_RED : COLOR_YELLOW;
+// Function: claimSeats
+// Purpose: Locks in the chosen seats for this kiosk BEFORE payment starts.
+// Uses a compare-and-swap on each row, so two kiosks can never claim the
+// same seat, and no kiosk ever waits on a global lock.
+int claimSeats(int qty, SeatSelection* seats, int showtimeIndex) {
+    SeatWord rowMasks[MAX_ROWS];
+    buildRowMasks(qty, seats, rowMasks);
+    return claimRowMasks(showtimeIndex, rowMasks);
+}
 
-    // Centering Logic: (Screen Width 100 - Ticket Width 46) / 2 = 27
-    int x = 27; 
-    int y = 8; 
+// Function: releaseSeats
+// Purpose: Gives claimed seats back when the payment is cancelled.
+void releaseSeats(int qty, SeatSelection* seats, int showtimeIndex) {
+    SeatWord rowMasks[MAX_ROWS];
+    buildRowMasks(qty, seats, rowMasks);
+    releaseRowMasks(showtimeIndex, rowMasks);
+}
 
-    gotoxy(35, 5);
-    printf("Printing Ticket %d of %d...", current, total);
+// Function: holdSeats
+// Purpose: Claims the seats for this kiosk session with a deadline.
+// The timing wheel in holds.c releases them if payment takes too long.
+int holdSeats(int qty, SeatSelection* seats, int showtimeIndex, int owner) {
+    if (isRemoteKiosk()) return remoteHoldSeats(qty, seats, showtimeIndex); // Server owns the seats
+    SeatWord rowMasks[MAX_ROWS];
+    buildRowMasks(qty, seats, rowMasks);
+    advanceHolds();
+    return createHold(showtimeIndex, rowMasks, owner, HOLD_TTL_MS);
+}
 
-    // DRAWING THE TICKET (Line by Line)
-    gotoxy(x, y);   
-    printf("%s+--------------------------------------------+  " COLOR_RESET, borderColor);
+// Function: commitHeldSeats
+// Purpose: Converts the hold into a sale. A late customer still gets the
+// seats if they were not picked up by another kiosk after the hold expired.
+int commitHeldSeats(int holdId, int owner, int qty, SeatSelection* seats, int showtimeIndex) {
+    if (isRemoteKiosk()) return remoteCommitSeats(holdId, qty, seats, showtimeIndex);
+    if (commitHold(holdId, owner)) return 1;
+
+    // Hold expired: try to claim the same seats again
+    if (!claimSeats(qty, seats, showtimeIndex)) return 0;
+    markSeatsSold(qty, seats, showtimeIndex);
+    return 1;
+}
 
-    gotoxy(x, y+1); 
-    printf("%s|               %sTHE WICKED GOOD             %s |  " COLOR_RESET, borderColor, titleColor, borderColor);
+// Function: releaseHeldSeats
+// Purpose: Customer cancelled, free the seats now instead of at the deadline.
+void releaseHeldSeats(int holdId, int owner) {
+    if (isRemoteKiosk()) remoteReleaseSeats(holdId);
+    else cancelHold(holdId, owner);
+}
 
-    gotoxy(x, y+2); 
-    printf("%s|                TICKET #%04d                |  " COLOR_RESET, borderColor, rand() % 9999);
-    
-    gotoxy(x, y+3); 
-    printf("%s|--------------------------------------------|  " COLOR_RESET, borderColor);
-    
-    // Seat and Price Line (Aligned with padding)
-    gotoxy(x, y+4); 
-    printf("%s|     Seat: " COLOR_CYAN "%c-%02d" COLOR_RESET "           Price: " COLOR_GREEN "PHP%-6.2f" COLOR_RESET "%s  |  " COLOR_RESET, 
-           borderColor, seat.rowChar, seat.c + 1, seat.price, borderColor);
-                           
-    // Date/Time Line (Centered)
-    gotoxy(x, y+5); 
-    printf("%s|          %16s                  |  " COLOR_RESET, borderColor, timeStr);
-    
-    // Tag Line (VIP vs Standard)
-    char* tag = (seat.rowChar == 'A') ? "[ VIP ACCESS ]" : "[ STD ADMIT  ]";
-    gotoxy(x, y+6); 
-    printf("%s|               %s               |  " COLOR_RESET, borderColor, tag);
-    
-    gotoxy(x, y+7); 
-    printf("%s+--------------------------------------------+  " COLOR_RESET, borderColor);
+// Function: markSeatsSold
+// Purpose: The "Commit" function. Permanently changes seat status to 1 (Sold).
+// This happens ONLY after payment is successful.
+void markSeatsSold(int qty, SeatSelection* seats, int showtimeIndex) {
+    SeatWord rowMasks[MAX_ROWS];
+    buildRowMasks(qty, seats, rowMasks);
+    // Mark specific showtime row words (one atomic update per row)
+    sellRowMasks(showtimeIndex, rowMasks);
+}
+
+// Function: unsellSeats
+// Purpose: Gives back the seats of a sale that was cancelled after
+// markSeatsSold() because the sales log could not take it.
+static void unsellSeats(int qty, const SeatSelection* seats, int showtimeIndex) {
+    SeatWord rowMasks[MAX_ROWS];
+    buildRowMasks(qty, seats, rowMasks);
+    unsellRowMasks(showtimeIndex, rowMasks);
 }
 
 // Function: saveTransaction
-// Purpose: Writes the sale to 'sales_log.txt' for the Admin.
-void saveTransaction(int count, float total) {
-    FILE *f = fopen("sales_log.txt", "a");
-    if (f == NULL) return;
-    
-    time_t t = time(NULL);
-    char *timeStr = ctime(&t);
-    timeStr[strlen(timeStr)-1] = '\0'; // Remove newline
-    
-    fprintf(f, "[%s] Sold: %d tickets | Total: PHP %.2f\n", timeStr, count, total);
-    fclose(f);
+// Purpose: Writes the sale to the binary sales log for the Admin.
+// The record lists the showtime, every seat and the amounts (in centavos),
+// so the log alone is enough to know which seats were sold. It goes through
+// the write-ahead log (wal.c): the file stays open and the record is on
+// disk (fdatasync) before this function returns.
+// Format: one 64-byte SALE record (+ SEATS records for parties over 12,
+// + ITEMS records for the concessions), see salesrec.h.
+int saveTransaction(int showtimeIndex, int count, SeatSelection* seats, Money ticketTotal, const ConcessionOrder* extras) {
+    PackedItem items[MAX_SALE_ITEMS];
+    int itemCount = (extras != NULL) ? packOrder(extras, items, MAX_SALE_ITEMS) : 0;
+    Money snacksTotal = (extras != NULL) ? extras->total : 0;
+
+    if (isRemoteKiosk()) {
+        return remoteSaveTransaction(showtimeIndex, count, seats, ticketTotal, snacksTotal, itemCount, items);
+    }
+    if (!isSalesLogOpen()) {
+        if (!prepareSalesFile(SALES_LOG_FILE) || !openSalesLog(SALES_LOG_FILE, GROUP_COMMIT_MS)) return 0;
+    }
+
+    int records = salesRecordsNeeded(count, itemCount);
+    SalesRecord* sale = malloc(sizeof(SalesRecord) * records);
+    PackedSeat* packed = malloc(sizeof(PackedSeat) * (count > 0 ? count : 1));
+    if (sale == NULL || packed == NULL) {
+        free(sale);
+        free(packed);
+        return 0;
+    }
+
+    int i;
+    for(i = 0; i < count; i++) {
+        packed[i].row = (uint8_t)seats[i].r;
+        packed[i].col = (uint8_t)seats[i].c;
+    }
+    encodeSale(sale, showtimeIndex, count, packed, itemCount, items, getEpochMicros(), ticketTotal, snacksTotal);
+
+    int saved = appendSalesRecord(sale, sizeof(SalesRecord) * records);
+    free(sale);
+    free(packed);
+    return saved;
+}
+
+// Function: saveTransactionOrRefund
+// Purpose: saveTransaction() for the kiosk screens. If the log cannot be
+// written the customer gets no tickets: the cashier can try again, or
+// cancel the sale and refund it. A thin client's retry re-sends the same
+// sale key, so a sale the server did log before the reply was lost is not
+// logged twice. A cancelled sale puts its seats back on sale; on a thin
+// client the server already sold them and has no way to take that back.
+// Returns: 1 once the sale is logged, 0 if it was cancelled.
+int saveTransactionOrRefund(int showtimeIndex, int count, SeatSelection* seats, Money ticketTotal, const ConcessionOrder* extras) {
+    while (!saveTransaction(showtimeIndex, count, seats, ticketTotal, extras)) {
+        printHeader("PAYMENT GATEWAY");
+        printCentered(12, "The sale could not be saved to the sales log.", COLOR_RED);
+        printCentered(13, "No tickets were printed.", COLOR_YELLOW);
+        if (getIntInput(30, 15, "Try again? (1 = Yes, 0 = Cancel and refund): ", 0, 1) == 0) {
+            if (isRemoteKiosk()) {
+                remoteAbandonSale(); // The next sale gets a new key
+                printCentered(18, "These seats stay sold on the server for today.", COLOR_YELLOW);
+            } else {
+                unsellSeats(count, seats, showtimeIndex);
+            }
+            printCentered(17, "Sale cancelled. Please see the cashier for a refund.", COLOR_YELLOW);
+            pauseExecution(3000);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// ---------------------------------------------------------
+// SALES LOG VIEWER (Admin)
+// ---------------------------------------------------------
+#define LOG_PAGE_SIZE 12   // Sales per screen (rows 9 to 20)
+
+// Kept between visits: reopening the viewer only indexes the new sales.
+static SalesIndex salesLogIndex;
+
+// Function: parseLogTime
+// Purpose: "HH:MM" (today) or "YYYY-MM-DD HH:MM" -> microseconds (0 if invalid).
+static long long parseLogTime(const char* text) {
+    time_t now = time(NULL);
+    struct tm tm = *localtime(&now);
+    int hour, minute;
+
+    if (sscanf(text, "%d-%d-%d %d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &hour, &minute) == 5) {
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+    } else if (sscanf(text, "%d:%d", &hour, &minute) != 2) {
+        return 0;
+    }
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+    tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    time_t seconds = mktime(&tm);
+    return (seconds == (time_t)-1) ? 0 : (long long)seconds * 1000000;
 }
 
 // Function: viewSalesLog
-// Purpose: Admin feature to read and display the sales log file.
+// Purpose: Admin feature to page through the sales log file.
+// The log is mapped straight into memory and every page is found through
+// the sparse index, so paging costs the same on line 10 or line 100,000.
+// Keys: n = next, p = previous, f = first, t = tail (newest),
+//       j <page> = jump to page, s <time> = first sale at/after a time,
+//       q = back to the menu.
 void viewSalesLog() {
-    printHeader("ADMIN: SALES LOG");
-    FILE *f = fopen("sales_log.txt", "r");
-    if (f == NULL) {
-        gotoxy(35, 10);
-        printf(COLOR_YELLOW "No sales history found.\n" COLOR_RESET);
-        printDivider(12);
-    } else {
-        char line[256];
-        printf(COLOR_CYAN);
-        int y = 9; 
-        
-        while (fgets(line, sizeof(line), f)) {
+    long long page = 0;
+    int atTail = 1; // Start on the newest sales
+    int viewing = 1;
+
+    while (viewing) {
+        printHeader("ADMIN: SALES LOG");
+        SalesView view;
+        if (!mapSalesFile(SALES_LOG_FILE, &view) || !refreshSalesIndex(&salesLogIndex, &view)
+            || salesLogIndex.sales == 0) {
+            gotoxy(35, 10);
+            screenPrintf(COLOR_YELLOW "No sales history found.\n" COLOR_RESET);
+            printDivider(12);
+            unmapSalesFile(&view);
+            gotoxy(38, 24);
+            screenPrintf(COLOR_WHITE "[Press Enter to return]" COLOR_RESET);
+            presentScreenForInput();
+            getchar();
+            return;
+        }
+
+        long long pages = (salesLogIndex.sales + LOG_PAGE_SIZE - 1) / LOG_PAGE_SIZE;
+        if (atTail) page = pages - 1;
+        if (page >= pages) page = pages - 1;
+        if (page < 0) page = 0;
+
+        char line[SALES_TEXT_MAX];
+        long long first = page * LOG_PAGE_SIZE;
+        long long i = findSaleRecord(&salesLogIndex, &view, first);
+        long long sale;
+        int y = 9;
+
+        screenPrintf(COLOR_CYAN);
+        for(sale = first; sale < first + LOG_PAGE_SIZE && sale < salesLogIndex.sales; sale++) {
+            formatRecordText(&view, i, line, sizeof(line));
             // Print log lines slightly indented for readability
-            gotoxy(18, y++);
-            size_t len = strlen(line);
-            if (len > 0 && line[len-1] == '\n') line[len-1] = '\0';
-            printf("%s", line);
-            if(y > 20) break; // Simple pagination (stop after 20 lines)
+            gotoxy(12, y++);
+            screenPrintf("%6lld %.80s", sale + 1, line);
+            i = nextSalesRecord(&view, i);
+        }
+        screenPrintf(COLOR_RESET);
+        unmapSalesFile(&view);
+
+        printDivider(22);
+        gotoxy(18, 23);
+        screenPrintf(COLOR_YELLOW "Page %lld/%lld (%lld sales)" COLOR_RESET "  n/p next/prev  f/t first/tail", page + 1, pages, salesLogIndex.sales);
+        gotoxy(18, 24);
+        screenPrintf("j <page> jump   s <HH:MM | YYYY-MM-DD HH:MM> find time   q back");
+
+        char command[48];
+        gotoxy(18, 26);
+        getStringInput("> ", command, sizeof(command));
+
+        atTail = 0;
+        switch (command[0]) {
+            case 'n': page++; break;
+            case 'p': page--; break;
+            case 'f': page = 0; break;
+            case 't': atTail = 1; break;
+            case 'j': page = atoll(command + 1) - 1; break;
+            case 's': {
+                long long when = parseLogTime(command + 1 + strspn(command + 1, " "));
+                if (when == 0) break;
+                // Map again: the log may have grown while the admin was typing
+                if (mapSalesFile(SALES_LOG_FILE, &view) && refreshSalesIndex(&salesLogIndex, &view)) {
+                    page = findSaleAtTime(&salesLogIndex, &view, when) / LOG_PAGE_SIZE;
+                }
+                unmapSalesFile(&view);
+                break;
+            }
+            case 'q': viewing = 0; break;
+            default: break; // Enter alone just refreshes the page
         }
-        printf(COLOR_RESET);
-        fclose(f);
     }
-    
-    printDivider(22);
-    gotoxy(38, 24);
-    printf(COLOR_WHITE "[Press Enter to return]" COLOR_RESET);
+}
+
+// Function: exportSalesLog
+// Purpose: Admin feature: writes a readable text copy of the current log.
+void exportSalesLog() {
+    printHeader("ADMIN: EXPORT SALES");
+    int exported = exportSalesText(SALES_LOG_FILE, SALES_EXPORT_FILE);
+    gotoxy(33, 12);
+    if (exported < 0) screenPrintf(COLOR_RED "Export failed." COLOR_RESET);
+    else screenPrintf(COLOR_GREEN "%d sales written to " SALES_EXPORT_FILE COLOR_RESET, exported);
+    gotoxy(38, 15);
+    screenPrintf(COLOR_WHITE "[Press Enter to return]" COLOR_RESET);
+    presentScreenForInput();
     getchar();
 }
 
+// Set when a shift is in the archive but still in the log: cashing out
+// again would count its sales twice.
+static int cashoutBlocked = 0;
+
 // Function: performCashout
 // Purpose: Reads all sales, calculates total revenue, archives the data, and resets the log.
+// The log is streamed (see archive.c), so a busy day costs no extra memory.
 void performCashout() {
     printHeader("SHIFT CLOSURE");
 
-    FILE *f = fopen("sales_log.txt", "r");
-    if (f == NULL) {
-        gotoxy(30, 9);
-        printf(COLOR_RED "Error: No active sales to cashout." COLOR_RESET);
+    if (cashoutBlocked) {
+        gotoxy(24, 9);
+        screenPrintf(COLOR_RED "Cashout disabled: the last shift is archived but still in the log." COLOR_RESET);
+        gotoxy(30, 10);
+        screenPrintf("Move " SALES_LOG_FILE " aside by hand before the next cashout.");
+        presentScreenForInput();
         getchar();
         return;
     }
 
-    float totalRevenue = 0.0;
-    char line[256];
-    char fileContent[10000] = ""; 
-
-    // Read file and sum up totals
-    while (fgets(line, sizeof(line), f)) {
-        strcat(fileContent, line); 
-        char *ptr = strrchr(line, '$'); 
-        if(ptr == NULL) ptr = strstr(line, "PHP");
-        
-        if (ptr != NULL) {
-            float lineTotal = 0.0;
-            // Skip currency symbol to get the number
-            if(*ptr == '$') ptr++;
-            else if(strncmp(ptr, "PHP", 3) == 0) ptr+=3;
-            
-            sscanf(ptr, "%f", &lineTotal);
-            totalRevenue += lineTotal;
-        }
+    SalesTotals totals;
+    if (!scanSalesLog(SALES_LOG_FILE, &totals)) {
+        gotoxy(30, 9);
+        screenPrintf(COLOR_RED "Error: No active sales to cashout." COLOR_RESET);
+        presentScreenForInput();
+        getchar();
+        return;
     }
-    fclose(f);
 
-    if (totalRevenue == 0.0) {
+    if (totals.totalCentavos == 0) {
         gotoxy(32, 9);
-        printf(COLOR_YELLOW "   	  Drawer is empty." COLOR_RESET);
+        screenPrintf(COLOR_YELLOW "   	  Drawer is empty." COLOR_RESET);
+        presentScreenForInput();
         getchar();
         return;
     }
 
     // 1. Centered Header
     gotoxy(39, 9);  
-    printf("Total Cash in Drawer:");
+    screenPrintf("Total Cash in Drawer:");
 
     // 2. Centered Amount
     gotoxy(42, 11); 
-    printf(COLOR_GREEN "PHP %.2f" COLOR_RESET, totalRevenue); 
+    char amount[32];
+    formatMoney(totals.totalCentavos, amount, sizeof(amount));
+    screenPrintf(COLOR_GREEN "PHP %s" COLOR_RESET, amount); 
     
     // 3. Divider
     printDivider(13);
     
     // 4. Centered Prompt
     gotoxy(30, 15);
-    printf(COLOR_YELLOW "Confirm Cashout? (1 = Yes, 0 = Cancel): " COLOR_RESET);
+    screenPrintf(COLOR_YELLOW "Confirm Cashout? (1 = Yes, 0 = Cancel): " COLOR_RESET);
     
     int confirm;
+    presentScreenForInput();
     scanf("%d", &confirm);
     clearInputBuffer();
 
@@ -280,43 +489,318 @@ void performCashout() {
         printHeader("PROCESSING TRANSFER");
         showLoadingAnimation("Securing Funds");
 
-        // Move current logs to History Archive
-        FILE *archive = fopen("history_archive.txt", "a");
-        if (archive != NULL) {
-            time_t t = time(NULL);
-            char *timeStr = ctime(&t);
-            timeStr[strlen(timeStr)-1] = '\0';
-
-            fprintf(archive, "\n=== SHIFT CLOSED [%s] | CASHOUT: PHP%.2f ===\n", timeStr, totalRevenue);
-            fprintf(archive, "%s", fileContent); 
-            fprintf(archive, "=======================================================\n");
-            fclose(archive);
-        }
-
-        // Wipe current sales log
-        f = fopen("sales_log.txt", "w");
-        if (f != NULL) fclose(f);
+        // Move exactly the scanned records to the History Archive.
+        // Sales made while the admin was confirming stay in the log for the next shift.
+        long long shiftOffset = archiveSalesLog(SALES_LOG_FILE, ARCHIVE_FILE, ARCHIVE_INDEX_FILE, &totals);
+
+        if (shiftOffset >= 0) {
+            // Remove the archived part of the log (rewritten and swapped in; kiosks keep appending)
+            int trimmed;
+            if (isSalesLogOpen()) trimmed = trimSalesLog(totals.startOffset, totals.endOffset);
+            else {
+                trimmed = (remove(SALES_LOG_FILE) == 0);
+                prepareSalesFile(SALES_LOG_FILE);
+            }
 
-        // Centered Success Message
-        gotoxy(35, 17);
-        printf(COLOR_GREEN "Shift Closed. Funds Secured." COLOR_RESET);
-        gotoxy(32, 18);
-        printf("Log moved to history_archive.txt");
+            if (trimmed) {
+                // The old snapshot points past the end of the trimmed log; replace it
+                writeSnapshot(SNAPSHOT_FILE);
+
+                // Centered Success Message
+                gotoxy(35, 17);
+                screenPrintf(COLOR_GREEN "Shift Closed. Funds Secured." COLOR_RESET);
+                gotoxy(32, 18);
+                screenPrintf("Log moved to " ARCHIVE_FILE);
+            } else if (undoArchiveShift(ARCHIVE_FILE, ARCHIVE_INDEX_FILE, shiftOffset)) {
+                // Back to where we started: the cashout can simply be retried
+                gotoxy(28, 17);
+                screenPrintf(COLOR_RED "Sales log could not be cleared. Shift not closed." COLOR_RESET);
+            } else {
+                cashoutBlocked = 1;
+                gotoxy(22, 17);
+                screenPrintf(COLOR_RED "Shift archived, but its sales could not be removed from the log." COLOR_RESET);
+                gotoxy(28, 18);
+                screenPrintf("Do not cash out again until " SALES_LOG_FILE " is moved aside.");
+            }
+        } else {
+            // Keep the log: nothing is lost, the cashout can simply be retried
+            gotoxy(30, 17);
+            screenPrintf(COLOR_RED "Archive write failed. Sales log kept." COLOR_RESET);
+        }
     } else {
         printHeader("SHIFT CLOSURE");
         gotoxy(40, 15);
-        printf(COLOR_RED "Cashout Cancelled." COLOR_RESET);
+        screenPrintf(COLOR_RED "Cashout Cancelled." COLOR_RESET);
     }
 
     gotoxy(38, 22);
-    printf("[Press Enter to return]");
+    screenPrintf("[Press Enter to return]");
+    presentScreenForInput();
+    getchar();
+}
+
+// ---------------------------------------------------------
+// SHIFT ARCHIVES (Admin)
+// ---------------------------------------------------------
+#define ARCHIVE_PAGE 10   // Shifts / sales listed per screen
+
+// Function: formatShiftDate
+// Purpose: Short local date + time for the archive tables.
+static void formatShiftDate(long long timeUs, char* buffer, size_t size) {
+    time_t seconds = (time_t)(timeUs / 1000000);
+    struct tm* local = localtime(&seconds);
+    if (timeUs == 0 || local == NULL) snprintf(buffer, size, "(unknown)");
+    else strftime(buffer, size, "%Y-%m-%d %H:%M", local);
+}
+
+// Function: parseDate
+// Purpose: "2025-12-06" -> local midnight in microseconds (0 if invalid).
+static long long parseDate(const char* text) {
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    if (sscanf(text, "%d-%d-%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday) != 3) return 0;
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    time_t seconds = mktime(&tm);
+    return (seconds == (time_t)-1) ? 0 : (long long)seconds * 1000000;
+}
+
+// Function: showShiftSales
+// Purpose: Opens one shift: jumps straight to its SHIFT record in the
+// mapped archive (offset from the index) and lists its first sales.
+static void showShiftSales(const ArchiveIndexEntry* entry) {
+    printHeader("ARCHIVED SHIFT");
+    SalesView view;
+    char line[SALES_TEXT_MAX];
+    char closed[32], total[32];
+
+    formatShiftDate(entry->closedUs, closed, sizeof(closed));
+    formatMoney(entry->totalCentavos, total, sizeof(total));
+    gotoxy(18, 8);
+    screenPrintf(COLOR_YELLOW "Closed %s | %lld sales | PHP %s" COLOR_RESET, closed, (long long)entry->sales, total);
+
+    if (mapSalesFile(ARCHIVE_FILE, &view)) {
+        long long first = (entry->offset - salesRecordOffset(0)) / SALES_RECORD_SIZE + 1;
+        long long end = first + entry->records, i;
+        int y = 10;
+        if (end > view.count) end = view.count;
+
+        screenPrintf(COLOR_CYAN);
+        for(i = first; i < end && isSalesRecordComplete(&view, i) && y < 10 + ARCHIVE_PAGE; i = nextSalesRecord(&view, i)) {
+            if (!formatRecordText(&view, i, line, sizeof(line))) continue;
+            gotoxy(18, y++);
+            screenPrintf("%.80s", line);
+        }
+        screenPrintf(COLOR_RESET);
+        if (entry->sales > ARCHIVE_PAGE) {
+            gotoxy(18, y);
+            screenPrintf("... %lld more (use Export for the full list)", (long long)entry->sales - ARCHIVE_PAGE);
+        }
+        unmapSalesFile(&view);
+    }
+
+    printDivider(22);
+    gotoxy(38, 24);
+    screenPrintf(COLOR_WHITE "[Press Enter to return]" COLOR_RESET);
+    presentScreenForInput();
     getchar();
 }
 
-// Placeholder for future feature
+// Function: showShiftList
+// Purpose: Table of shifts [from, to) (at most one page), then lets the
+// admin open one of them.
+static void showShiftList(const ArchiveIndex* index, long long from, long long to, const char* title) {
+    printHeader(title);
+    if (from >= to) {
+        gotoxy(35, 10);
+        screenPrintf(COLOR_YELLOW "No shifts found." COLOR_RESET);
+        gotoxy(38, 13);
+        screenPrintf(COLOR_WHITE "[Press Enter to return]" COLOR_RESET);
+        presentScreenForInput();
+        getchar();
+        return;
+    }
+    if (to - from > ARCHIVE_PAGE) to = from + ARCHIVE_PAGE;
+
+    gotoxy(18, 8);
+    screenPrintf(COLOR_YELLOW "%-5s %-17s %-17s %6s %13s" COLOR_RESET, "No.", "First Sale", "Closed", "Sales", "Cashout (PHP)");
+    long long i;
+    int y = 10;
+    for(i = from; i < to; i++) {
+        const ArchiveIndexEntry* e = &index->entries[i];
+        char opened[32], closed[32], total[32];
+        formatShiftDate(e->firstSaleUs, opened, sizeof(opened));
+        formatShiftDate(e->closedUs, closed, sizeof(closed));
+        formatMoney(e->totalCentavos, total, sizeof(total));
+        gotoxy(18, y++);
+        screenPrintf("%-5lld %-17s %-17s %6lld %13s", i + 1, opened, closed, (long long)e->sales, total);
+    }
+
+    printDivider(21);
+    int pick = getIntInput(28, 23, "Open shift No. (0 = Back) > ", 0, (int)to);
+    if (pick >= from + 1 && pick <= to) showShiftSales(&index->entries[pick - 1]);
+}
+
+// Function: viewArchives
+// Purpose: Admin browser for closed shifts. Everything goes through the
+// archive index, so finding a night is a binary search, not a full read.
 void viewArchives() {
-    printHeader("ARCHIVES");
-    gotoxy(30, 10); 
-    printf("Feature not yet implemented."); 
+    ArchiveIndex index;
+    if (!openArchiveIndex(ARCHIVE_FILE, ARCHIVE_INDEX_FILE, &index) || index.count == 0) {
+        printHeader("ARCHIVES");
+        gotoxy(35, 10);
+        screenPrintf(COLOR_YELLOW "No closed shifts archived yet." COLOR_RESET);
+        gotoxy(38, 13);
+        screenPrintf(COLOR_WHITE "[Press Enter to return]" COLOR_RESET);
+        presentScreenForInput();
+        getchar();
+        closeArchiveIndex(&index);
+        return;
+    }
+
+    int browsing = 1;
+    while (browsing) {
+        char first[32], last[32];
+        formatShiftDate(index.entries[0].closedUs, first, sizeof(first));
+        formatShiftDate(index.entries[index.count - 1].closedUs, last, sizeof(last));
+
+        printHeader("ARCHIVES");
+        gotoxy(28, 8);
+        screenPrintf(COLOR_CYAN "%lld shifts on file (%s to %s)" COLOR_RESET, index.count, first, last);
+        gotoxy(38, 10); screenPrintf(COLOR_WHITE "1. Latest Shifts");
+        gotoxy(38, 11); screenPrintf(COLOR_WHITE "2. Find a Date");
+        gotoxy(38, 12); screenPrintf(COLOR_WHITE "3. Back" COLOR_RESET);
+        printDivider(14);
+        int choice = getIntInput(41, 16, COLOR_YELLOW "Command > " COLOR_RESET, 1, 3);
+
+        if (choice == 1) {
+            long long from = (index.count > ARCHIVE_PAGE) ? index.count - ARCHIVE_PAGE : 0;
+            showShiftList(&index, from, index.count, "LATEST SHIFTS");
+        } else if (choice == 2) {
+            char text[32];
+            gotoxy(30, 18);
+            getStringInput("Date (YYYY-MM-DD): ", text, sizeof(text));
+            long long dayStart = parseDate(text);
+            if (dayStart == 0) continue;
+            long long dayEnd = dayStart + 24LL * 3600 * 1000000;
+
+            // Shifts still open at midnight belong to that night too: start at the
+            // first shift closed after midnight, stop at the first one that began
+            // after the day was over.
+            long long from = findShiftClosedAfter(&index, dayStart), to = from;
+            while (to < index.count) {
+                const ArchiveIndexEntry* e = &index.entries[to];
+                long long began = (e->firstSaleUs != 0) ? e->firstSaleUs : e->closedUs;
+                if (began >= dayEnd) break;
+                to++;
+            }
+            showShiftList(&index, from, to, "SHIFTS ON DATE");
+        } else {
+            browsing = 0;
+        }
+    }
+    closeArchiveIndex(&index);
+}
+
+// ---------------------------------------------------------
+// GROUP BOOKINGS (Admin)
+// ---------------------------------------------------------
+
+// Function: sellGroupBooking
+// Purpose: One block booking from start to finish. The whole block is one
+// order: one hold, one payment and one sale in the log. Every ticket of the
+// block goes to the ticket spooler, and the confirmed plan is shown as the
+// block voucher.
+void sellGroupBooking(int session) {
+    char selectedTime[20];
+    reloadPricingIfChanged();
+    int showtimeIdx = selectShowtime(selectedTime);
+    showSeatMap(showtimeIdx);
+    int ticketType = getTicketTypeInput(showtimeIdx);
+
+    printHeader("GROUP BOOKING");
+    printCentered(9, "Enter the size of every party in the block.", COLOR_CYAN);
+    printCentered(10, "Example: 12,8,8,5 (four parties, 33 seats)", COLOR_WHITE);
+    printDivider(12);
+
+    char list[256];
+    int sizes[MAX_GROUP_PARTIES];
+    gotoxy(30, 14);
+    getStringInput(COLOR_YELLOW "Party sizes > " COLOR_RESET, list, sizeof(list));
+    int parties = parsePartySizes(list, sizes);
+    if (parties < 0) {
+        printCentered(16, "Invalid list (1 to 64 parties, e.g. 12,8,8,5).", COLOR_RED);
+        pauseExecution(2000);
+        return;
+    }
+
+    int qty = 0, i;
+    for(i = 0; i < parties; i++) qty += sizes[i];
+    SeatSelection* seats = malloc(sizeof(SeatSelection) * qty);
+    if (seats == NULL) return;
+
+    // STEP 1: PLAN (one search for the whole block)
+    GroupPlan plan;
+    if (!planGroupSeating(showtimeIdx, ticketType, sizes, parties, GROUP_SEARCH_BUDGET_US, seats, &plan)) {
+        printCentered(16, "Not enough seats in this class for the whole block.", COLOR_RED);
+        pauseExecution(2000);
+        free(seats);
+        return;
+    }
+    showGroupPlan(&plan, seats, "GROUP BOOKING - SEATING PLAN");
+    if (getIntInput(30, 22, "Book this plan? (1 = Yes, 0 = Cancel): ", 0, 1) != 1) {
+        free(seats);
+        return;
+    }
+
+    // STEP 2: HOLD every seat of the block (all or nothing)
+    int holdId = holdSeats(qty, seats, showtimeIdx, session);
+    if (holdId < 0) {
+        printHeader("GROUP BOOKING");
+        printCentered(12, "Another kiosk just took some of those seats. Please plan again.", COLOR_RED);
+        pauseExecution(2000);
+        free(seats);
+        return;
+    }
+
+    // STEP 3: PRICE AND PAY
+    priceSeats(qty, seats, showtimeIdx, askPromoCode());
+    Money ticketTotal = 0;
+    for(i = 0; i < qty; i++) ticketTotal += seats[i].price;
+    if (!processPayment(ticketTotal)) {
+        releaseHeldSeats(holdId, session);
+        screenPrintf(COLOR_RED "\n  [Transaction Cancelled]\n" COLOR_RESET);
+        pauseExecution(1500);
+        free(seats);
+        return;
+    }
+
+    // STEP 4: COMMIT AND LOG
+    if (!commitHeldSeats(holdId, session, qty, seats, showtimeIdx)) {
+        printHeader("PAYMENT GATEWAY");
+        printCentered(12, "The seat hold expired and the seats were sold.", COLOR_RED);
+        printCentered(13, "Please see the cashier for a refund.", COLOR_YELLOW);
+        pauseExecution(3000);
+        free(seats);
+        return;
+    }
+    if (!saveTransactionOrRefund(showtimeIdx, qty, seats, ticketTotal, NULL)) {
+        free(seats);
+        return;
+    }
+    int printing = spoolTickets(showtimeIdx, qty, seats, selectedTime);
+
+    // STEP 5: BLOCK VOUCHER
+    showGroupPlan(&plan, seats, "BLOCK VOUCHER");
+    char totalStr[80];
+    snprintf(totalStr, sizeof(totalStr), "%s  |  TOTAL: PHP " PESO_FORMAT, selectedTime, PESO_ARGS(ticketTotal));
+    printCentered(21, totalStr, COLOR_YELLOW);
+    char printLine[80];
+    snprintf(printLine, sizeof(printLine), "%d tickets are printing at the counter.", printing);
+    printCentered(22, printLine, COLOR_WHITE);
+    gotoxy(38, 23); screenPrintf("[Press Enter to Finish]");
+    presentScreenForInput();
     getchar();
+    free(seats);
 }
@@ -1,24 +1,40 @@
 #ifndef TICKETS_H
 #define TICKETS_H
 
+#include "money.h"
+#include "concessions.h"
+
 // ---------------------------------------------------------
 // PRICING & CONFIGURATION
 // ---------------------------------------------------------
-// Constants for ticket prices (PHP)
-#define PRICE_VIP 700.00
-#define PRICE_REG 450.00
+// Default ticket prices (centavos, see money.h). The prices actually
+// charged come from the pricing rules (see pricing.h / pricing.txt);
+// these are the base prices when the rules file is missing.
+#define PRICE_VIP PESOS(700)
+#define PRICE_REG PESOS(450)
+
+// Active (current shift) sales log, kept open by the write-ahead log (wal.c).
+// Binary fixed-width records (see salesrec.h); the text files are only
+// the pre-binary log (imported once at startup) and the on-demand export.
+#define SALES_LOG_FILE "sales_log.bin"
+#define LEGACY_SALES_LOG_FILE "sales_log.txt"
+#define SALES_EXPORT_FILE "sales_export.txt"
 
 // Identifiers for ticket types (Used in logic flow)
 #define TYPE_VIP 1
 #define TYPE_REG 2
 
-// Cinema Dimensions (4 Rows x 6 Columns = 24 Seats per show)
-#define ROWS 4
-#define COLS 6
+// Seat states (returned by getSeatStatus)
+#define SEAT_AVAILABLE 0
+#define SEAT_SOLD      1
+#define SEAT_HELD      2   // Claimed by a kiosk that is waiting for payment
+
+// How long a customer may take to pay before their seats are released.
+#define HOLD_TTL_MS (5 * 60 * 1000)
 
-// NEW: We have 4 distinct showtimes (10:30am, 1:15pm, 4:45pm, 8:00pm)
-// This creates the 3rd dimension for our seat matrix.
-#define NUM_SHOWTIMES 4
+// Cinema Dimensions and Showtimes are loaded at startup from the
+// hall layout file (see hall.h / hall_layout.txt). Rows are tagged
+// VIP or Regular individually, so several VIP rows are possible.
 
 // ---------------------------------------------------------
 // DATA STRUCTURES
@@ -26,51 +42,97 @@
 // Structure to hold data for a single selected seat.
 // Used to pass seat details between calculation and printing functions.
 typedef struct {
-    int r;       // Matrix Row Index (0-3)
-    int c;       // Matrix Column Index (0-5)
-    float price; // Price of this specific seat
-    char rowChar;// Display Character ('A', 'B', 'C', 'D')
+    int r;       // Hall Row Index (0 = front row)
+    int c;       // Hall Column Index (0 = leftmost position)
+    int type;    // Class of the row (TYPE_VIP / TYPE_REG)
+    Money price; // Price of this specific seat (centavos)
+    char rowChar;// Display Character ('A', 'B', 'C', ...)
 } SeatSelection;
 
 // ---------------------------------------------------------
 // FUNCTION PROTOTYPES
 // ---------------------------------------------------------
 
-// Initializes the 3D Seat Matrix (Sets all seats, for all times, to Empty/0)
+// Loads the catalog (catalog.h) and builds the seat inventory (all seats Empty/0).
+// Without a usable catalog: the hall layout file, then the classic 4 x 6 hall.
+// The price table (pricing.h) is compiled for the showtimes loaded.
 void initSeats(); 
 
-// Checks if there are enough contiguous seats available for a specific Type and Time.
+// Checks if there are enough seats available for a specific Type and Time.
 // Returns: 1 (True) if available, 0 (False) if full.
 int checkAvailability(int qty, int type, int showtimeIndex); 
 
-// Finds the best available seats and stores them in the 'outputSeats' array.
+// Finds the best available seats and stores them in the 'outputSeats' array
+// (priced for a guest; see priceSeats() for promo codes).
+// Parties are seated side by side whenever one row has room for all of them.
 // Does NOT mark them as sold yet (that happens after payment).
 void reserveSeats(int qty, int type, int showtimeIndex, SeatSelection* outputSeats); 
 
+// Atomically claims every selected seat for this kiosk (or none of them).
+// Called right after seat selection so nobody else can take them during payment.
+// Returns: 1 if all seats are ours, 0 if another kiosk got one of them first.
+int claimSeats(int qty, SeatSelection* seats, int showtimeIndex);
+
+// Returns claimed seats to the free pool (payment cancelled).
+void releaseSeats(int qty, SeatSelection* seats, int showtimeIndex);
+
+// Puts the selected seats on a timed hold for one kiosk session ('owner').
+// Held seats cannot be taken by anyone else; if the hold is not committed
+// within HOLD_TTL_MS the seats return to the free pool automatically.
+// Returns: The hold ID, or -1 if another kiosk already took one of the seats.
+int holdSeats(int qty, SeatSelection* seats, int showtimeIndex, int owner);
+
+// Payment done: turns the hold into Sold seats.
+// If the hold already expired, the seats are sold anyway as long as nobody
+// else has taken them in the meantime.
+// Returns: 1 if the seats are now sold to this customer, 0 if they were lost.
+int commitHeldSeats(int holdId, int owner, int qty, SeatSelection* seats, int showtimeIndex);
+
+// Payment cancelled: releases the hold immediately.
+void releaseHeldSeats(int holdId, int owner);
+
 // The "Commit" function. Updates the global 3D Matrix to mark seats as Sold (1).
 // Called only after payment is verified.
 void markSeatsSold(int qty, SeatSelection* seats, int showtimeIndex); 
 
-// Draws the ASCII art ticket on the screen.
-// 'timeStr' is passed here to print the specific showtime on the ticket.
-void generateTicket(SeatSelection seat, int current, int total, char* timeStr); 
+// Appends the transaction details (Date, Showtime, Seats, Amounts and the
+// concession line items of 'extras', NULL = none) to 'sales_log.bin'.
+// Returns only after the record is safely on disk.
+// Returns: 1 if saved, 0 if the log could not be written.
+int saveTransaction(int showtimeIndex, int count, SeatSelection* seats, Money ticketTotal, const ConcessionOrder* extras);
 
-// Appends the transaction details (Date, Count, Total) to 'sales_log.txt'.
-void saveTransaction(int count, float total);
+// saveTransaction() with the kiosk's error screen: on failure asks to try
+// again or to cancel the sale (refund, no tickets).
+// Returns: 1 if the sale is logged, 0 if it was cancelled.
+int saveTransactionOrRefund(int showtimeIndex, int count, SeatSelection* seats, Money ticketTotal, const ConcessionOrder* extras);
 
-// Reads 'sales_log.txt' and displays history to the Admin.
+// Maps the binary sales log and lets the Admin page through it
+// (next/previous, first/tail, jump to page, find a time).
 void viewSalesLog();
 
+// Writes a readable copy of the sales log to 'sales_export.txt'.
+void exportSalesLog();
+
 // Calculates total revenue, archives current logs, and clears the active log file.
 void performCashout(); 
 
-// Placeholder for viewing old history files (Future feature).
+// Browses closed shifts through the archive index (latest shifts / find a date).
 void viewArchives(); 
 
-// Helper: Returns 1 if a specific seat at a specific time is taken.
+// Sells a block of seats to many parties at once (schools, companies):
+// the parties are seated by planGroupSeating() (groups.h), shown for
+// confirmation, held as one order for 'session' and paid in one payment.
+void sellGroupBooking(int session);
+
+// Helper: Returns 1 if a specific seat at a specific time is taken (sold or claimed).
+// Aisle positions (no seat) also report as taken so they can never be picked.
 // Used by the UI to draw Red (Sold) or Green (Available) seats.
 int isSeatBooked(int r, int c, int showtimeIndex);
 
+// Helper: Returns SEAT_AVAILABLE, SEAT_SOLD or SEAT_HELD for one seat.
+// Used by the seat map to draw held seats in their own color.
+int getSeatStatus(int r, int c, int showtimeIndex);
+
 // Helper: Counts total number of sold seats across all showtimes.
 // Used for the "Audience Count" in the movie animation.
 int countSoldSeats(); 
@@ -1,9 +1,18 @@
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
 #include "ui.h"
 #include "tickets.h" 
+#include "hall.h"
+#include "catalog.h"
+#include "pricing.h"
+#include "holds.h"
 #include "utilities.h"
+#include "metrics.h"
+#include "remote.h"
+#include "ticketid.h"
+#include "spool.h"
 
 // Function: printCentered
 // Purpose: A helper to print text perfectly in the middle of a 100-character wide screen.
@@ -14,7 +23,7 @@ void printCentered(int y, const char* text, const char* color) {
     if (x < 0) x = 0;
 
     gotoxy(x, y);
-    printf("%s%s%s", color, text, COLOR_RESET);
+    screenPrintf("%s%s%s", color, text, COLOR_RESET);
 }
 
 // Function: printHeader
@@ -53,6 +62,7 @@ void showSplashScreen() {
     printCentered(4, "WELCOME TO THE CINEMA OF CIT-U", COLOR_WHITE);
     printCentered(15, "[ PRESS ENTER TO ENTER THE VOID ]", COLOR_YELLOW);
     gotoxy(0, 18);
+    presentScreenForInput();
     getchar(); 
 }
 
@@ -62,40 +72,91 @@ void showLoadingAnimation(const char* message) {
     int len = strlen(message) + 4; 
     int x = (SCREEN_WIDTH - len) / 2;
     gotoxy(x, 15); 
-    printf(COLOR_CYAN "%s", message);
-    fflush(stdout);
+    screenPrintf(COLOR_CYAN "%s", message);
+    presentScreen();
     int i;
     for(i = 0; i < 3; i++) {
         pauseExecution(400); // Wait 0.4 seconds per dot
-        printf(".");
-        fflush(stdout);
+        screenPrintf(".");
+        presentScreen();
     }
-    printf(COLOR_RESET "\n");
+    screenPrintf(COLOR_RESET "\n");
     pauseExecution(300);
 }
 
+// Lines a pick-list (films, showtimes) may use between the header and the prompt
+#define MENU_MAX_ITEMS 12
+
+// Function: countShowingFilms
+// Purpose: Collects the films that have a screening today (catalog order).
+static int countShowingFilms(int* list, int max) {
+    int count = 0, f;
+    for(f = 0; f < getNumFilms() && count < max; f++) {
+        if (getFilmInfo(f)->showingCount > 0) list[count++] = f;
+    }
+    return count;
+}
+
+// Function: selectFilm
+// Purpose: Lets the guest pick a film. With a single film (the classic
+// cinema) there is nothing to ask and no screen is drawn.
+static int selectFilm(const char* title) {
+    int list[MENU_MAX_ITEMS];
+    int count = countShowingFilms(list, MENU_MAX_ITEMS);
+    if (count <= 1) return (count == 1) ? list[0] : 0;
+
+    printHeader(title);
+    int i;
+    for(i = 0; i < count; i++) {
+        const FilmInfo* film = getFilmInfo(list[i]);
+        gotoxy(34, 9 + i);
+        screenPrintf(COLOR_WHITE "%d. %s (%s)" COLOR_RESET, i + 1, film->title, film->rating);
+    }
+    printDivider(10 + count);
+    int choice = getIntInput(43, 12 + count, COLOR_YELLOW "Select Film > " COLOR_RESET, 1, count);
+    return list[choice - 1];
+}
+
 // Function: printMovieInfo
-// Purpose: Displays static text about the movie (Plot, Price, etc).
+// Purpose: Displays the catalog entry of a film (Plot, Price, etc).
 void printMovieInfo() {
+    const FilmInfo* film = getFilmInfo(selectFilm("MOVIE INFORMATION"));
+    char text[128];
+
     printHeader("MOVIE INFORMATION");
-    printCentered(9,  "Title: THE WICKED GOOD", COLOR_YELLOW);
-    printCentered(10, "Genre: Fantasy / Musical", COLOR_YELLOW);
-    printCentered(11, "Runtime: 2h 15m", COLOR_YELLOW);
-    printCentered(12, "Rating: R-16", COLOR_YELLOW);
+    snprintf(text, sizeof(text), "Title: %s", film->title);
+    printCentered(9, text, COLOR_YELLOW);
+    snprintf(text, sizeof(text), "Genre: %s", film->genre);
+    printCentered(10, text, COLOR_YELLOW);
+    snprintf(text, sizeof(text), "Runtime: %dh %dm", film->minutes / 60, film->minutes % 60);
+    printCentered(11, text, COLOR_YELLOW);
+    snprintf(text, sizeof(text), "Rating: %s", film->rating);
+    printCentered(12, text, COLOR_YELLOW);
     
-    char priceStr[50];
-    sprintf(priceStr, "VIP: PHP %.2f | REG: PHP %.2f", PRICE_VIP, PRICE_REG);
+    char priceStr[80];
+    sprintf(priceStr, "VIP: PHP " PESO_FORMAT " | REG: PHP " PESO_FORMAT, PESO_ARGS(getBasePrice(TYPE_VIP)), PESO_ARGS(getBasePrice(TYPE_REG)));
     printCentered(13, priceStr, COLOR_YELLOW);
     
+    // Word-wrap the synopsis into at most 5 centered lines of 66 characters
     printCentered(15, "Synopsis:", COLOR_MAGENTA);
-    printCentered(16, "Wicked tells the untold story of Elphaba, a misunderstood", COLOR_WHITE);
-    printCentered(17, "green-skinned girl who forms an unlikely friendship with", COLOR_WHITE);
-    printCentered(18, "the popular Glinda. As Elphaba uncovers corruption in Oz", COLOR_WHITE);
-    printCentered(19, "and stands up for justice, she becomes labeled the Wicked Witch,", COLOR_WHITE);
-    printCentered(20, "revealing that heroes and villains aren't always what they seem.", COLOR_WHITE);
+    const char* rest = film->synopsis;
+    int y;
+    for(y = 16; y <= 20 && *rest != '\0'; y++) {
+        int length = (int)strlen(rest);
+        if (length > 66) {
+            length = 66;
+            while (length > 0 && rest[length] != ' ') length--;
+            if (length == 0) length = 66; // One very long word
+        }
+        snprintf(text, sizeof(text), "%.*s", length, rest);
+        printCentered(y, text, COLOR_WHITE);
+        rest += length;
+        while (*rest == ' ') rest++;
+    }
     
     printDivider(22);
     printCentered(24, "[Press Enter to return]", COLOR_GREEN);
+    presentScreenForInput();
     getchar(); 
 }
 
@@ -107,9 +168,9 @@ int showRoleSelection() {
     
     printCentered(9, "Who approaches the gate?", COLOR_CYAN);
     
-    gotoxy(37, 11); printf(COLOR_WHITE "1. Guest (Buy Tickets)" COLOR_RESET);
-    gotoxy(37, 12); printf(COLOR_WHITE "2. Cinema Manager (Admin)" COLOR_RESET);
-    gotoxy(37, 13); printf(COLOR_WHITE "3. Exit System" COLOR_RESET);
+    gotoxy(37, 11); screenPrintf(COLOR_WHITE "1. Guest (Buy Tickets)" COLOR_RESET);
+    gotoxy(37, 12); screenPrintf(COLOR_WHITE "2. Cinema Manager (Admin)" COLOR_RESET);
+    gotoxy(37, 13); screenPrintf(COLOR_WHITE "3. Exit System" COLOR_RESET);
     
     printDivider(15);
     
@@ -118,71 +179,168 @@ int showRoleSelection() {
 }
 
 // Function: selectShowtime
-// Purpose: Displays the 4 movie times and returns the index (0-3).
+// Purpose: Picks a film (when several are playing), then one of its
+// screenings of the day, and returns the showtime index.
 int selectShowtime(char* buffer) {
+    int film = selectFilm("SELECT MOVIE");
+    int list[MENU_MAX_ITEMS];
+
+    // A short schedule lists the whole day, as the kiosk always has.
+    // A busy film starts at the current time so the menu fits the screen.
+    int from = 0;
+    if (getFilmInfo(film)->showingCount > MENU_MAX_ITEMS) {
+        time_t now = time(NULL);
+        struct tm* local = localtime(&now);
+        from = local->tm_hour * 60 + local->tm_min;
+    }
+    int count = findNextShowings(film, from, list, MENU_MAX_ITEMS);
+    if (count == 0) count = findNextShowings(film, 0, list, MENU_MAX_ITEMS); // After the last show
+
     clearScreen();
     printHeader("SELECT SHOWTIME");
+    if (getNumFilms() > 1) printCentered(8, getFilmInfo(film)->title, COLOR_CYAN);
     
+    int i;
     // Fixed X coordinate to align the options nicely
-    gotoxy(39, 9);  printf(COLOR_WHITE "1. 10:30 AM (Matinee)" COLOR_RESET);
-    gotoxy(39, 10); printf(COLOR_WHITE "2. 01:15 PM (Afternoon)" COLOR_RESET);
-    gotoxy(39, 11); printf(COLOR_WHITE "3. 04:45 PM (Prime)" COLOR_RESET);
-    gotoxy(39, 12); printf(COLOR_WHITE "4. 08:00 PM (Evening)" COLOR_RESET);
+    for(i = 0; i < count; i++) {
+        const ShowtimeInfo* show = getShowtimeInfo(list[i]);
+        if (getNumScreens() > 1) {
+            gotoxy(32, 9 + i);
+            screenPrintf(COLOR_WHITE "%2d. %s  %-10s %s" COLOR_RESET, i + 1, show->time,
+                         getScreenName(show->screen), show->label);
+        } else {
+            gotoxy(39, 9 + i);
+            screenPrintf(COLOR_WHITE "%d. %s (%s)" COLOR_RESET, i + 1, show->time, show->label);
+        }
+    }
     
-    printDivider(14);
+    printDivider(10 + count);
     
-    int choice = getIntInput(43, 16, COLOR_YELLOW "Select Time > " COLOR_RESET, 1, 4);
+    int choice = getIntInput(43, 12 + count, COLOR_YELLOW "Select Time > " COLOR_RESET, 1, count);
+    int showtimeIndex = list[choice - 1];
     
     // Copy the string to display on the ticket later
-    if (choice == 1) strcpy(buffer, "10:30 AM");
-    else if (choice == 2) strcpy(buffer, "01:15 PM");
-    else if (choice == 3) strcpy(buffer, "04:45 PM");
-    else strcpy(buffer, "08:00 PM");
+    strcpy(buffer, getShowtimeInfo(showtimeIndex)->time);
     
     clearScreen();
     showLoadingAnimation("Setting Projector");
-    return choice - 1; // Convert 1-4 to 0-3 index
+    return showtimeIndex;
+}
+
+// Items per page of the concession menu (rows 8 to 15)
+#define STAND_PAGE_SIZE 8
+
+// Function: describeOrder
+// Purpose: "2 x Salted Popcorn, 1 x Large Soda" (cut to fit one screen line).
+static void describeOrder(const ConcessionOrder* order, char* buffer, int size) {
+    int used = snprintf(buffer, size, "Order: %s", (order->lineCount == 0) ? "(empty)" : "");
+    int line;
+    for(line = 0; line < order->lineCount && used < size; line++) {
+        used += snprintf(buffer + used, size - used, "%s%d x %s", (line == 0) ? "" : ", ",
+                         order->lines[line].qty, getConcessionItem(order->lines[line].item)->name);
+    }
+    if (used >= size && size > 4) strcpy(buffer + size - 4, "...");
 }
 
 // Function: buyConcessions
-// Purpose: A sub-menu for buying snacks. It loops until the user finishes ordering.
-// Returns the total cost of all snacks bought.
-float buyConcessions() {
-    float totalSnacks = 0.0;
-    int buying = 1;
-    while (buying) {
+// Purpose: A sub-menu for buying snacks, built from the SKUs of the stand.
+// Every pick takes one unit off the shelf at once (concessions.h), so two
+// kiosks can never sell the last popcorn twice. It loops until the user
+// finishes ordering. Returns the total cost of all snacks bought.
+Money buyConcessions(ConcessionOrder* order) {
+    int count = getNumConcessions();
+    int pages = (count + STAND_PAGE_SIZE - 1) / STAND_PAGE_SIZE;
+    int page = 0;
+    char notice[80] = "";
+    const char* noticeColor = COLOR_GREEN;
+
+    while (1) {
+        if (isRemoteKiosk()) remoteRefreshStock(); // Stock lives on the server
         clearScreen();
         printHeader("CONCESSION STAND");
-        // Display Menu with Prices
-        printCentered(8,  "1. Salted Popcorn ... PHP 150.00", COLOR_YELLOW);
-        printCentered(9,  "2. Large Soda ....... PHP 80.00", COLOR_YELLOW);
-        printCentered(10, "3. Mineral Water .... PHP 40.00", COLOR_YELLOW);
-        printCentered(11, "4. Wicked T-Shirt ... PHP 500.00", COLOR_CYAN);
-        printCentered(12, "5. Finish Order", COLOR_GREEN);
-        
-        printDivider(14);
-        
-        // Show running total
-        char totalStr[50];
-        sprintf(totalStr, "Current Extra Total: PHP %.2f", totalSnacks);
-        printCentered(16, totalStr, COLOR_MAGENTA);
-        
-        int choice = getIntInput(41, 18, COLOR_YELLOW "Select Item > " COLOR_RESET, 1, 5);
-        
-        // Add prices to total
-        if (choice == 1) { totalSnacks += 150.00; showLoadingAnimation("Popping Corn"); }
-        else if (choice == 2) { totalSnacks += 80.00;  showLoadingAnimation("Filling Cup"); }
-        else if (choice == 3) { totalSnacks += 40.00;  showLoadingAnimation("Getting Water"); }
-        else if (choice == 4) { totalSnacks += 500.00; showLoadingAnimation("Wrapping Merch"); }
-        else if (choice == 5) { buying = 0; }
+
+        // Display this page of the menu with prices and what is left
+        int first = page * STAND_PAGE_SIZE;
+        int shown = (count - first < STAND_PAGE_SIZE) ? count - first : STAND_PAGE_SIZE;
+        int i;
+        for(i = 0; i < shown; i++) {
+            const ConcessionItem* item = getConcessionItem(first + i);
+            int left = getStockLeft(first + i);
+            char price[MONEY_TEXT_MAX], stock[32] = "", line[100];
+            formatMoney(item->price, price, sizeof(price));
+            if (left == 0) snprintf(stock, sizeof(stock), "  SOLD OUT");
+            else if (left != STOCK_UNLIMITED) snprintf(stock, sizeof(stock), "  (%d left)", left);
+            snprintf(line, sizeof(line), "%d. %-22s PHP %9s%-12s", i + 1, item->name, price, stock);
+            printCentered(8 + i, line, (left == 0) ? COLOR_RED : COLOR_YELLOW);
+        }
+        int finish = shown + 1;
+        int more = (pages > 1) ? shown + 2 : 0;
+        char option[64];
+        snprintf(option, sizeof(option), "%d. Finish Order", finish);
+        printCentered(8 + shown, option, COLOR_GREEN);
+        if (more) {
+            snprintf(option, sizeof(option), "%d. More Items (page %d of %d)", more, page + 1, pages);
+            printCentered(9 + shown, option, COLOR_CYAN);
+        }
+
+        printDivider(18);
+
+        // Show the order so far and its running total
+        char orderStr[72], totalStr[50];
+        describeOrder(order, orderStr, sizeof(orderStr));
+        printCentered(19, orderStr, COLOR_WHITE);
+        sprintf(totalStr, "Current Extra Total: PHP " PESO_FORMAT, PESO_ARGS(order->total));
+        printCentered(20, totalStr, COLOR_MAGENTA);
+        if (notice[0] != '\0') printCentered(21, notice, noticeColor);
+
+        int choice = getIntInput(41, 23, COLOR_YELLOW "Select Item > " COLOR_RESET, 1, more ? more : finish);
+        notice[0] = '\0';
+        if (choice == finish) break;
+        if (choice == more) { page = (page + 1) % pages; continue; }
+
+        // Add one unit (no animation: the next customer is waiting)
+        int item = first + choice - 1;
+        int added = addToOrder(order, item, 1);
+        if (added == 1) { snprintf(notice, sizeof(notice), "Added: %s", getConcessionItem(item)->name); noticeColor = COLOR_GREEN; }
+        else if (added == 0) { snprintf(notice, sizeof(notice), "Sorry, %s is sold out.", getConcessionItem(item)->name); noticeColor = COLOR_RED; }
+        else { snprintf(notice, sizeof(notice), "One order can hold %d different items.", MAX_ORDER_LINES); noticeColor = COLOR_RED; }
+    }
+    return order->total;
+}
+
+// Function: askPromoCode
+// Purpose: Reads a promo code until it is a known one or left empty.
+int askPromoCode() {
+    if (getNumPromoCodes() == 0) return CUSTOMER_GUEST;
+
+    char code[50];
+    while (1) {
+        printHeader("PROMO CODE");
+        printCentered(10, "Have a promo or discount code?", COLOR_CYAN);
+        printDivider(13);
+        gotoxy(34, 15);
+        getStringInput(COLOR_YELLOW "Code (Enter to skip): " COLOR_RESET, code, sizeof(code));
+
+        char* p = code;
+        while (isspace((unsigned char)*p)) p++;
+        p[strcspn(p, " \t")] = '\0';
+        if (*p == '\0') return CUSTOMER_GUEST;
+
+        int customer = findPromoCode(p);
+        if (customer > 0) { showLoadingAnimation("Applying Code"); return customer; }
+        printCentered(17, "Unknown code. Please try again.", COLOR_RED);
+        pauseExecution(1200);
     }
-    return totalSnacks;
 }
 
 // Function: showSeatMap
 // Purpose: Draws the visual grid of seats. It colors them Green (Available) or Red (Sold).
 // It checks the specific 'showtimeIndex' to see which seats are taken for that time.
+// Wide halls switch to one character per seat so they still fit the screen.
 void showSeatMap(int showtimeIndex) {
+    const HallLayout* hall = getHall(showtimeIndex);
+    if (isRemoteKiosk()) syncRemoteShowtime(showtimeIndex); // Thin client: latest map from the server
+    else advanceHolds(); // Draw expired holds as available again
     clearScreen();
     printHeader("SEAT AVAILABILITY");
 
@@ -192,47 +350,88 @@ void showSeatMap(int showtimeIndex) {
     printCentered(10,"~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~", COLOR_CYAN);
     printCentered(11,"[                     S C R E E N                      ]", COLOR_CYAN);
 
+    int compact = (hall->cols > 10);            // More than 10 seats: use 'o' / 'x' cells
+    int cellWidth = compact ? 2 : 5;            // "[A1] " vs "o "
+    int rowStep = (hall->rows > 6) ? 1 : 2;     // Tall halls drop the blank line between rows
+    int startX = (SCREEN_WIDTH - (13 + hall->cols * cellWidth)) / 2;
+    if (startX < 0) startX = 0;
+
     int r, c;
-    for(r = 0; r < ROWS; r++) {
+    if (compact) {
+        // Two-line column ruler (tens, then units) so "C17" is easy to find
+        gotoxy(startX + 13, 12);
+        for(c = 0; c < hall->cols; c++) {
+            if ((c + 1) >= 10) screenPrintf(COLOR_MAGENTA "%d " COLOR_RESET, (c + 1) / 10);
+            else screenPrintf("  ");
+        }
+        gotoxy(startX + 13, 13);
+        for(c = 0; c < hall->cols; c++) screenPrintf(COLOR_MAGENTA "%d " COLOR_RESET, (c + 1) % 10);
+    }
+
+    int hasWheelchair = 0;
+    for(r = 0; r < hall->rows; r++) {
         char rowLabel[20];
         char rowColor[10];
         
-        // Differentiate Row A (VIP)
-        if (r == 0) { strcpy(rowLabel, "Row A (VIP)"); strcpy(rowColor, COLOR_YELLOW); } 
+        // Differentiate VIP rows
+        if (hall->rowClass[r] == TYPE_VIP) { sprintf(rowLabel, "Row %c (VIP)", 'A' + r); strcpy(rowColor, COLOR_YELLOW); } 
         else { sprintf(rowLabel, "Row %c      ", 'A' + r); strcpy(rowColor, COLOR_WHITE); }
 
-        int startX = 28; int y = 14 + (r * 2); 
-        gotoxy(startX, y); printf("%s%s  ", rowColor, rowLabel);
+        int y = 14 + (r * rowStep); 
+        gotoxy(startX, y); screenPrintf("%s%s  ", rowColor, rowLabel);
 
         // Loop columns to draw [A1] [A2] etc.
-        for(c = 0; c < COLS; c++) {
-            // Check status in 3D Matrix
-            if (isSeatBooked(r, c, showtimeIndex)) { printf(COLOR_RED "[%c%d] " COLOR_RESET, 'A'+r, c+1); } 
-            else { printf(COLOR_GREEN "[%c%d] " COLOR_RESET, 'A'+r, c+1); }
+        for(c = 0; c < hall->cols; c++) {
+            if (!seatExists(showtimeIndex, r, c)) { screenPrintf("%*s", cellWidth, ""); continue; } // Aisle
+
+            // Check status in the seat inventory (Held = another customer is paying)
+            int status = getSeatStatus(r, c, showtimeIndex);
+            int wheelchair = isWheelchairSeat(showtimeIndex, r, c);
+            if (wheelchair) hasWheelchair = 1;
+
+            const char* color = COLOR_GREEN;
+            char mark = wheelchair ? 'W' : 'o';
+            if (status == SEAT_SOLD)      { color = COLOR_RED;    mark = 'x'; }
+            else if (status == SEAT_HELD) { color = COLOR_YELLOW; mark = 'h'; }
+            else if (wheelchair)          { color = COLOR_BLUE; }
+
+            if (compact) {
+                screenPrintf("%s%c " COLOR_RESET, color, mark);
+            } else {
+                screenPrintf("%s[%c%d] " COLOR_RESET, color, 'A'+r, c+1);
+            }
         }
     }
 
     // Legend
-    gotoxy(34, 23); printf(COLOR_MAGENTA "Status: " COLOR_GREEN "[Available]  " COLOR_RED "    [Sold Out]" COLOR_RESET);
-    gotoxy(34, 24); printf(COLOR_MAGENTA "Pricing: " COLOR_YELLOW "VIP PHP %.2f  " COLOR_WHITE "REG PHP %.2f" COLOR_RESET, PRICE_VIP, PRICE_REG);
+    int legendY = 14 + (hall->rows - 1) * rowStep + 3;
+    gotoxy(30, legendY); screenPrintf(COLOR_MAGENTA "Status: " COLOR_GREEN "[Available]  " COLOR_YELLOW "[Held]  " COLOR_RED "[Sold Out]" COLOR_RESET);
+    if (hasWheelchair) screenPrintf(COLOR_BLUE "  [Wheelchair]" COLOR_RESET);
+    gotoxy(34, legendY + 1); screenPrintf(COLOR_MAGENTA "Pricing: " COLOR_YELLOW "VIP PHP " PESO_FORMAT "  " COLOR_WHITE "REG PHP " PESO_FORMAT COLOR_RESET, PESO_ARGS(currentSeatPrice(showtimeIndex, TYPE_VIP, CUSTOMER_GUEST)), PESO_ARGS(currentSeatPrice(showtimeIndex, TYPE_REG, CUSTOMER_GUEST)));
     
-    printDivider(26);
-    gotoxy(32, 27); printf("[Press Enter to proceed to booking]");
+    printDivider(legendY + 3);
+    gotoxy(32, legendY + 4); screenPrintf("[Press Enter to proceed to booking]");
+    presentScreenForInput();
     getchar();
 }
 
 // Function: getTicketTypeInput
-// Purpose: Asks the user if they want VIP (Row A) or Regular (Rows B-D).
-int getTicketTypeInput() {
+// Purpose: Asks the user if they want VIP or Regular seats.
+// The row ranges shown come from the hall layout of the chosen showtime.
+int getTicketTypeInput(int showtimeIndex) {
     clearScreen();
     printHeader("SELECT TICKET CLASS");
     
-    char vipStr[50], regStr[50];
-    sprintf(vipStr, "1. VIP EXPERIENCE (Row A) - PHP %.2f", PRICE_VIP);
-    sprintf(regStr, "2. REGULAR SEATING (Row B-D) - PHP %.2f", PRICE_REG);
+    char vipRows[48], regRows[48];
+    describeClassRows(showtimeIndex, TYPE_VIP, vipRows, sizeof(vipRows));
+    describeClassRows(showtimeIndex, TYPE_REG, regRows, sizeof(regRows));
+
+    char vipStr[100], regStr[100];
+    sprintf(vipStr, "1. VIP EXPERIENCE (%s) - PHP " PESO_FORMAT, vipRows, PESO_ARGS(currentSeatPrice(showtimeIndex, TYPE_VIP, CUSTOMER_GUEST)));
+    sprintf(regStr, "2. REGULAR SEATING (%s) - PHP " PESO_FORMAT, regRows, PESO_ARGS(currentSeatPrice(showtimeIndex, TYPE_REG, CUSTOMER_GUEST)));
     
-    gotoxy(30, 9);  printf("%s%s%s", COLOR_YELLOW, vipStr, COLOR_RESET);
-    gotoxy(30, 11); printf("%s%s%s", COLOR_WHITE, regStr, COLOR_RESET);
+    gotoxy(30, 9);  screenPrintf("%s%s%s", COLOR_YELLOW, vipStr, COLOR_RESET);
+    gotoxy(30, 11); screenPrintf("%s%s%s", COLOR_WHITE, regStr, COLOR_RESET);
     
     printDivider(14);
     return getIntInput(41, 16, COLOR_YELLOW "Select Class > " COLOR_RESET, 1, 2);
@@ -244,49 +443,55 @@ int getTicketTypeInput() {
 void manualSeatSelect(int qty, int ticketType, int showtimeIndex, SeatSelection* outputSeats) {
     clearScreen();
     printHeader("MANUAL SEAT SELECTION");
-    if (ticketType == TYPE_VIP) printCentered(8, "Mode: VIP (Select seats in Row A)", COLOR_YELLOW);
-    else printCentered(8, "Mode: REGULAR (Select seats in Rows B-D)", COLOR_WHITE);
+    char rows[48], mode[100];
+    describeClassRows(showtimeIndex, ticketType, rows, sizeof(rows));
+    if (ticketType == TYPE_VIP) { sprintf(mode, "Mode: VIP (Select seats in %s)", rows); printCentered(8, mode, COLOR_YELLOW); }
+    else { sprintf(mode, "Mode: REGULAR (Select seats in %s)", rows); printCentered(8, mode, COLOR_WHITE); }
 
+    Money price = currentSeatPrice(showtimeIndex, ticketType, CUSTOMER_GUEST);
     int count = 0;
     while (count < qty) {
         char input[10]; char prompt[50];
-        int inputX = 37; int inputY = 10 + count;
+        // Large groups reuse the 12 prompt lines from the top
+        int inputX = 37; int inputY = 10 + (count % 12);
+        gotoxy(inputX, inputY); screenPrintf("                                            ");
 
         gotoxy(inputX, inputY); sprintf(prompt, "Enter Seat for Ticket %d: ", count + 1);
         getStringInput(prompt, input, sizeof(input));
         
         // --- Validation Logic ---
         if (strlen(input) < 2) { 
-            gotoxy(inputX+30, inputY); printf(COLOR_RED "Invalid" COLOR_RESET); 
-            pauseExecution(800); gotoxy(inputX, inputY); printf("                                            "); 
+            gotoxy(inputX+30, inputY); screenPrintf(COLOR_RED "Invalid" COLOR_RESET); 
+            pauseExecution(800); gotoxy(inputX, inputY); screenPrintf("                                            "); 
             continue; 
         }
 
         char rowChar = toupper(input[0]); int rowIdx = rowChar - 'A'; int colIdx = atoi(&input[1]) - 1; 
 
-        // Check if seat is within bounds (A-D, 1-6)
-        if (rowIdx < 0 || rowIdx >= ROWS || colIdx < 0 || colIdx >= COLS) { 
-            gotoxy(inputX+30, inputY); printf(COLOR_RED "No such seat" COLOR_RESET); 
-            pauseExecution(800); gotoxy(inputX, inputY); printf("                                            "); 
+        // Check if seat exists in the hall (inside bounds and not an aisle)
+        if (!seatExists(showtimeIndex, rowIdx, colIdx)) { 
+            gotoxy(inputX+30, inputY); screenPrintf(COLOR_RED "No such seat" COLOR_RESET); 
+            pauseExecution(800); gotoxy(inputX, inputY); screenPrintf("                                            "); 
             continue; 
         }
         
         // Check if VIP tried to pick Regular or vice versa
-        if (ticketType == TYPE_VIP && rowIdx != 0) { 
-            gotoxy(inputX+30, inputY); printf(COLOR_RED "Not VIP" COLOR_RESET); 
-            pauseExecution(800); gotoxy(inputX, inputY); printf("                                            "); 
+        int rowClass = getRowClass(showtimeIndex, rowIdx);
+        if (ticketType == TYPE_VIP && rowClass != TYPE_VIP) { 
+            gotoxy(inputX+30, inputY); screenPrintf(COLOR_RED "Not VIP" COLOR_RESET); 
+            pauseExecution(800); gotoxy(inputX, inputY); screenPrintf("                                            "); 
             continue; 
         }
-        if (ticketType == TYPE_REG && rowIdx == 0) { 
-            gotoxy(inputX+30, inputY); printf(COLOR_RED "Is VIP" COLOR_RESET); 
-            pauseExecution(800); gotoxy(inputX, inputY); printf("                                            "); 
+        if (ticketType == TYPE_REG && rowClass == TYPE_VIP) { 
+            gotoxy(inputX+30, inputY); screenPrintf(COLOR_RED "Is VIP" COLOR_RESET); 
+            pauseExecution(800); gotoxy(inputX, inputY); screenPrintf("                                            "); 
             continue; 
         }
         
         // Check if seat is already sold
         if (isSeatBooked(rowIdx, colIdx, showtimeIndex)) { 
-            gotoxy(inputX+30, inputY); printf(COLOR_RED "Taken" COLOR_RESET); 
-            pauseExecution(800); gotoxy(inputX, inputY); printf("                                            "); 
+            gotoxy(inputX+30, inputY); screenPrintf(COLOR_RED "Taken" COLOR_RESET); 
+            pauseExecution(800); gotoxy(inputX, inputY); screenPrintf("                                            "); 
             continue; 
         }
 
@@ -294,15 +499,16 @@ void manualSeatSelect(int qty, int ticketType, int showtimeIndex, SeatSelection*
         int duplicate = 0; int k;
         for(k=0; k<count; k++) { if(outputSeats[k].r == rowIdx && outputSeats[k].c == colIdx) { duplicate = 1; break; } }
         if (duplicate) { 
-            gotoxy(inputX+30, inputY); printf(COLOR_RED "Duplicate" COLOR_RESET); 
-            pauseExecution(800); gotoxy(inputX, inputY); printf("                                            "); 
+            gotoxy(inputX+30, inputY); screenPrintf(COLOR_RED "Duplicate" COLOR_RESET); 
+            pauseExecution(800); gotoxy(inputX, inputY); screenPrintf("                                            "); 
             continue; 
         }
 
         // Success: Save seat to array
         outputSeats[count].r = rowIdx; outputSeats[count].c = colIdx; outputSeats[count].rowChar = rowChar;
-        outputSeats[count].price = (ticketType == TYPE_VIP) ? PRICE_VIP : PRICE_REG;
-        gotoxy(inputX+30, inputY); printf(COLOR_GREEN "[OK]" COLOR_RESET);
+        outputSeats[count].type = ticketType;
+        outputSeats[count].price = price;
+        gotoxy(inputX+30, inputY); screenPrintf(COLOR_GREEN "[OK]" COLOR_RESET);
         count++;
     }
     pauseExecution(500);
@@ -310,7 +516,7 @@ void manualSeatSelect(int qty, int ticketType, int showtimeIndex, SeatSelection*
 
 // Function: showTransactionSummary
 // Purpose: Displays the final receipt showing Tickets + Snacks + Total.
-void showTransactionSummary(int qty, SeatSelection* seats, float ticketTotal, float snacksTotal) {
+void showTransactionSummary(int qty, SeatSelection* seats, Money ticketTotal, const ConcessionOrder* extras) {
     clearScreen();
     printHeader("RECEIPT");
     printCentered(8, "Booking Confirmed!", COLOR_GREEN);
@@ -319,24 +525,90 @@ void showTransactionSummary(int qty, SeatSelection* seats, float ticketTotal, fl
     // List all tickets
     for(i=0; i<qty; i++) {
         char line[100];
-        sprintf(line, "Seat %c-%02d (%s) ......... PHP %.2f", seats[i].rowChar, seats[i].c+1, (seats[i].rowChar == 'A' ? "VIP" : "REG"), seats[i].price);
+        sprintf(line, "Seat %c-%02d (%s) ......... PHP " PESO_FORMAT, seats[i].rowChar, seats[i].c+1, (seats[i].type == TYPE_VIP ? "VIP" : "REG"), PESO_ARGS(seats[i].price));
         printCentered(y++, line, COLOR_WHITE);
     }
-    // List snacks if any
-    if (snacksTotal > 0) {
-        y++;
-        char snackLine[50];
-        sprintf(snackLine, "CONCESSIONS/EXTRAS ...... PHP %.2f", snacksTotal);
+    // List snacks if any, one line per item
+    if (extras->lineCount > 0) y++;
+    for(i = 0; i < extras->lineCount; i++) {
+        const OrderLine* item = &extras->lines[i];
+        char label[48], snackLine[100];
+        int length = snprintf(label, sizeof(label), "%d x %s ", item->qty, getConcessionItem(item->item)->name);
+        if (length < 0 || length >= (int)sizeof(label)) length = (int)sizeof(label) - 1;
+        while (length < 32) label[length++] = '.'; // Dot leader up to the price
+        label[length] = '\0';
+        sprintf(snackLine, "%s PHP " PESO_FORMAT, label, PESO_ARGS(item->unitPrice * item->qty));
         printCentered(y++, snackLine, COLOR_CYAN);
     }
     printDivider(y + 1);
-    char totalStr[50];
-    sprintf(totalStr, "GRAND TOTAL: PHP %.2f", ticketTotal + snacksTotal);
+    char totalStr[80];
+    sprintf(totalStr, "GRAND TOTAL: PHP " PESO_FORMAT, PESO_ARGS(ticketTotal + extras->total));
     printCentered(y + 3, totalStr, COLOR_YELLOW);
-    gotoxy(38, y + 5); printf("[Press Enter to Finish]");
+    printCentered(y + 4, "Your tickets are printing at the counter.", COLOR_WHITE);
+    gotoxy(38, y + 6); screenPrintf("[Press Enter to Finish]");
+    presentScreenForInput();
     getchar();
 }
 
+#define GROUP_PAGE_SIZE 9   // Parties listed per screen
+
+// Function: describeSeatRanges
+// Purpose: "B1-B6, C1-C6" for a party's seats (adjacent seats of a row are
+// one range), cut to fit one screen line.
+static void describeSeatRanges(const SeatSelection* seats, int count, char* buffer, int size) {
+    int used = 0, i = 0;
+    buffer[0] = '\0';
+    while (i < count && used < size) {
+        int j = i;
+        while (j + 1 < count && seats[j + 1].r == seats[i].r && seats[j + 1].c == seats[j].c + 1) j++;
+        if (j == i) {
+            used += snprintf(buffer + used, size - used, "%s%c%d", (i == 0) ? "" : ", ",
+                             seats[i].rowChar, seats[i].c + 1);
+        } else {
+            used += snprintf(buffer + used, size - used, "%s%c%d-%c%d", (i == 0) ? "" : ", ",
+                             seats[i].rowChar, seats[i].c + 1, seats[j].rowChar, seats[j].c + 1);
+        }
+        i = j + 1;
+    }
+    if (used >= size && size > 4) strcpy(buffer + size - 4, "...");
+}
+
+// Function: showGroupPlan
+// Purpose: The seating plan of a block booking, GROUP_PAGE_SIZE parties
+// per screen. Split parties are shown in yellow.
+void showGroupPlan(const GroupPlan* plan, const SeatSelection* seats, const char* title) {
+    int pages = (plan->partyCount + GROUP_PAGE_SIZE - 1) / GROUP_PAGE_SIZE;
+    int page, i;
+
+    for(page = 0; page < pages; page++) {
+        clearScreen();
+        printHeader(title);
+
+        char summary[128];
+        snprintf(summary, sizeof(summary), "%d seats for %d parties | %d split, %d single seats left over",
+                 plan->totalSeats, plan->partyCount, plan->splits, plan->orphans);
+        printCentered(8, summary, COLOR_CYAN);
+
+        int first = page * GROUP_PAGE_SIZE;
+        for(i = first; i < plan->partyCount && i < first + GROUP_PAGE_SIZE; i++) {
+            char ranges[64], line[100];
+            describeSeatRanges(&seats[plan->firstSeat[i]], plan->sizes[i], ranges, sizeof(ranges));
+            gotoxy(18, 10 + (i - first));
+            snprintf(line, sizeof(line), "Party %2d  (%3d seats)  %s", i + 1, plan->sizes[i], ranges);
+            screenPrintf("%s%s" COLOR_RESET, (plan->pieces[i] > 1) ? COLOR_YELLOW : COLOR_WHITE, line);
+        }
+
+        if (page + 1 < pages) {
+            char more[64];
+            snprintf(more, sizeof(more), "[Page %d/%d - Press Enter]", page + 1, pages);
+            printCentered(22, more, COLOR_YELLOW);
+            presentScreenForInput();
+            getchar();
+        }
+    }
+    printDivider(20);
+}
+
 // Function: showAdminLogin
 // Purpose: Asks for a password to enter Admin Mode.
 // Hardcoded password is "admin".
@@ -345,7 +617,7 @@ int showAdminLogin() {
     printCentered(9, "ENTER PASSPHRASE", COLOR_RED);
     printDivider(11);
     char password[50];
-    gotoxy(40, 13); printf(COLOR_YELLOW "Passphrase: "); scanf("%s", password); clearInputBuffer(); 
+    gotoxy(40, 13); screenPrintf(COLOR_YELLOW "Passphrase: "); presentScreenForInput(); scanf("%s", password); clearInputBuffer(); 
     if (strcmp(password, "admin") == 0) { showLoadingAnimation("Access Granted"); return 1; } 
     else { printCentered(15, "ACCESS DENIED. INTRUDER DETECTED.", COLOR_RED); pauseExecution(1500); return 0; }
 }
@@ -356,7 +628,6 @@ void playMovieSequence() {
     clearScreen();
     printHeader("NOW SCREENING");
     int sold = countSoldSeats(); // Gets total sold count
-    int capacity = ROWS * COLS * NUM_SHOWTIMES; // Total possible seats
     
     printCentered(9, "WELCOME TO THE WICKED MOVIE", COLOR_CYAN);
     char statStr[50]; sprintf(statStr, "Total Sold: %d tickets", sold);
@@ -365,12 +636,13 @@ void playMovieSequence() {
     printDivider(13);
     
     // Simple text animation
-    gotoxy(38, 15); printf("The lights are dimming..."); pauseExecution(1500);
-    gotoxy(38, 16); printf("The projector hums..."); pauseExecution(1500);
-    gotoxy(35, 18); printf(COLOR_RED "THE WICKED GOOD IS NOW PLAYING..." COLOR_RESET); pauseExecution(2000);
+    gotoxy(38, 15); screenPrintf("The lights are dimming..."); pauseExecution(1500);
+    gotoxy(38, 16); screenPrintf("The projector hums..."); pauseExecution(1500);
+    gotoxy(35, 18); screenPrintf(COLOR_RED "THE WICKED GOOD IS NOW PLAYING..." COLOR_RESET); pauseExecution(2000);
     
     printDivider(20);
-    gotoxy(35, 22); printf("[Press Enter to leave the cinema]");
+    gotoxy(35, 22); screenPrintf("[Press Enter to leave the cinema]");
+    presentScreenForInput();
     getchar();
 }
 
@@ -378,10 +650,10 @@ void playMovieSequence() {
 // Purpose: Displays the main menu for Guests.
 int showGuestMenu() {
     printHeader("TICKET KIOSK");
-    gotoxy(41, 9);  printf(COLOR_WHITE "1. Buy Tickets");
-    gotoxy(41, 10); printf(COLOR_WHITE "2. Movie Info");
-    gotoxy(41, 11); printf(COLOR_CYAN  "3. Watch Movie");
-    gotoxy(41, 12); printf(COLOR_WHITE "4. Return to Start");
+    gotoxy(41, 9);  screenPrintf(COLOR_WHITE "1. Buy Tickets");
+    gotoxy(41, 10); screenPrintf(COLOR_WHITE "2. Movie Info");
+    gotoxy(41, 11); screenPrintf(COLOR_CYAN  "3. Watch Movie");
+    gotoxy(41, 12); screenPrintf(COLOR_WHITE "4. Return to Start");
     printDivider(14);
     return getIntInput(41, 16, COLOR_YELLOW "Select an option > " COLOR_RESET, 1, 4);
 }
@@ -390,9 +662,136 @@ int showGuestMenu() {
 // Purpose: Displays the main menu for Admins.
 int showAdminMenu() {
     printHeader("MANAGER CONSOLE");
-    gotoxy(38, 9);  printf(COLOR_WHITE "1. View Current Sales");
-    gotoxy(38, 10); printf(COLOR_GREEN "2. Cashout (Close Shift)");
-    gotoxy(38, 11); printf(COLOR_WHITE "3. Logout");
-    printDivider(13);
-    return getIntInput(41, 15, COLOR_YELLOW "Command > " COLOR_RESET, 1, 3);
+    gotoxy(38, 9);  screenPrintf(COLOR_WHITE "1. View Current Sales");
+    gotoxy(38, 10); screenPrintf(COLOR_GREEN "2. Cashout (Close Shift)");
+    gotoxy(38, 11); screenPrintf(COLOR_WHITE "3. Export Sales (Text)");
+    gotoxy(38, 12); screenPrintf(COLOR_WHITE "4. Shift Archives");
+    gotoxy(38, 13); screenPrintf(COLOR_WHITE "5. Pipeline Timings");
+    gotoxy(38, 14); screenPrintf(COLOR_CYAN  "6. Group Booking");
+    gotoxy(38, 15); screenPrintf(COLOR_CYAN  "7. Ticket Check (Door)");
+    gotoxy(38, 16); screenPrintf(COLOR_WHITE "8. Logout");
+    printDivider(18);
+    return getIntInput(41, 20, COLOR_YELLOW "Command > " COLOR_RESET, 1, 8);
+}
+
+// Function: checkTicketsAtDoor
+// Purpose: The usher's screen. Each ticket number typed (or scanned) is
+// looked up in the ticket index and admitted; a second scan of the same
+// ticket is refused. An empty line goes back to the menu.
+void checkTicketsAtDoor() {
+    char verdict[100] = "", details[100] = "";
+    const char* verdictColor = COLOR_WHITE;
+    for (;;) {
+        printHeader("TICKET CHECK");
+        printCentered(9, "Type or scan the ticket number (empty line = back).", COLOR_CYAN);
+        int unrecorded = getUnrecordedTicketCount();
+        if (unrecorded > 0) {
+            char warning[100];
+            snprintf(warning, sizeof(warning), "%d ticket(s) printed here were not recorded: check their receipts.", unrecorded);
+            printCentered(10, warning, COLOR_YELLOW);
+        }
+        printCentered(12, verdict, verdictColor);
+        printCentered(13, details, COLOR_WHITE);
+        printDivider(15);
+
+        char text[64];
+        gotoxy(30, 17);
+        getStringInput(COLOR_YELLOW "Ticket # > " COLOR_RESET, text, sizeof(text));
+        if (text[0] == '\0') return;
+
+        TicketId id = parseTicketId(text);
+        TicketRecord ticket;
+        int status = (id != 0) ? validateTicket(id, 1, &ticket) : TICKET_UNKNOWN;
+        details[0] = '\0';
+        if (status == TICKET_UNKNOWN || ticket.showtimeIndex >= getNumShowtimes()) {
+            snprintf(verdict, sizeof(verdict), "%.20s: NOT A TICKET OF TODAY - DO NOT ADMIT", text);
+            verdictColor = COLOR_RED;
+            continue;
+        }
+
+        char idText[TICKET_ID_TEXT];
+        formatTicketId(id, idText);
+        if (status == TICKET_ISSUED) {
+            snprintf(verdict, sizeof(verdict), "#%s: ADMIT", idText);
+            verdictColor = COLOR_GREEN;
+        } else {
+            snprintf(verdict, sizeof(verdict), "#%s: ALREADY USED - DO NOT ADMIT", idText);
+            verdictColor = COLOR_RED;
+        }
+        const ShowtimeInfo* show = getShowtimeInfo(ticket.showtimeIndex);
+        const ShowingInfo* showing = getShowingInfo(ticket.showtimeIndex);
+        int type = getHall(ticket.showtimeIndex)->rowClass[ticket.row];
+        snprintf(details, sizeof(details), "%s | %s | %s | Seat %c-%02d (%s) | Kiosk %d",
+                 getFilmInfo(showing->film)->title, getScreenName(show->screen), show->time,
+                 'A' + ticket.row, ticket.col + 1, (type == TYPE_VIP) ? "VIP" : "REG", getTicketShard(id));
+    }
+}
+
+// Function: viewServerSales
+// Purpose: Admin screen of a thin-client kiosk. The sales log lives on the
+// booking server, so this shows the server's totals instead of local files.
+void viewServerSales() {
+    int sales;
+    Money totalCentavos;
+    printHeader("SERVER SALES");
+    if (remoteSalesTotals(&sales, &totalCentavos)) {
+        char line[80];
+        sprintf(line, "Current shift: %d sales, PHP " PESO_FORMAT, sales, PESO_ARGS(totalCentavos));
+        printCentered(11, line, COLOR_GREEN);
+    } else {
+        printCentered(11, "The booking server did not answer.", COLOR_RED);
+    }
+    printCentered(13, "Sales log, cashout and archives are kept on the booking server.", COLOR_YELLOW);
+    printDivider(16);
+    printCentered(18, "[Press Enter to return]", COLOR_GREEN);
+    presentScreenForInput();
+    getchar();
+}
+
+// Function: viewPipelineMetrics
+// Purpose: One line per purchase stage (count, mean, p50/p90/p99, max),
+// with the option to save the full histograms to a file or start over.
+void viewPipelineMetrics() {
+    int viewing = 1;
+    while (viewing) {
+        printHeader("PIPELINE TIMINGS");
+        gotoxy(12, 8);
+        screenPrintf(COLOR_YELLOW "%-16s %7s %10s %10s %10s %10s %10s" COLOR_RESET,
+                     "Stage", "Count", "Mean", "p50", "p90", "p99", "Max");
+
+        int m;
+        for(m = 0; m < METRIC_COUNT; m++) {
+            LatencySummary sum;
+            char mean[16], p50[16], p90[16], p99[16], max[16];
+            getLatencySummary(m, &sum);
+            formatLatency(sum.count ? sum.totalUs / sum.count : 0, mean, sizeof(mean));
+            formatLatency(sum.p50Us, p50, sizeof(p50));
+            formatLatency(sum.p90Us, p90, sizeof(p90));
+            formatLatency(sum.p99Us, p99, sizeof(p99));
+            formatLatency(sum.maxUs, max, sizeof(max));
+            if (sum.count == 0) { strcpy(mean, "-"); strcpy(p50, "-"); strcpy(p90, "-"); strcpy(p99, "-"); strcpy(max, "-"); }
+
+            // The whole-purchase line and the lines below it stand apart
+            const char* color = (m == STAGE_PURCHASE) ? COLOR_GREEN : (m > STAGE_PURCHASE ? COLOR_MAGENTA : COLOR_CYAN);
+            gotoxy(12, 9 + m + (m > STAGE_PURCHASE));
+            screenPrintf("%s%-16s %7lld %10s %10s %10s %10s %10s" COLOR_RESET,
+                         color, getMetricName(m), sum.count, mean, p50, p90, p99, max);
+        }
+
+        printDivider(26);
+        gotoxy(26, 27);
+        screenPrintf("1. Save to " METRICS_FILE "   2. Reset   3. Back");
+        int choice = getIntInput(41, 29, COLOR_YELLOW "Command > " COLOR_RESET, 1, 3);
+
+        if (choice == 1) {
+            gotoxy(30, 30);
+            if (dumpMetrics(METRICS_FILE)) screenPrintf(COLOR_GREEN "Saved to " METRICS_FILE COLOR_RESET);
+            else screenPrintf(COLOR_RED "Could not write " METRICS_FILE COLOR_RESET);
+            pauseExecution(1500);
+        } else if (choice == 2) {
+            resetMetrics();
+        } else {
+            viewing = 0;
+        }
+    }
 }
@@ -4,8 +4,7 @@
 // ---------------------------------------------------------
 // UI CONSTANTS
 // ---------------------------------------------------------
-#define MOVIE_TITLE "THE WICKED GOOD"
-#define TICKET_PRICE 12.50 // Base price reference (legacy)
+#define TICKET_PRICE (PESOS(12) + 50) // Base price reference (legacy), centavos
 
 // ---------------------------------------------------------
 // CORE VISUAL PROTOTYPES
@@ -22,11 +21,15 @@ void showLoadingAnimation(const char* message);
 // Draws a decorative horizontal line at a specific Y vertical position.
 void printDivider(int y);
 
-// Displays the movie plot, rating, and runtime.
+// Prints 'text' centered on row 'y' in the given COLOR_* color.
+void printCentered(int y, const char* text, const char* color);
+
+// Displays the movie plot, rating, and runtime (from the catalog; asks
+// which film first when several are playing).
 void printMovieInfo();
 
 // Shows the visual grid of seats (Red=Sold, Green=Available).
-void showSeatMap(); 
+void showSeatMap(int showtimeIndex); 
 
 // ---------------------------------------------------------
 // TRANSACTION DISPLAY
@@ -34,17 +37,36 @@ void showSeatMap();
 // included tickets.h here because we need the 'SeatSelection' structure definition.
 #include "tickets.h" 
 
+// Asks for VIP or Regular seating. Row ranges are read from the hall of the showtime.
+int getTicketTypeInput(int showtimeIndex);
+
+// Lets the user type seat codes (e.g. "A1") and fills 'outputSeats' with 'qty' seats.
+void manualSeatSelect(int qty, int ticketType, int showtimeIndex, SeatSelection* outputSeats);
+
 // Displays the final receipt showing individual ticket details and the snack total.
-void showTransactionSummary(int qty, SeatSelection* seats, float ticketTotal, float snacksTotal); // UPDATED
+// Each concession line item of 'extras' is listed with its quantity.
+void showTransactionSummary(int qty, SeatSelection* seats, Money ticketTotal, const ConcessionOrder* extras);
+
+// Lists the parties of a block booking (groups.h) with their seats, a page
+// at a time ("B1-B6, C1-C6"). The last page stays on screen; rows 21 and
+// below are left free for the caller's prompt.
+#include "groups.h"
+void showGroupPlan(const GroupPlan* plan, const SeatSelection* seats, const char* title);
 
 // ---------------------------------------------------------
 // (Cinema Experience)
 // ---------------------------------------------------------
-// Displays the list of 4 showtimes and returns the selected index (0-3).
+// Asks for a film (if several are playing) and one of its screenings today.
+// Returns the showtime index (0-based); the ticket time is copied to 'buffer'.
 int selectShowtime(char* buffer); // Picks a time
 
-// Opens the Concession Stand menu loop and returns the total cost of snacks bought.
-float buyConcessions();            // Buys food/drinks
+// Opens the Concession Stand menu loop. Picked items go into 'order' (taken
+// from stock; cancelOrder() puts them back) and the order total is returned.
+Money buyConcessions(ConcessionOrder* order); // Buys food/drinks
+
+// Asks for a promo code (pricing.txt) when any are on offer; Enter skips.
+// Returns the customer number to price the tickets with (CUSTOMER_GUEST = none).
+int askPromoCode();
 
 // ---------------------------------------------------------
 // MENUS & AUTHENTICATION
@@ -55,9 +77,20 @@ int showRoleSelection();
 // Asks for the password ("admin") to access the Manager Console.
 int showAdminLogin();           
 
-// Displays the Admin options (View Sales, Cashout, Logout).
+// Displays the Admin options (View Sales, Cashout, Export, Archives, Timings,
+// Group Booking, Ticket Check, Logout).
 int showAdminMenu();            
 
+// Usher's screen: checks ticket numbers against the ticket index
+// (ticketid.h) and admits each ticket once.
+void checkTicketsAtDoor();
+
+// Thin-client kiosk (remote.h): shift totals from the booking server.
+void viewServerSales();
+
+// Shows the per-stage purchase timings (metrics.h); can save them to a file.
+void viewPipelineMetrics();
+
 // Displays the Guest options (Buy Tickets, Watch Movie, Return).
 int showGuestMenu();            
 
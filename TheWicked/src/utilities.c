@@ -1,4 +1,9 @@
+// Request POSIX/XSI declarations (clock_gettime, usleep) in strict C99 mode.
+// Must come before the first system header.
+#define _XOPEN_SOURCE 600
+
 #include "utilities.h"
+#include "metrics.h"
 #include <time.h>
 #include <stdio.h>
 
@@ -6,48 +11,148 @@
 // OS-SPECIFIC LIBRARIES
 // ---------------------------------------------------------
 // This block ensures the code compiles on both Windows and Mac/Linux.
+#include <fcntl.h>
 #ifdef _WIN32
     #include <windows.h> // Windows specific
+    #include <io.h>
 #else
     #include <unistd.h>  // Unix/Linux specific
+    #include <sys/mman.h>
+    #include <sys/stat.h>
 #endif
 
 // ---------------------------------------------------------
-// CURSOR MANAGEMENT
+// TIMING
 // ---------------------------------------------------------
 
-// Function: gotoxy
-// Purpose: Moves the blinking cursor to a specific coordinate (X, Y).
-// Essential for drawing the UI in specific places (centering, tables, etc).
-void gotoxy(int x, int y) {
+// Function: sleepMilliseconds
+// Purpose: Plain sleep with no screen side effects (engine code, e.g. the
+// write-ahead log's group-commit window, which also runs in headless mode).
+void sleepMilliseconds(int milliseconds) {
     #ifdef _WIN32
-        COORD coord;
-        coord.X = x;
-        coord.Y = y;
-        SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), coord);
+        Sleep(milliseconds);
     #else
-        // ANSI Escape code for Unix terminals
-        printf("\033[%d;%dH", y, x);
+        usleep(milliseconds * 1000);
     #endif
 }
 
-// Function: clearScreen
-// Purpose: Wipes the terminal clean. Used between menus.
-void clearScreen() {
+// Function: pauseExecution
+// Purpose: Stops the program for X milliseconds. Used for animations.
+// Whatever was drawn so far is put on the terminal first.
+void pauseExecution(int milliseconds) {
+    presentScreen();
+    long long startUs = getMonotonicMicros();
+    sleepMilliseconds(milliseconds);
+    recordLatency(METRIC_ANIMATION, getMonotonicMicros() - startUs);
+}
+
+// Function: getMonotonicMs
+// Purpose: Milliseconds from a clock that never jumps (unlike time(NULL)
+// when the kiosk clock is adjusted). Used for timeouts and measurements.
+long long getMonotonicMs() {
     #ifdef _WIN32
-        system("cls");
+        return (long long)GetTickCount64();
     #else
-        system("clear");
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
     #endif
 }
 
-// Function: pauseExecution
-// Purpose: Stops the program for X milliseconds. Used for animations.
-void pauseExecution(int milliseconds) {
+// Function: getMonotonicMicros
+// Purpose: Microsecond version of getMonotonicMs() (headless runs, benchmarks).
+long long getMonotonicMicros() {
     #ifdef _WIN32
-        Sleep(milliseconds);
+        LARGE_INTEGER freq, now;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&now);
+        return (long long)(now.QuadPart / freq.QuadPart) * 1000000
+             + (long long)(now.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart;
     #else
-        usleep(milliseconds * 1000);
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    #endif
+}
+
+// Function: getEpochMicros
+// Purpose: Wall-clock time in microseconds since 1970 (used in record timestamps).
+long long getEpochMicros() {
+    #ifdef _WIN32
+        // FILETIME counts 100 ns steps since 1601
+        FILETIME ft;
+        GetSystemTimeAsFileTime(&ft);
+        unsigned long long ticks = ((unsigned long long)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+        return (long long)(ticks / 10 - 11644473600000000ULL);
+    #else
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    #endif
+}
+
+// ---------------------------------------------------------
+// READ-ONLY FILE MAPPING
+// ---------------------------------------------------------
+
+// Function: mapFileReadOnly
+// Purpose: Makes a whole file readable as memory. On Mac/Linux this is
+// mmap() (the OS pages it in on demand, nothing is copied up front).
+// Windows builds simply read the file into a malloc'd block.
+void* mapFileReadOnly(const char* path, size_t* size) {
+    void* data = NULL;
+    *size = 0;
+    #ifdef _WIN32
+        int fd = _open(path, _O_RDONLY | _O_BINARY);
+        if (fd < 0) return NULL;
+        long long length = _lseeki64(fd, 0, SEEK_END);
+        _lseeki64(fd, 0, SEEK_SET);
+        if (length > 0 && (data = malloc((size_t)length)) != NULL) {
+            if (_read(fd, data, (unsigned)length) != length) { free(data); data = NULL; }
+            else *size = (size_t)length;
+        }
+        _close(fd);
+    #else
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return NULL;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) data = NULL;
+            else *size = (size_t)st.st_size;
+        }
+        close(fd);
+    #endif
+    return data;
+}
+
+// Function: unmapFile
+// Purpose: Releases a block returned by mapFileReadOnly.
+void unmapFile(void* data, size_t size) {
+    if (data == NULL) return;
+    #ifdef _WIN32
+        (void)size;
+        free(data);
+    #else
+        munmap(data, size);
+    #endif
+}
+
+// Function: replaceFileAtomically
+// Purpose: Puts 'tmpPath' in place of 'path' in one step, so readers see
+// either the old file or the new one, never a half-written mix.
+int replaceFileAtomically(const char* tmpPath, const char* path) {
+    #ifdef _WIN32
+        return MoveFileExA(tmpPath, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+    #else
+        if (rename(tmpPath, path) != 0) return 0;
+        // Sync the directory too, or the rename itself may be lost in a crash
+        int dirFd = open(".", O_RDONLY);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            close(dirFd);
+        }
+        return 1;
     #endif
 }
 
@@ -78,11 +183,12 @@ int getIntInput(int x, int y, const char* prompt, int min, int max) {
         gotoxy(x, y);
         
         // 2. Clear the line before printing prompt (removes old bad input)
-        printf("                                                  "); 
+        screenPrintf("                                                  "); 
         gotoxy(x, y);
         
-        printf("%s", prompt);
+        screenPrintf("%s", prompt);
         
+        presentScreenForInput();
         if (fgets(buffer, sizeof(buffer), stdin) != NULL) {
             // Remove newline
             size_t len = strlen(buffer);
@@ -94,17 +200,17 @@ int getIntInput(int x, int y, const char* prompt, int min, int max) {
                 if (value >= min && value <= max) {
                     // Valid! Clear the error line below just in case
                     gotoxy(0, y+1); 
-                    printf("                                                                                ");
+                    screenPrintf("                                                                                ");
                     return value;
                 } else {
                     // Out of Range Error - Printed Centered below prompt
                     gotoxy(30, y+1); 
-                    printf(COLOR_RED "    [!] Input out of range (%d-%d)." COLOR_RESET, min, max);
+                    screenPrintf(COLOR_RED "    [!] Input out of range (%d-%d)." COLOR_RESET, min, max);
                 }
             } else {
                 // Invalid Input Error - Printed Centered below prompt
                 gotoxy(30, y+1);
-                printf(COLOR_RED "        [!] Invalid input. Numbers only." COLOR_RESET);
+                screenPrintf(COLOR_RED "        [!] Invalid input. Numbers only." COLOR_RESET);
             }
             
             // Wait so user sees the red error message
@@ -112,7 +218,7 @@ int getIntInput(int x, int y, const char* prompt, int min, int max) {
             
             // Clear the error message line so the screen stays clean
             gotoxy(0, y+1); 
-            printf("                                                                                ");
+            screenPrintf("                                                                                ");
             
             // LOOP REPEATS: It will go back to gotoxy(x,y) and repaint the prompt perfectly.
         }
@@ -123,7 +229,8 @@ int getIntInput(int x, int y, const char* prompt, int min, int max) {
 // Purpose: Safely gets a string from the user (e.g., Seat Code "A1").
 // Removes the annoying newline character automatically.
 void getStringInput(const char* prompt, char* buffer, int size) {
-    printf("%s", prompt);
+    screenPrintf("%s", prompt);
+    presentScreenForInput();
     if (fgets(buffer, size, stdin) != NULL) {
         size_t len = strlen(buffer);
         if (len > 0 && buffer[len-1] == '\n') {
@@ -29,17 +29,40 @@
 // Defined width of the terminal window used for centering calculations.
 #define SCREEN_WIDTH 100 
 
+// clearScreen(), gotoxy() and screenPrintf() draw into the frame buffer
+#include "screen.h"
+
 // ---------------------------------------------------------
 // FUNCTION PROTOTYPES
 // ---------------------------------------------------------
 
-// Clears all text from the terminal window (cls/clear).
-void clearScreen();
-
-// Pauses the program for a specific amount of time (used for animations).
+// Shows the current frame, then pauses for a specific amount of time (used for animations).
 // @param milliseconds: Time to wait (e.g., 1000 = 1 second).
 void pauseExecution(int milliseconds);
 
+// Sleeps without touching the screen (for engine code; UI code uses pauseExecution).
+void sleepMilliseconds(int milliseconds);
+
+// Returns a monotonic timestamp in milliseconds (only differences are meaningful).
+long long getMonotonicMs();
+
+// Same clock in microseconds, for timing runs that finish in a few milliseconds.
+long long getMonotonicMicros();
+
+// Returns the wall-clock time in microseconds since 1970-01-01 (UTC).
+long long getEpochMicros();
+
+// Maps a whole file read-only into memory.
+// Returns: The contents (size in *size), or NULL if missing or empty.
+void* mapFileReadOnly(const char* path, size_t* size);
+
+// Releases a mapping returned by mapFileReadOnly().
+void unmapFile(void* data, size_t size);
+
+// Renames 'tmpPath' over 'path' atomically (the old file is replaced).
+// Returns: 1 on success, 0 on failure.
+int replaceFileAtomically(const char* tmpPath, const char* path);
+
 // Clears the input buffer (stdin) to remove leftover newline characters.
 // This prevents the "skipping" bug when switching between scanf and fgets.
 void clearInputBuffer();
@@ -55,9 +78,4 @@ int getIntInput(int x, int y, const char* prompt, int min, int max);
 // Automatically removes the trailing newline character from fgets.
 void getStringInput(const char* prompt, char* buffer, int size); 
 
-// Moves the terminal cursor to a specific coordinate.
-// @param x: Horizontal position (Column).
-// @param y: Vertical position (Row).
-void gotoxy(int x, int y); 
-
 #endif
@@ -0,0 +1,303 @@
+// Request POSIX declarations (fdatasync, pthreads) in strict C99 mode.
+// Must come before the first system header.
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include "wal.h"
+#include "utilities.h"
+
+// ---------------------------------------------------------
+// OS-SPECIFIC FILE I/O
+// ---------------------------------------------------------
+#ifdef _WIN32
+    #include <io.h>
+    #define write _write
+    #define read _read
+    #define close _close
+    #define lseek _lseeki64
+    #define ftruncate(fd, size) _chsize_s(fd, size)
+    #define fdatasync(fd) _commit(fd)
+    #define LOG_OPEN_FLAGS (O_RDWR | O_APPEND | O_CREAT | O_BINARY)
+    #define TMP_OPEN_FLAGS (O_WRONLY | O_CREAT | O_TRUNC | O_BINARY)
+#else
+    #include <unistd.h>
+    #define LOG_OPEN_FLAGS (O_RDWR | O_APPEND | O_CREAT)
+    #define TMP_OPEN_FLAGS (O_WRONLY | O_CREAT | O_TRUNC)
+#endif
+
+#define COPY_CHUNK 65536  // Bytes copied per read/write while trimming
+
+// ---------------------------------------------------------
+// DATA STRUCTURES
+// ---------------------------------------------------------
+// A growable byte buffer. Records are appended here until the leader
+// swaps it out and writes it in one go.
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} LogBuffer;
+
+// The waiters of a batch: one result per queued record, filled in by the
+// leader that writes the batch (-1 = not written yet, 1 = durable, 0 = failed).
+typedef struct {
+    int** results;
+    size_t count;
+    size_t capacity;
+} WaiterList;
+
+static int logFd = -1;
+static char logPath[256] = "";
+static int commitWindowMs = GROUP_COMMIT_MS;
+
+static pthread_mutex_t logMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t logFlushed = PTHREAD_COND_INITIALIZER;
+
+static LogBuffer pending = { NULL, 0, 0 };   // Records waiting for the next batch
+static LogBuffer writing = { NULL, 0, 0 };   // The batch the leader is writing
+static WaiterList pendingWaiters = { NULL, 0, 0 };
+static WaiterList writingWaiters = { NULL, 0, 0 };
+static long long durableBytes = 0;           // File size covered by completed flushes
+static int leaderActive = 0;
+
+// Function: bufferAppend
+// Purpose: Copies a record into a buffer, doubling its size when full.
+static int bufferAppend(LogBuffer* buf, const void* data, size_t length) {
+    if (buf->length + length > buf->capacity) {
+        size_t newCap = (buf->capacity == 0) ? 4096 : buf->capacity;
+        while (newCap < buf->length + length) newCap *= 2;
+        char* grown = realloc(buf->data, newCap);
+        if (grown == NULL) return 0;
+        buf->data = grown;
+        buf->capacity = newCap;
+    }
+    memcpy(buf->data + buf->length, data, length);
+    buf->length += length;
+    return 1;
+}
+
+// Function: waiterAppend
+// Purpose: Registers where the result of one queued record must go.
+static int waiterAppend(WaiterList* list, int* result) {
+    if (list->count == list->capacity) {
+        size_t newCap = (list->capacity == 0) ? 64 : list->capacity * 2;
+        int** grown = realloc(list->results, newCap * sizeof(int*));
+        if (grown == NULL) return 0;
+        list->results = grown;
+        list->capacity = newCap;
+    }
+    list->results[list->count++] = result;
+    return 1;
+}
+
+// Function: writeAll
+// Purpose: write() may write less than asked; loop until everything is out.
+static int writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        long n = (long)write(fd, data, (unsigned)length);
+        if (n <= 0) return 0;
+        data += n;
+        length -= (size_t)n;
+    }
+    return 1;
+}
+
+// Function: readAll
+// Purpose: Same as writeAll, for reads.
+static int readAll(int fd, char* data, size_t length) {
+    while (length > 0) {
+        long n = (long)read(fd, data, (unsigned)length);
+        if (n <= 0) return 0;
+        data += n;
+        length -= (size_t)n;
+    }
+    return 1;
+}
+
+// ---------------------------------------------------------
+// PUBLIC API
+// ---------------------------------------------------------
+
+// Function: openSalesLog
+// Purpose: Opens the log once for the whole session (no open/close per sale).
+int openSalesLog(const char* path, int groupCommitMs) {
+    pthread_mutex_lock(&logMutex);
+    if (logFd >= 0) close(logFd);
+    snprintf(logPath, sizeof(logPath), "%s", path);
+    logFd = open(path, LOG_OPEN_FLAGS, 0644);
+    durableBytes = (logFd >= 0) ? (long long)lseek(logFd, 0, SEEK_END) : 0;
+    commitWindowMs = groupCommitMs;
+    pthread_mutex_unlock(&logMutex);
+    return logFd >= 0;
+}
+
+// Function: setGroupCommitWindow
+// Purpose: Tunes latency vs. batching (bigger window = fewer fdatasync calls).
+void setGroupCommitWindow(int milliseconds) {
+    pthread_mutex_lock(&logMutex);
+    commitWindowMs = (milliseconds < 0) ? 0 : milliseconds;
+    pthread_mutex_unlock(&logMutex);
+}
+
+// Function: appendSalesRecord
+// Purpose: Queues the record, then either leads a flush or waits for the
+// current leader to flush a batch that contains our record. Every record
+// gets the result of its own batch (a later batch failing or succeeding
+// does not change it).
+int appendSalesRecord(const void* data, size_t length) {
+    int result = -1;
+    pthread_mutex_lock(&logMutex);
+    if (logFd < 0 || !waiterAppend(&pendingWaiters, &result)) {
+        pthread_mutex_unlock(&logMutex);
+        return 0;
+    }
+    if (!bufferAppend(&pending, data, length)) {
+        pendingWaiters.count--;
+        pthread_mutex_unlock(&logMutex);
+        return 0;
+    }
+
+    while (result < 0) {
+        if (leaderActive) {
+            // Somebody else is flushing; our record goes in the next batch
+            pthread_cond_wait(&logFlushed, &logMutex);
+            continue;
+        }
+
+        // --- We are the leader ---
+        leaderActive = 1;
+        if (commitWindowMs > 0) {
+            // Give the other kiosks a moment to join this batch
+            pthread_mutex_unlock(&logMutex);
+            sleepMilliseconds(commitWindowMs);
+            pthread_mutex_lock(&logMutex);
+        }
+
+        // Take the whole pending buffer (and its waiters) as this batch
+        LogBuffer swap = writing;
+        writing = pending;
+        pending = swap;
+        pending.length = 0;
+        WaiterList swapWaiters = writingWaiters;
+        writingWaiters = pendingWaiters;
+        pendingWaiters = swapWaiters;
+        pendingWaiters.count = 0;
+        int fd = logFd;
+        long long batchStart = durableBytes; // Only the leader moves it
+
+        // Do the slow I/O without holding the lock
+        pthread_mutex_unlock(&logMutex);
+        int ok = writeAll(fd, writing.data, writing.length) && fdatasync(fd) == 0;
+        // Cut off whatever part of the batch did reach the file, so the
+        // next batch starts on a record boundary again
+        int aligned = ok || ftruncate(fd, batchStart) == 0;
+        pthread_mutex_lock(&logMutex);
+
+        if (!aligned && logFd == fd) {
+            // Records appended after the stuck bytes would be misaligned:
+            // close the log so appends fail. saveTransaction() reopens it
+            // through prepareSalesFile(), which cuts the torn tail first.
+            close(logFd);
+            logFd = -1;
+        }
+
+        if (ok) durableBytes += (long long)writing.length;
+        size_t i;
+        for(i = 0; i < writingWaiters.count; i++) *writingWaiters.results[i] = ok;
+        writingWaiters.count = 0;
+        writing.length = 0;
+        leaderActive = 0;
+        pthread_cond_broadcast(&logFlushed);
+    }
+
+    pthread_mutex_unlock(&logMutex);
+    return result;
+}
+
+// Function: getSalesLogDurableSize
+// Purpose: Byte offset up to which every record is known to be on disk.
+// Snapshots store this so a restart only replays what came after it.
+long long getSalesLogDurableSize() {
+    pthread_mutex_lock(&logMutex);
+    long long size = durableBytes;
+    pthread_mutex_unlock(&logMutex);
+    return size;
+}
+
+// Function: trimSalesLog
+// Purpose: Cuts bytes [from, to) out of the log (the records cashout just
+// archived) and keeps both the file header before them and whatever kiosks
+// appended after them.
+// The kept bytes are copied into "<log>.tmp", synced, and the copy renamed
+// over the log, so a crash at any point leaves either the old log or the
+// new one, never a log missing sales that were already confirmed. The log
+// is then reopened; kiosks keep calling appendSalesRecord() as before (if
+// the reopen fails the log stays closed and the next sale opens it again).
+// Holds the log lock throughout (kiosks finishing a sale wait for it) and
+// waits for an in-flight batch so its bytes are not cut in half.
+int trimSalesLog(long long from, long long to) {
+    pthread_mutex_lock(&logMutex);
+    while (leaderActive) pthread_cond_wait(&logFlushed, &logMutex);
+
+    if (logFd < 0 || from < 0 || from > to || to > durableBytes) {
+        pthread_mutex_unlock(&logMutex);
+        return 0;
+    }
+
+    char tmpPath[270];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", logPath);
+    int tmpFd = open(tmpPath, TMP_OPEN_FLAGS, 0644);
+    char* chunk = malloc(COPY_CHUNK);
+    int ok = (tmpFd >= 0 && chunk != NULL);
+
+    // Copy [0, from) and [to, end) into the new file
+    long long ranges[2][2] = { { 0, from }, { to, durableBytes } };
+    int part;
+    for(part = 0; part < 2 && ok; part++) {
+        long long offset = ranges[part][0];
+        ok = lseek(logFd, offset, SEEK_SET) >= 0;
+        while (ok && offset < ranges[part][1]) {
+            size_t length = (ranges[part][1] - offset > COPY_CHUNK) ? COPY_CHUNK : (size_t)(ranges[part][1] - offset);
+            ok = readAll(logFd, chunk, length) && writeAll(tmpFd, chunk, length);
+            offset += (long long)length;
+        }
+    }
+    ok = ok && fdatasync(tmpFd) == 0;
+    if (tmpFd >= 0) close(tmpFd);
+    free(chunk);
+
+    // Windows cannot rename over an open file: close, replace, reopen
+    if (ok) {
+        close(logFd);
+        ok = replaceFileAtomically(tmpPath, logPath);
+        logFd = open(logPath, LOG_OPEN_FLAGS, 0644);
+        if (logFd >= 0) durableBytes = (long long)lseek(logFd, 0, SEEK_END);
+    }
+    if (!ok) remove(tmpPath);
+
+    pthread_mutex_unlock(&logMutex);
+    return ok;
+}
+
+// Function: closeSalesLog
+// Purpose: Called at shutdown. appendSalesRecord never returns before its
+// record is flushed, so there is nothing left in the buffers here.
+void closeSalesLog() {
+    pthread_mutex_lock(&logMutex);
+    if (logFd >= 0) close(logFd);
+    logFd = -1;
+    pthread_mutex_unlock(&logMutex);
+}
+
+// Function: isSalesLogOpen
+// Purpose: Lets callers open the log lazily on first use.
+int isSalesLogOpen() {
+    pthread_mutex_lock(&logMutex);
+    int isOpen = (logFd >= 0);
+    pthread_mutex_unlock(&logMutex);
+    return isOpen;
+}
@@ -0,0 +1,49 @@
+#ifndef WAL_H
+#define WAL_H
+
+#include <stddef.h>
+
+// ---------------------------------------------------------
+// WRITE-AHEAD SALES LOG
+// ---------------------------------------------------------
+// The sales log is opened ONCE and kept open. Every sale is appended as
+// one record, and a sale only counts as saved once it is on disk.
+//
+// Group commit: when several kiosks finish a sale at the same moment,
+// the first one becomes the "leader". It waits a short window for the
+// others to queue their records, then writes the whole batch with ONE
+// write() and ONE fdatasync(). Everybody in the batch is released together.
+
+// Default time (ms) the leader waits to gather more records into a batch.
+#define GROUP_COMMIT_MS 2
+
+// Opens (or creates) the log for appending.
+// Returns: 1 on success, 0 if the file cannot be opened.
+int openSalesLog(const char* path, int groupCommitMs);
+
+// Changes the group-commit window (0 = flush immediately).
+void setGroupCommitWindow(int milliseconds);
+
+// Appends one record and blocks until it is durable on disk.
+// Safe to call from many threads at once.
+// Returns: 1 if the record was written and synced, 0 on I/O error. If
+// the failed batch cannot be cut back out of the file the log is closed.
+int appendSalesRecord(const void* data, size_t length);
+
+// Size of the log (bytes) covered by completed, synced batches.
+long long getSalesLogDurableSize();
+
+// Removes bytes [from, to) of the log (used by cashout once those records
+// are archived): the rest is copied to a new file that atomically replaces
+// the log, which is then reopened. Records appended later are kept.
+// Returns: 1 once the bytes are gone from the log file, 0 if the log is
+// not open or on I/O error (the log is then unchanged).
+int trimSalesLog(long long from, long long to);
+
+// Flushes anything pending and closes the log.
+void closeSalesLog();
+
+// Returns 1 while the log is open.
+int isSalesLogOpen();
+
+#endif